@@ -2,7 +2,11 @@
 # test_cmd is the command to run with all its arguments
 
 set(OUT ${test_dir}/.test.out)
-set(EXP ${input}.exp)
+if (exp_suffix)
+    set(EXP ${input}.${exp_suffix}.exp)
+else()
+    set(EXP ${input}.exp)
+endif()
 
 if( NOT test_cmd )
    message( FATAL_ERROR "Variable test_cmd not defined" )
@@ -1,9 +1,10 @@
 #!/bin/bash
-# usage: ./benchmark_jupiter.sh "1000,2000;50,50" "10;100;1000" "1;2;4;8"
+# usage: ./benchmark_jupiter.sh "1000,2000;50,50" "10;100;1000" "1;2;4;8" [threads per rank of the hybrid runs, default 4]
 
 test_sizes=$1
 it_list=$2
 threads=$3
+threads_per_rank=${4:-4}
 
 hostfile="hosts"
 
@@ -22,6 +23,14 @@ cmds=(
 "build/stencil_mpi/mpi_benchmark_onesided_pscw"
 )
 
+# P cores as P / threads_per_rank ranks with an OpenMP team each
+cmds_hybrid=(
+"build/stencil_mpi/mpi_benchmark_hybrid_sendrecv"
+"build/stencil_mpi/mpi_benchmark_hybrid_nonblocking"
+"build/stencil_mpi/mpi_benchmark_hybrid_onesided_fence"
+"build/stencil_mpi/mpi_benchmark_hybrid_onesided_pscw"
+)
+
 for test_size in $(echo $test_sizes | tr ";" "\n"); do
     IFS=",";
     tmp=($test_size);
@@ -56,6 +65,20 @@ for test_size in $(echo $test_sizes | tr ";" "\n"); do
             done
         done
 
+        # hybrid mpi + openmp
+        for cmd in ${cmds_hybrid[@]}; do
+            for par in $(echo $threads | tr ";" "\n"); do
+                # P has to be a multiple of the threads per rank, P cores are used
+                ranks=$((par / threads_per_rank))
+                if [ ${ranks} -lt 1 ] || [ $((par % threads_per_rank)) -ne 0 ]; then
+                    continue
+                fi
+                output=$(/opt/mpich/bin/mpiexec -np ${ranks} --hostfile ${hostfile} -genv OMP_NUM_THREADS ${threads_per_rank} ${cmd} ${rows} ${cols} ${its})
+                echo "${cmd};${par};${output}" >> ${out}
+                echo "${cmd};${par};${output}"
+            done
+        done
+
         echo "" >> ${out}
     done
 done
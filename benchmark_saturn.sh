@@ -1,9 +1,10 @@
 #!/bin/bash
-# usage: ./benchmark_saturn.sh "1000,2000;50,50" "10;100;1000" "1;2;4;8"
+# usage: ./benchmark_saturn.sh "1000,2000;50,50" "10;100;1000" "1;2;4;8" [threads per rank of the hybrid runs, default 4]
 
 test_sizes=$1
 it_list=$2
 threads=$3
+threads_per_rank=${4:-4}
 
 export OMP_PROC_BIND=true # openmp thread pinning
 
@@ -25,6 +26,13 @@ cmds_cilk_openmp=(
 "build/stencil_openmp/openmp_benchmark_one_vector_blockwise_tld"
 )
 
+# the blockwise variants pinned by the library (instead of OMP_PROC_BIND), threads which
+# share a cache calculate neighbouring blocks
+cmds_openmp_topology=(
+"build/stencil_openmp/openmp_benchmark_one_vector_blockwise_tld"
+"build/stencil_openmp/openmp_benchmark_one_vector_blockwise_tld_p2p"
+)
+
 cmds_mpi=(
 "build/stencil_mpi/mpi_benchmark_sendrecv"
 "build/stencil_mpi/mpi_benchmark_nonblocking"
@@ -32,6 +40,14 @@ cmds_mpi=(
 "build/stencil_mpi/mpi_benchmark_onesided_pscw"
 )
 
+# P cores as P / threads_per_rank ranks with an OpenMP team each
+cmds_hybrid=(
+"build/stencil_mpi/mpi_benchmark_hybrid_sendrecv"
+"build/stencil_mpi/mpi_benchmark_hybrid_nonblocking"
+"build/stencil_mpi/mpi_benchmark_hybrid_onesided_fence"
+"build/stencil_mpi/mpi_benchmark_hybrid_onesided_pscw"
+)
+
 for test_size in $(echo $test_sizes | tr ";" "\n"); do
     IFS=",";
     tmp=($test_size);
@@ -66,6 +82,14 @@ for test_size in $(echo $test_sizes | tr ";" "\n"); do
             done
         done
 
+        for cmd in ${cmds_openmp_topology[@]}; do
+            for par in $(echo $threads | tr ";" "\n"); do
+                output=$(OMP_PROC_BIND=false STENCIL_PLACEMENT=topology ${cmd} ${rows} ${cols} ${its} ${par})
+                echo "${cmd}+topology;${par};${output}" >> ${out}
+                echo "${cmd}+topology;${par};${output}"
+            done
+        done
+
         # mpi
         for cmd in ${cmds_mpi[@]}; do
             for par in $(echo $threads | tr ";" "\n"); do
@@ -74,6 +98,20 @@ for test_size in $(echo $test_sizes | tr ";" "\n"); do
                 echo "${cmd};${par};${output}"
             done
         done
+
+        # hybrid mpi + openmp
+        for cmd in ${cmds_hybrid[@]}; do
+            for par in $(echo $threads | tr ";" "\n"); do
+                # P has to be a multiple of the threads per rank, P cores are used
+                ranks=$((par / threads_per_rank))
+                if [ ${ranks} -lt 1 ] || [ $((par % threads_per_rank)) -ne 0 ]; then
+                    continue
+                fi
+                output=$(OMP_NUM_THREADS=${threads_per_rank} mpiexec -np ${ranks} ${cmd} ${rows} ${cols} ${its})
+                echo "${cmd};${par};${output}" >> ${out}
+                echo "${cmd};${par};${output}"
+            done
+        done
         echo "" >> ${out}
     done
 done
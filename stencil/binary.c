@@ -0,0 +1,308 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "binary.h"
+
+#define HEADER_VERSION 8
+#define HEADER_DTYPE 12
+#define HEADER_ROWS 16
+#define HEADER_COLS 24
+#define HEADER_BOUNDARY 32
+#define HEADER_STRIDE 40
+#define HEADER_OFFSET 48
+#define HEADER_ITERATION 56
+
+// the values are mapped as they are stored in the file
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define HOST_LITTLE_ENDIAN false
+#else
+#define HOST_LITTLE_ENDIAN true
+#endif
+
+static void put_le(unsigned char *dest, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++) {
+        dest[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const unsigned char *src, size_t bytes)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= (uint64_t)src[i] << (8 * i);
+    }
+    return value;
+}
+
+static size_t dtype_size(stencil_binary_dtype_t dtype)
+{
+    return (dtype == STENCIL_BINARY_FLOAT) ? sizeof(float) : sizeof(double);
+}
+
+/**
+ * @return returns the offset of the first value in bytes (the first interior field
+ *         of a page-aligned mapping is aligned like in an allocated matrix)
+ */
+static size_t values_offset(size_t boundary, size_t element_size)
+{
+    return STENCIL_BINARY_HEADER_SIZE + stencil_matrix_alignment_offset(boundary, element_size) * element_size;
+}
+
+bool stencil_binary_is_binary(FILE *stream)
+{
+    const long position = ftell(stream);
+
+    char magic[STENCIL_BINARY_MAGIC_SIZE];
+    const bool binary = (fread(magic, 1, STENCIL_BINARY_MAGIC_SIZE, stream) == STENCIL_BINARY_MAGIC_SIZE) &&
+                        (memcmp(magic, STENCIL_BINARY_MAGIC, STENCIL_BINARY_MAGIC_SIZE) == 0);
+
+    fseek(stream, position, SEEK_SET);
+    return binary;
+}
+
+bool stencil_binary_decode_header(const unsigned char *bytes, size_t file_size, stencil_binary_header_t *header)
+{
+    if (memcmp(bytes, STENCIL_BINARY_MAGIC, STENCIL_BINARY_MAGIC_SIZE) != 0) {
+        return false;
+    }
+
+    header->version = (uint32_t)get_le(bytes + HEADER_VERSION, 4);
+    const uint32_t dtype = (uint32_t)get_le(bytes + HEADER_DTYPE, 4);
+    header->rows = get_le(bytes + HEADER_ROWS, 8);
+    header->cols = get_le(bytes + HEADER_COLS, 8);
+    header->boundary = get_le(bytes + HEADER_BOUNDARY, 8);
+    header->stride = get_le(bytes + HEADER_STRIDE, 8);
+    header->offset = get_le(bytes + HEADER_OFFSET, 8);
+    header->iteration = get_le(bytes + HEADER_ITERATION, 8);
+
+    if (header->version != STENCIL_BINARY_VERSION ||
+        (dtype != STENCIL_BINARY_DOUBLE && dtype != STENCIL_BINARY_FLOAT)) {
+        return false;
+    }
+    header->dtype = (stencil_binary_dtype_t)dtype;
+
+    const size_t element_size = dtype_size(header->dtype);
+
+    if (header->rows < 2 * header->boundary || header->cols < 2 * header->boundary ||
+        header->stride < header->cols || header->offset != values_offset(header->boundary, element_size)) {
+        return false;
+    }
+
+    // the file has to contain all values (the size must not overflow)
+    if (header->stride > (SIZE_MAX - header->offset) / element_size / (header->rows ? header->rows : 1)) {
+        return false;
+    }
+    return file_size >= header->offset + header->rows * header->stride * element_size;
+}
+
+bool stencil_binary_read_header(const char *filepath, stencil_binary_header_t *header)
+{
+    FILE *stream = fopen(filepath, "rb");
+    if (stream == NULL) {
+        return false;
+    }
+
+    unsigned char bytes[STENCIL_BINARY_HEADER_SIZE];
+    bool valid = false;
+    if (fread(bytes, 1, STENCIL_BINARY_HEADER_SIZE, stream) == STENCIL_BINARY_HEADER_SIZE &&
+        fseek(stream, 0, SEEK_END) == 0) {
+        const long file_size = ftell(stream);
+        valid = (file_size >= 0) && stencil_binary_decode_header(bytes, (size_t)file_size, header);
+    }
+
+    fclose(stream);
+    return valid;
+}
+
+/**
+ * Maps the whole file \a filepath (copy-on-write) if it is a binary grid file of dtype \a dtype.
+ *
+ * @return returns a pointer to the first value, NULL on failure
+ */
+static void *map_values(const char *filepath, stencil_binary_dtype_t dtype, stencil_binary_header_t *header)
+{
+    if (!HOST_LITTLE_ENDIAN) {
+        return NULL;
+    }
+
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || (size_t)file_stat.st_size < STENCIL_BINARY_HEADER_SIZE) {
+        goto exit;
+    }
+
+    // private and writable: the solvers work in place without changing the file
+    unsigned char *mapping = (unsigned char *)mmap(NULL, file_stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        goto exit;
+    }
+
+    if (!stencil_binary_decode_header(mapping, file_stat.st_size, header) || header->dtype != dtype) {
+        goto exit_mapping;
+    }
+
+    close(fd); // the mapping stays valid
+    return mapping + header->offset;
+
+exit_mapping:
+    munmap(mapping, file_stat.st_size);
+exit:
+    close(fd);
+    return NULL;
+}
+
+stencil_matrix_t *stencil_binary_map(const char *filepath)
+{
+    stencil_binary_header_t header;
+    double *values = (double *)map_values(filepath, STENCIL_BINARY_DOUBLE, &header);
+    if (!values) {
+        goto exit_values;
+    }
+
+    stencil_matrix_t *matrix = (stencil_matrix_t *)malloc(sizeof(stencil_matrix_t));
+    if (!matrix) {
+        goto exit_matrix;
+    }
+    matrix->rows = header.rows;
+    matrix->cols = header.cols;
+    matrix->stride = header.stride;
+    matrix->boundary = header.boundary;
+    matrix->values = values;
+    matrix->pages = STENCIL_PAGES_MAPPED;
+
+    return matrix;
+
+exit_matrix:
+    stencil_pages_free(values, header.rows * header.stride * sizeof(double), STENCIL_PAGES_MAPPED);
+exit_values:
+    return NULL;
+}
+
+stencil_matrix_float_t *stencil_binary_map_float(const char *filepath)
+{
+    stencil_binary_header_t header;
+    float *values = (float *)map_values(filepath, STENCIL_BINARY_FLOAT, &header);
+    if (!values) {
+        goto exit_values;
+    }
+
+    stencil_matrix_float_t *matrix = (stencil_matrix_float_t *)malloc(sizeof(stencil_matrix_float_t));
+    if (!matrix) {
+        goto exit_matrix;
+    }
+    matrix->rows = header.rows;
+    matrix->cols = header.cols;
+    matrix->stride = header.stride;
+    matrix->boundary = header.boundary;
+    matrix->values = values;
+    matrix->pages = STENCIL_PAGES_MAPPED;
+
+    return matrix;
+
+exit_matrix:
+    stencil_pages_free(values, header.rows * header.stride * sizeof(float), STENCIL_PAGES_MAPPED);
+exit_values:
+    return NULL;
+}
+
+void stencil_binary_header_init(stencil_binary_header_t *header, stencil_binary_dtype_t dtype, size_t rows,
+                                size_t cols, size_t boundary, size_t stride)
+{
+    header->version = STENCIL_BINARY_VERSION;
+    header->dtype = dtype;
+    header->rows = rows;
+    header->cols = cols;
+    header->boundary = boundary;
+    header->stride = stride;
+    header->offset = values_offset(boundary, dtype_size(dtype));
+    header->iteration = 0;
+}
+
+void stencil_binary_encode_header(const stencil_binary_header_t *header, unsigned char *bytes)
+{
+    memset(bytes, 0, STENCIL_BINARY_HEADER_SIZE);
+    memcpy(bytes, STENCIL_BINARY_MAGIC, STENCIL_BINARY_MAGIC_SIZE);
+    put_le(bytes + HEADER_VERSION, header->version, 4);
+    put_le(bytes + HEADER_DTYPE, header->dtype, 4);
+    put_le(bytes + HEADER_ROWS, header->rows, 8);
+    put_le(bytes + HEADER_COLS, header->cols, 8);
+    put_le(bytes + HEADER_BOUNDARY, header->boundary, 8);
+    put_le(bytes + HEADER_STRIDE, header->stride, 8);
+    put_le(bytes + HEADER_OFFSET, header->offset, 8);
+    put_le(bytes + HEADER_ITERATION, header->iteration, 8);
+}
+
+/**
+ * Writes the header and the values (\a rows rows of \a cols values at a distance of
+ * \a stride values, padded to \a stride with zeros) to \a stream.
+ */
+static bool write_grid(FILE *stream, stencil_binary_dtype_t dtype, size_t rows, size_t cols, size_t boundary,
+                       size_t stride, size_t iteration, const void *values)
+{
+    if (stream == NULL || !HOST_LITTLE_ENDIAN) {
+        return false;
+    }
+
+    const size_t element_size = dtype_size(dtype);
+    const size_t offset = values_offset(boundary, element_size);
+
+    stencil_binary_header_t header;
+    stencil_binary_header_init(&header, dtype, rows, cols, boundary, stride);
+    header.iteration = iteration;
+
+    unsigned char bytes[STENCIL_BINARY_HEADER_SIZE];
+    stencil_binary_encode_header(&header, bytes);
+
+    if (fwrite(bytes, 1, sizeof(bytes), stream) != sizeof(bytes)) {
+        return false;
+    }
+
+    // the alignment offset is less than a cache line
+    const unsigned char zero[STENCIL_MATRIX_ALIGNMENT] = {0};
+    if (fwrite(zero, 1, offset - STENCIL_BINARY_HEADER_SIZE, stream) != offset - STENCIL_BINARY_HEADER_SIZE) {
+        return false;
+    }
+
+    const size_t padding = (stride - cols) * element_size;
+    for (size_t row = 0; row < rows; row++) {
+        if (fwrite((const char *)values + row * stride * element_size, element_size, cols, stream) != cols) {
+            return false;
+        }
+        for (size_t written = 0; written < padding; written += sizeof(zero)) {
+            const size_t len = (padding - written < sizeof(zero)) ? padding - written : sizeof(zero);
+            if (fwrite(zero, 1, len, stream) != len) {
+                return false;
+            }
+        }
+    }
+
+    return fflush(stream) == 0;
+}
+
+bool stencil_binary_write(const stencil_matrix_t *matrix, FILE *stream)
+{
+    return write_grid(stream, STENCIL_BINARY_DOUBLE, matrix->rows, matrix->cols, matrix->boundary,
+                      matrix->stride, 0, matrix->values);
+}
+
+bool stencil_binary_write_checkpoint(const stencil_matrix_t *matrix, size_t iteration, FILE *stream)
+{
+    return write_grid(stream, STENCIL_BINARY_DOUBLE, matrix->rows, matrix->cols, matrix->boundary,
+                      matrix->stride, iteration, matrix->values);
+}
+
+bool stencil_binary_write_float(const stencil_matrix_float_t *matrix, FILE *stream)
+{
+    return write_grid(stream, STENCIL_BINARY_FLOAT, matrix->rows, matrix->cols, matrix->boundary,
+                      matrix->stride, 0, matrix->values);
+}
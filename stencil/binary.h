@@ -0,0 +1,120 @@
+#ifndef __STENCIL_BINARY_H
+#define __STENCIL_BINARY_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "matrix.h"
+#include "matrix_float.h"
+
+/**
+ * Binary grid file (version 1), all fields little-endian:
+ *
+ *   offset  size  field
+ *        0     8  magic "STNCGRID"
+ *        8     4  version
+ *       12     4  dtype (stencil_binary_dtype_t)
+ *       16     8  rows (with boundary)
+ *       24     8  cols (with boundary)
+ *       32     8  boundary
+ *       40     8  stride (distance between two rows in values, >= cols)
+ *       48     8  offset of the first value in bytes
+ *       56     8  iteration of a checkpoint (0 for other grid files)
+ *
+ * followed by rows * stride raw values (the padding at the end of a row is 0). The
+ * values start at STENCIL_BINARY_HEADER_SIZE plus the alignment offset of the matrix
+ * (stencil_matrix_alignment_offset), thus a mapping of the file has the same alignment
+ * as an allocated matrix.
+ */
+#define STENCIL_BINARY_MAGIC "STNCGRID"
+#define STENCIL_BINARY_MAGIC_SIZE 8
+#define STENCIL_BINARY_VERSION 1
+#define STENCIL_BINARY_HEADER_SIZE 64
+
+enum stencil_binary_dtype {
+    STENCIL_BINARY_DOUBLE = 0,
+    STENCIL_BINARY_FLOAT = 1
+};
+typedef enum stencil_binary_dtype stencil_binary_dtype_t;
+
+struct stencil_binary_header {
+    uint32_t version;
+    stencil_binary_dtype_t dtype;
+    size_t rows;
+    size_t cols;
+    size_t boundary;
+    size_t stride;
+    size_t offset;
+    size_t iteration; // number of iterations done on the values of a checkpoint
+};
+typedef struct stencil_binary_header stencil_binary_header_t;
+
+/**
+ * @param stream stream positioned at the start of the file (the position is restored)
+ *
+ * @return returns true if the stream starts with the magic of a binary grid file
+ */
+bool stencil_binary_is_binary(FILE *stream);
+
+/**
+ * Initializes the header \a header of a grid file (the offset of the values follows
+ * from \a boundary and \a dtype, the iteration is 0).
+ */
+void stencil_binary_header_init(stencil_binary_header_t *header, stencil_binary_dtype_t dtype, size_t rows,
+                                size_t cols, size_t boundary, size_t stride);
+
+/**
+ * Encodes the header \a header into the first STENCIL_BINARY_HEADER_SIZE bytes of \a bytes.
+ */
+void stencil_binary_encode_header(const stencil_binary_header_t *header, unsigned char *bytes);
+
+/**
+ * Decodes and validates the header in the first STENCIL_BINARY_HEADER_SIZE bytes of
+ * \a bytes of a grid file with \a file_size bytes.
+ *
+ * @return returns true if the header is valid (and the file contains all values)
+ */
+bool stencil_binary_decode_header(const unsigned char *bytes, size_t file_size, stencil_binary_header_t *header);
+
+/**
+ * Reads and validates the header of the binary grid file \a filepath.
+ *
+ * @return returns true if the header is valid
+ */
+bool stencil_binary_read_header(const char *filepath, stencil_binary_header_t *header);
+
+/**
+ * Maps the binary grid file \a filepath (dtype double) into a matrix without copying
+ * or parsing the values. The mapping is private, changes of the values are not written
+ * back to the file. The matrix is freed with stencil_matrix_free (pages is
+ * STENCIL_PAGES_MAPPED).
+ *
+ * @return A pointer to a matrix, NULL on failure (also on big-endian hosts).
+ */
+stencil_matrix_t *stencil_binary_map(const char *filepath);
+
+/**
+ * Same as stencil_binary_map for a binary grid file with dtype float.
+ */
+stencil_matrix_float_t *stencil_binary_map_float(const char *filepath);
+
+/**
+ * Writes the matrix \a matrix (with boundary) as binary grid file to \a stream.
+ *
+ * @return returns true if the matrix was written successfully
+ */
+bool stencil_binary_write(const stencil_matrix_t *matrix, FILE *stream);
+
+/**
+ * Same as stencil_binary_write for a checkpoint, \a iteration iterations have been done
+ * on the values (see stencil_checkpoint_t).
+ */
+bool stencil_binary_write_checkpoint(const stencil_matrix_t *matrix, size_t iteration, FILE *stream);
+
+/**
+ * Same as stencil_binary_write for a single-precision matrix.
+ */
+bool stencil_binary_write_float(const stencil_matrix_float_t *matrix, FILE *stream);
+
+#endif // __STENCIL_BINARY_H
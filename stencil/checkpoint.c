@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+
+#include "checkpoint.h"
+#include "binary.h"
+#include "util.h"
+
+#define TMP_SUFFIX ".tmp"
+
+/**
+ * Writes the snapshot \a snapshot to a temporary file which replaces the checkpoint
+ * file \a filepath once it is complete (and synced).
+ *
+ * @return returns true if the checkpoint was written successfully
+ */
+static bool write_snapshot(const char *filepath, const stencil_matrix_t *snapshot, size_t iteration)
+{
+    char *tmp_filepath = (char *)malloc(strlen(filepath) + sizeof(TMP_SUFFIX));
+    if (tmp_filepath == NULL) {
+        return false;
+    }
+    strcpy(tmp_filepath, filepath);
+    strcat(tmp_filepath, TMP_SUFFIX);
+
+    bool written = false;
+    FILE *stream = fopen(tmp_filepath, "wb");
+    if (stream != NULL) {
+        written = stencil_binary_write_checkpoint(snapshot, iteration, stream) && (fsync(fileno(stream)) == 0);
+        written = (fclose(stream) == 0) && written;
+    }
+
+    // the rename is atomic, a crash leaves either the old or the new checkpoint
+    written = written && (rename(tmp_filepath, filepath) == 0);
+    if (!written) {
+        unlink(tmp_filepath);
+    }
+
+    free(tmp_filepath);
+    return written;
+}
+
+/**
+ * Background thread which writes the pending snapshots until it is stopped.
+ */
+static void *write_snapshots(void *arg)
+{
+    stencil_checkpoint_t *checkpoint = (stencil_checkpoint_t *)arg;
+
+    pthread_mutex_lock(&checkpoint->mutex);
+    for (;;) {
+        while (checkpoint->pending < 0 && !checkpoint->stop) {
+            pthread_cond_wait(&checkpoint->cond, &checkpoint->mutex);
+        }
+        if (checkpoint->pending < 0) {
+            break; // stopped and nothing left to write
+        }
+
+        const int snapshot = checkpoint->pending;
+        checkpoint->writing = snapshot;
+        checkpoint->pending = -1;
+        pthread_mutex_unlock(&checkpoint->mutex);
+
+        const bool written = write_snapshot(checkpoint->filepath, checkpoint->snapshots[snapshot],
+                                            checkpoint->snapshot_iterations[snapshot]);
+
+        pthread_mutex_lock(&checkpoint->mutex);
+        checkpoint->writing = -1;
+        checkpoint->failed = checkpoint->failed || !written;
+        pthread_cond_broadcast(&checkpoint->cond);
+    }
+    pthread_mutex_unlock(&checkpoint->mutex);
+
+    return NULL;
+}
+
+stencil_checkpoint_t *stencil_checkpoint_new(const char *filepath, size_t interval, double seconds)
+{
+    stencil_checkpoint_t *checkpoint = (stencil_checkpoint_t *)malloc(sizeof(stencil_checkpoint_t));
+    if (!checkpoint) {
+        goto exit_checkpoint;
+    }
+
+    checkpoint->filepath = strdup(filepath);
+    if (!checkpoint->filepath) {
+        goto exit_filepath;
+    }
+
+    checkpoint->interval = interval;
+    checkpoint->seconds = seconds;
+    checkpoint->iteration = 0;
+    checkpoint->last_time = get_time();
+
+    for (size_t i = 0; i < STENCIL_CHECKPOINT_SNAPSHOTS; i++) {
+        checkpoint->snapshots[i] = NULL;
+        checkpoint->snapshot_iterations[i] = 0;
+    }
+    checkpoint->pending = -1;
+    checkpoint->writing = -1;
+    checkpoint->failed = false;
+    checkpoint->stop = false;
+    checkpoint->started = false;
+
+    pthread_mutex_init(&checkpoint->mutex, NULL);
+    pthread_cond_init(&checkpoint->cond, NULL);
+
+    return checkpoint;
+
+exit_filepath:
+    free(checkpoint);
+exit_checkpoint:
+    return NULL;
+}
+
+bool stencil_checkpoint_free(stencil_checkpoint_t *checkpoint)
+{
+    if (!checkpoint) {
+        return true;
+    }
+
+    if (checkpoint->started) {
+        // the thread writes the pending snapshot before it stops
+        pthread_mutex_lock(&checkpoint->mutex);
+        checkpoint->stop = true;
+        pthread_cond_broadcast(&checkpoint->cond);
+        pthread_mutex_unlock(&checkpoint->mutex);
+
+        pthread_join(checkpoint->thread, NULL);
+    }
+
+    const bool written = !checkpoint->failed;
+
+    for (size_t i = 0; i < STENCIL_CHECKPOINT_SNAPSHOTS; i++) {
+        stencil_matrix_free(checkpoint->snapshots[i]);
+    }
+    pthread_cond_destroy(&checkpoint->cond);
+    pthread_mutex_destroy(&checkpoint->mutex);
+    free(checkpoint->filepath);
+    free(checkpoint);
+
+    return written;
+}
+
+stencil_matrix_t *stencil_checkpoint_restore(stencil_checkpoint_t *checkpoint)
+{
+    stencil_binary_header_t header;
+    if (!stencil_binary_read_header(checkpoint->filepath, &header)) {
+        return NULL;
+    }
+
+    stencil_matrix_t *matrix = stencil_binary_map(checkpoint->filepath);
+    if (matrix != NULL) {
+        checkpoint->iteration = header.iteration;
+        checkpoint->last_time = get_time();
+    }
+
+    return matrix;
+}
+
+bool stencil_checkpoint_is_due(const stencil_checkpoint_t *checkpoint, size_t iteration)
+{
+    return ((checkpoint->interval > 0) && (iteration % checkpoint->interval == 0)) ||
+           ((checkpoint->seconds > 0.0) && (get_time() - checkpoint->last_time >= checkpoint->seconds * 1000.0));
+}
+
+bool stencil_checkpoint_take(stencil_checkpoint_t *checkpoint, const stencil_matrix_t *matrix, size_t iteration)
+{
+    pthread_mutex_lock(&checkpoint->mutex);
+
+    if (!checkpoint->started) {
+        if (pthread_create(&checkpoint->thread, NULL, write_snapshots, checkpoint) != 0) {
+            pthread_mutex_unlock(&checkpoint->mutex);
+            return false;
+        }
+        checkpoint->started = true;
+    }
+
+    // a snapshot which still waits is replaced, the one which is written is never touched
+    int snapshot = checkpoint->pending;
+    if (snapshot < 0) {
+        snapshot = (checkpoint->writing == 0) ? 1 : 0;
+    }
+    checkpoint->pending = -1;
+    pthread_mutex_unlock(&checkpoint->mutex);
+
+    stencil_matrix_t *values = checkpoint->snapshots[snapshot];
+    if (values == NULL || values->rows != matrix->rows || values->cols != matrix->cols ||
+        values->boundary != matrix->boundary) {
+        stencil_matrix_free(values);
+        values = stencil_matrix_new(matrix->rows, matrix->cols, matrix->boundary);
+        checkpoint->snapshots[snapshot] = values;
+        if (values == NULL) {
+            return false;
+        }
+    }
+
+    stencil_matrix_copy_values(values, matrix);
+    checkpoint->snapshot_iterations[snapshot] = iteration;
+
+    pthread_mutex_lock(&checkpoint->mutex);
+    checkpoint->pending = snapshot;
+    checkpoint->last_time = get_time();
+    pthread_cond_broadcast(&checkpoint->cond);
+    pthread_mutex_unlock(&checkpoint->mutex);
+
+    return true;
+}
+
+bool stencil_checkpoint_wait(stencil_checkpoint_t *checkpoint)
+{
+    pthread_mutex_lock(&checkpoint->mutex);
+    while (checkpoint->pending >= 0 || checkpoint->writing >= 0) {
+        pthread_cond_wait(&checkpoint->cond, &checkpoint->mutex);
+    }
+    const bool written = !checkpoint->failed;
+    pthread_mutex_unlock(&checkpoint->mutex);
+
+    return written;
+}
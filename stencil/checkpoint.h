@@ -0,0 +1,96 @@
+#ifndef __STENCIL_CHECKPOINT_H
+#define __STENCIL_CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "matrix.h"
+
+#define STENCIL_CHECKPOINT_SNAPSHOTS 2
+
+/**
+ * Periodic checkpoints of a matrix, taken every \a interval iterations or as soon as
+ * \a seconds have passed since the last one (0 disables the trigger).
+ *
+ * A checkpoint copies the matrix into one of two snapshots and hands it to a background
+ * thread which writes it as binary grid file (see binary.h, the header contains the
+ * iteration), so the iteration continues while the file is written. The snapshot which
+ * is not written is taken next, if a write is still waiting for the thread it is replaced
+ * by the newer one. The file is written to filepath.tmp and renamed afterwards, thus
+ * \a filepath always contains a complete checkpoint.
+ */
+struct stencil_checkpoint {
+    char *filepath;
+    size_t interval;
+    double seconds;
+
+    size_t iteration; // number of iterations done on the restored matrix (0 without restart)
+    double last_time; // time of the last checkpoint in msec (get_time)
+
+    stencil_matrix_t *snapshots[STENCIL_CHECKPOINT_SNAPSHOTS];
+    size_t snapshot_iterations[STENCIL_CHECKPOINT_SNAPSHOTS];
+    int pending; // snapshot which waits for the thread (-1: none)
+    int writing; // snapshot which is written by the thread (-1: none)
+    bool failed; // a write has failed
+    bool stop;
+
+    bool started; // the thread is started with the first checkpoint
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+};
+typedef struct stencil_checkpoint stencil_checkpoint_t;
+
+/**
+ * Creates the checkpoints of file \a filepath.
+ *
+ * @param filepath path of the checkpoint file
+ * @param interval a checkpoint is taken every interval iterations (0: never)
+ * @param seconds a checkpoint is taken if seconds have passed since the last one (0: never)
+ *
+ * @return A pointer to the checkpoints, NULL on failure
+ */
+stencil_checkpoint_t *stencil_checkpoint_new(const char *filepath, size_t interval, double seconds);
+
+/**
+ * Waits until the last checkpoint has been written and frees \a checkpoint.
+ *
+ * @return returns false if a checkpoint could not be written
+ */
+bool stencil_checkpoint_free(stencil_checkpoint_t *checkpoint);
+
+/**
+ * Maps the checkpoint file (see stencil_binary_map) and sets the iteration of
+ * \a checkpoint to the number of iterations done on it, the solvers continue with
+ * the next iteration.
+ *
+ * @return A pointer to the matrix of the latest checkpoint, NULL if there is none
+ */
+stencil_matrix_t *stencil_checkpoint_restore(stencil_checkpoint_t *checkpoint);
+
+/**
+ * @param iteration number of iterations done (including the restored ones)
+ *
+ * @return returns true if a checkpoint has to be taken after iteration \a iteration
+ */
+bool stencil_checkpoint_is_due(const stencil_checkpoint_t *checkpoint, size_t iteration);
+
+/**
+ * Copies the values of \a matrix into a snapshot and hands it to the background thread,
+ * only the copy is done by the calling thread.
+ *
+ * @param iteration number of iterations done on the values of \a matrix
+ *
+ * @return returns false if the snapshot cannot be allocated or the thread cannot be started
+ */
+bool stencil_checkpoint_take(stencil_checkpoint_t *checkpoint, const stencil_matrix_t *matrix, size_t iteration);
+
+/**
+ * Waits until all taken checkpoints have been written.
+ *
+ * @return returns false if a checkpoint could not be written
+ */
+bool stencil_checkpoint_wait(stencil_checkpoint_t *checkpoint);
+
+#endif // __STENCIL_CHECKPOINT_H
@@ -0,0 +1,27 @@
+#include "convergence.h"
+
+// external definitions of the inline functions (C99 inline semantics)
+void stencil_convergence_init(stencil_convergence_t *convergence, stencil_norm_t norm, double tolerance,
+                              size_t check_interval, size_t max_iterations);
+bool stencil_convergence_is_check(const stencil_convergence_t *convergence, size_t iteration);
+double stencil_residual_combine(stencil_norm_t norm, double a, double b);
+bool stencil_convergence_update(stencil_convergence_t *convergence, size_t iteration, double partial);
+
+double stencil_row_residual(stencil_norm_t norm, const double *new_values, const double *old_values, size_t count)
+{
+    double residual = 0.0;
+
+    if (norm == STENCIL_NORM_MAX) {
+        for (size_t i = 0; i < count; i++) {
+            const double diff = fabs(new_values[i] - old_values[i]);
+            residual = (diff > residual) ? diff : residual;
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            const double diff = new_values[i] - old_values[i];
+            residual += diff * diff;
+        }
+    }
+
+    return residual;
+}
@@ -0,0 +1,104 @@
+#ifndef __STENCIL_CONVERGENCE_H
+#define __STENCIL_CONVERGENCE_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <math.h>
+
+/**
+ * Norm of the update (new - old) of a sweep.
+ */
+enum stencil_norm {
+    STENCIL_NORM_MAX, // max |new - old|
+    STENCIL_NORM_L2   // sqrt(sum (new - old)^2)
+};
+typedef enum stencil_norm stencil_norm_t;
+
+#define STENCIL_CONVERGENCE_CHECK_INTERVAL 10
+
+/**
+ * Parameters and results of a convergence-driven iteration: the iteration stops
+ * as soon as the residual (norm of the update of one sweep) is <= tolerance or
+ * max_iterations iterations have been done. The residual is only calculated every
+ * check_interval iterations (and on the last one).
+ */
+struct stencil_convergence {
+    stencil_norm_t norm;
+    double tolerance;
+    size_t check_interval;
+    size_t max_iterations;
+
+    size_t iterations; // number of done iterations
+    double residual;   // last calculated residual
+};
+typedef struct stencil_convergence stencil_convergence_t;
+
+/**
+ * Initializes \a convergence with the given parameters (the results are reset).
+ *
+ * @param convergence A pointer to the convergence (must be valid)
+ * @param norm Norm of the residual
+ * @param tolerance Tolerance of the residual
+ * @param check_interval The residual is calculated every check_interval iterations (must be > 0)
+ * @param max_iterations Maximum number of iterations
+ */
+inline void stencil_convergence_init(stencil_convergence_t *convergence, stencil_norm_t norm, double tolerance,
+                                     size_t check_interval, size_t max_iterations)
+{
+    assert(convergence);
+    assert(check_interval > 0);
+
+    convergence->norm = norm;
+    convergence->tolerance = tolerance;
+    convergence->check_interval = check_interval;
+    convergence->max_iterations = max_iterations;
+    convergence->iterations = 0;
+    convergence->residual = INFINITY;
+}
+
+/**
+ * @return True if the residual has to be calculated in iteration \a iteration (starting at 1).
+ */
+inline bool stencil_convergence_is_check(const stencil_convergence_t *convergence, size_t iteration)
+{
+    return (iteration % convergence->check_interval == 0) || (iteration == convergence->max_iterations);
+}
+
+/**
+ * Combines two partial residuals (max for STENCIL_NORM_MAX, sum of squares for STENCIL_NORM_L2).
+ */
+inline double stencil_residual_combine(stencil_norm_t norm, double a, double b)
+{
+    if (norm == STENCIL_NORM_MAX) {
+        return (a > b) ? a : b;
+    }
+    return a + b;
+}
+
+/**
+ * Stores the residual of iteration \a iteration calculated from the combined partial
+ * residual \a partial.
+ *
+ * @return True if the iteration has converged.
+ */
+inline bool stencil_convergence_update(stencil_convergence_t *convergence, size_t iteration, double partial)
+{
+    convergence->iterations = iteration;
+    convergence->residual = (convergence->norm == STENCIL_NORM_L2) ? sqrt(partial) : partial;
+    return convergence->residual <= convergence->tolerance;
+}
+
+/**
+ * Calculates the partial residual of \a count updated fields.
+ *
+ * @param norm Norm of the residual
+ * @param new_values Pointer to the first new value
+ * @param old_values Pointer to the first old value
+ * @param count Number of fields
+ *
+ * @return max |new - old| or sum (new - old)^2
+ */
+double stencil_row_residual(stencil_norm_t norm, const double *new_values, const double *old_values, size_t count);
+
+#endif // __STENCIL_CONVERGENCE_H
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "binary.h"
+#include "snapshot.h"
+
+/**
+ * Writes the matrix \a matrix as csv file (with the size line read by new_matrix_from_file).
+ */
+static bool write_csv(const stencil_matrix_t *matrix, FILE *stream)
+{
+    if (stream == NULL || fprintf(stream, "%zu;%zu;%zu\n", matrix->rows, matrix->cols, matrix->boundary) < 0) {
+        return false;
+    }
+    return matrix_to_file(matrix, stream);
+}
+
+/**
+ * Converts a grid file between the csv and the binary format, the format of the
+ * input file is detected (binary grid files start with STENCIL_BINARY_MAGIC).
+ * Compressed snapshots are converted like csv files.
+ *
+ *   stencil_convert <input> <output> [float|snapshot]
+ *
+ * "float" writes a binary grid file with single-precision values, "snapshot" writes
+ * a compressed snapshot (see snapshot.h).
+ */
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <input> <output> [float|snapshot]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *input = fopen(argv[1], "r");
+    if (input == NULL) {
+        fprintf(stderr, "ERROR: cannot open %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    const bool binary = stencil_binary_is_binary(input);
+    fclose(input);
+
+    stencil_binary_header_t header;
+    if (binary && stencil_binary_read_header(argv[1], &header) && header.dtype == STENCIL_BINARY_FLOAT) {
+        // float values are written with the precision of the csv format ("%.3f")
+        stencil_matrix_float_t *matrix_float = stencil_binary_map_float(argv[1]);
+        stencil_matrix_t *matrix = (matrix_float != NULL) ? stencil_matrix_new(matrix_float->rows, matrix_float->cols,
+                                                                               matrix_float->boundary)
+                                                          : NULL;
+        if (matrix == NULL) {
+            fprintf(stderr, "ERROR: cannot read %s\n", argv[1]);
+            stencil_matrix_float_free(matrix_float);
+            return EXIT_FAILURE;
+        }
+        stencil_matrix_float_to_matrix(matrix_float, matrix);
+        stencil_matrix_float_free(matrix_float);
+
+        FILE *output = fopen(argv[2], "w");
+        const bool written = write_csv(matrix, output);
+        stencil_matrix_free(matrix);
+        if (output == NULL || fclose(output) != 0 || !written) {
+            fprintf(stderr, "ERROR: cannot write %s\n", argv[2]);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]); // maps binary grid files
+    if (matrix == NULL) {
+        fprintf(stderr, "ERROR: cannot read %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *output = fopen(argv[2], binary ? "w" : "wb");
+    bool written = false;
+    if (output != NULL) {
+        if (binary) {
+            written = write_csv(matrix, output);
+        } else if (argc > 3 && strcmp(argv[3], "float") == 0) {
+            stencil_matrix_float_t *matrix_float = stencil_matrix_float_from_matrix(matrix);
+            written = (matrix_float != NULL) && stencil_binary_write_float(matrix_float, output);
+            stencil_matrix_float_free(matrix_float);
+        } else if (argc > 3 && strcmp(argv[3], "snapshot") == 0) {
+            written = matrix_to_snapshot(matrix, output);
+        } else {
+            written = stencil_binary_write(matrix, output);
+        }
+        written = (fclose(output) == 0) && written;
+    }
+    stencil_matrix_free(matrix);
+
+    if (!written) {
+        fprintf(stderr, "ERROR: cannot write %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,423 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "csv.h"
+
+#define FAST_PATH_DIGITS 15 // 10^15 < 2^53, the digits are an exact double
+#define FAST_PATH_POWERS 22 // 10^22 is the largest exact power of ten
+
+static const double powers_of_ten[FAST_PATH_POWERS + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+size_t stencil_io_threads(size_t size)
+{
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    const char *env = getenv(STENCIL_IO_THREADS_ENV);
+    if (env != NULL && strtol(env, NULL, 10) > 0) {
+        threads = strtol(env, NULL, 10);
+    }
+
+    const size_t chunks = size / STENCIL_IO_CHUNK_SIZE;
+    if ((size_t)threads > chunks) {
+        threads = chunks;
+    }
+
+    return (threads > 1) ? (size_t)threads : 1;
+}
+
+void stencil_io_run_threads(void *(*function)(void *), void *args, size_t arg_size, size_t count)
+{
+    pthread_t threads[count];
+    bool created[count];
+
+    for (size_t i = 1; i < count; i++) {
+        created[i] = (pthread_create(&threads[i], NULL, function, (char *)args + i * arg_size) == 0);
+    }
+
+    function(args);
+
+    for (size_t i = 1; i < count; i++) {
+        if (created[i]) {
+            pthread_join(threads[i], NULL);
+        } else {
+            function((char *)args + i * arg_size);
+        }
+    }
+}
+
+/**
+ * @return returns the result of strtod on a copy of [\a begin, \a end)
+ */
+static double parse_double_strtod(const char *begin, const char *end)
+{
+    const size_t len = end - begin;
+
+    char buffer[64];
+    char *field = (len < sizeof(buffer)) ? buffer : (char *)malloc(len + 1);
+    if (field == NULL) {
+        return 0.0;
+    }
+    memcpy(field, begin, len);
+    field[len] = '\0';
+
+    const double value = strtod(field, NULL);
+
+    if (field != buffer) {
+        free(field);
+    }
+    return value;
+}
+
+double stencil_csv_parse_double(const char *begin, const char *end)
+{
+    const char *p = begin;
+
+    const bool negative = (p < end && *p == '-');
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+
+    uint64_t digits = 0;
+    size_t count = 0;
+    size_t fraction = 0;
+
+    for (; p < end && *p >= '0' && *p <= '9'; p++, count++) {
+        digits = digits * 10 + (uint64_t)(*p - '0');
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, count++, fraction++) {
+            digits = digits * 10 + (uint64_t)(*p - '0');
+        }
+    }
+
+    // everything else (exponents, hex, inf, nan, whitespace, ...) is left to strtod,
+    // strtod stops at the line end or separator as well
+    const bool terminated = (p == end) || (*p == '\n') || (*p == '\r') || (*p == ';');
+    if (count == 0 || count > FAST_PATH_DIGITS || fraction > FAST_PATH_POWERS || !terminated) {
+        return parse_double_strtod(begin, end);
+    }
+
+    const double value = (double)digits / powers_of_ten[fraction];
+    return negative ? -value : value;
+}
+
+/**
+ * Part of the file parsed by one thread, the chunk starts at the beginning of a line.
+ */
+struct chunk {
+    const char *begin;
+    const char *end;
+    size_t first_row; // row of the first line of the chunk
+    size_t lines;
+    stencil_matrix_t *matrix;
+    bool strict; // rejects additional fields and the line break as the last field
+    bool valid;
+};
+
+static void *count_lines(void *arg)
+{
+    struct chunk *chunk = (struct chunk *)arg;
+
+    chunk->lines = 0;
+    for (const char *p = chunk->begin; p < chunk->end; p++) {
+        p = (const char *)memchr(p, '\n', chunk->end - p);
+        if (p == NULL) {
+            chunk->lines++; // the last line of the file has no line break
+            break;
+        }
+        chunk->lines++;
+    }
+
+    return NULL;
+}
+
+static void *parse_lines(void *arg)
+{
+    struct chunk *chunk = (struct chunk *)arg;
+    stencil_matrix_t *matrix = chunk->matrix;
+
+    chunk->valid = true;
+
+    const char *line = chunk->begin;
+    for (size_t row = chunk->first_row; row < matrix->rows && line < chunk->end; row++) {
+        const char *line_end = (const char *)memchr(line, '\n', chunk->end - line);
+        line_end = (line_end != NULL) ? line_end + 1 : chunk->end; // the field includes the line break
+
+        double *values = matrix->values + row * matrix->stride;
+        const char *p = line;
+        for (size_t col = 0; col < matrix->cols; col++) {
+            while (p < line_end && *p == ';') { // empty fields are skipped (strtok)
+                p++;
+            }
+            // strict: the line break is not a field (a short row ending in ";\n")
+            if (p == line_end || (chunk->strict && (*p == '\n' || *p == '\r'))) {
+                chunk->valid = false;
+                return NULL;
+            }
+
+            const char *field_end = (const char *)memchr(p, ';', line_end - p);
+            field_end = (field_end != NULL) ? field_end : line_end;
+
+            values[col] = stencil_csv_parse_double(p, field_end);
+            p = field_end;
+        }
+
+        // strict: only separators and whitespace (the line break) may follow the last field
+        if (chunk->strict) {
+            while (p < line_end && (*p == ';' || *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+                p++;
+            }
+            if (p != line_end) {
+                chunk->valid = false;
+                return NULL;
+            }
+        }
+
+        line = line_end;
+    }
+
+    return NULL;
+}
+
+/**
+ * Reads the rest of \a stream.
+ *
+ * @param size Returns the number of bytes
+ * @return returns the buffer (must be freed), NULL on failure
+ */
+static char *read_rest(FILE *stream, size_t *size)
+{
+    struct stat file_stat;
+    const long position = ftell(stream);
+    size_t capacity = (position >= 0 && fstat(fileno(stream), &file_stat) == 0 && file_stat.st_size > position)
+                          ? (size_t)(file_stat.st_size - position)
+                          : STENCIL_IO_CHUNK_SIZE;
+
+    char *buffer = (char *)malloc(capacity);
+    *size = 0;
+    while (buffer != NULL) {
+        *size += fread(buffer + *size, 1, capacity - *size, stream);
+        if (*size < capacity) {
+            break; // end of file (or error)
+        }
+
+        capacity *= 2;
+        char *grown = (char *)realloc(buffer, capacity);
+        if (grown == NULL) {
+            free(buffer);
+            return NULL;
+        }
+        buffer = grown;
+    }
+
+    if (buffer != NULL && ferror(stream)) {
+        free(buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
+bool stencil_csv_read_values(stencil_matrix_t *matrix, FILE *stream)
+{
+    size_t size;
+    char *buffer = read_rest(stream, &size);
+    if (buffer == NULL) {
+        return false;
+    }
+
+    const char *const end = buffer + size;
+
+    const char *env = getenv(STENCIL_CSV_STRICT_ENV);
+    const bool strict = (env != NULL && strcmp(env, "1") == 0);
+
+    // split into chunks of about the same size which start at the beginning of a line
+    const size_t count = stencil_io_threads(size);
+    struct chunk chunks[count];
+    const char *begin = buffer;
+    for (size_t i = 0; i < count; i++) {
+        const char *split = (i == count - 1) ? end : buffer + (i + 1) * (size / count);
+        if (split < begin) {
+            split = begin;
+        } else if (split < end) {
+            split = (const char *)memchr(split, '\n', end - split);
+            split = (split != NULL) ? split + 1 : end;
+        }
+
+        chunks[i].begin = begin;
+        chunks[i].end = split;
+        chunks[i].matrix = matrix;
+        chunks[i].strict = strict;
+        begin = split;
+    }
+
+    // the first row of a chunk is the number of lines of all previous chunks
+    stencil_io_run_threads(count_lines, chunks, sizeof(struct chunk), count);
+    size_t lines = 0;
+    for (size_t i = 0; i < count; i++) {
+        chunks[i].first_row = lines;
+        lines += chunks[i].lines;
+    }
+
+    bool valid = (lines >= matrix->rows);
+    if (valid) {
+        stencil_io_run_threads(parse_lines, chunks, sizeof(struct chunk), count);
+        for (size_t i = 0; i < count; i++) {
+            valid = valid && chunks[i].valid;
+        }
+    }
+
+    free(buffer);
+    return valid;
+}
+
+#define FORMAT_FAST_LIMIT 1e12 // 1000 * |value| < 2^53, the rounding below is exact
+#define FORMAT_MAX_FIELD 320   // "%.3f;" of -DBL_MAX has 315 characters
+
+/**
+ * Writes \a value as "%.3f;" (rounded to nearest, ties to even like printf) to \a dest.
+ *
+ * @return returns the number of characters (at most FORMAT_MAX_FIELD - 1)
+ */
+static size_t format_field(char *dest, double value)
+{
+    const double magnitude = fabs(value);
+    if (!(magnitude < FORMAT_FAST_LIMIT)) { // also inf and nan
+        return (size_t)snprintf(dest, FORMAT_MAX_FIELD, "%.3f;", value);
+    }
+
+    // 1000 * magnitude = product + error exactly: the high part of the splitting has at
+    // most 43 significant bits, the low part at most 10 and 1000 has 7 (1000 = 125 * 8),
+    // thus both partial products are exact and the sum of them is split exactly (Fast2Sum)
+    const double split = magnitude * 1025.0;
+    const double high = split - (split - magnitude);
+    const double low = magnitude - high;
+    const double product = high * 1000.0 + low * 1000.0;
+    const double error = (high * 1000.0 - product) + low * 1000.0;
+
+    // product - integral is exact, it is compared with 0.5 exactly where it matters
+    const double integral = floor(product);
+    const double half = (product - integral) - 0.5;
+    uint64_t thousandths = (uint64_t)integral;
+    if (half > 0.0 || (half == 0.0 && error > 0.0) || (half == 0.0 && error == 0.0 && (thousandths & 1))) {
+        thousandths++;
+    }
+
+    char *p = dest;
+    if (signbit(value)) {
+        *p++ = '-'; // printf keeps the sign of negative values which are rounded to 0
+    }
+
+    char digits[20];
+    size_t count = 0;
+    uint64_t integer = thousandths / 1000;
+    do {
+        digits[count++] = (char)('0' + integer % 10);
+        integer /= 10;
+    } while (integer > 0);
+    while (count > 0) {
+        *p++ = digits[--count];
+    }
+
+    const unsigned fraction = (unsigned)(thousandths % 1000);
+    p[0] = '.';
+    p[1] = (char)('0' + fraction / 100);
+    p[2] = (char)('0' + fraction / 10 % 10);
+    p[3] = (char)('0' + fraction % 10);
+    p[4] = ';';
+
+    return (size_t)(p + 5 - dest);
+}
+
+/**
+ * Rows of the matrix formatted by one thread.
+ */
+struct block {
+    const stencil_matrix_t *matrix;
+    size_t first_row;
+    size_t rows;
+    char *buffer;
+    size_t capacity;
+    size_t size;
+    bool valid;
+};
+
+static void *format_rows(void *arg)
+{
+    struct block *block = (struct block *)arg;
+    const stencil_matrix_t *matrix = block->matrix;
+
+    block->size = 0;
+    block->valid = true;
+
+    for (size_t row = block->first_row; row < block->first_row + block->rows; row++) {
+        const double *values = matrix->values + row * matrix->stride;
+        for (size_t col = 0; col < matrix->cols; col++) {
+            if (block->capacity - block->size < FORMAT_MAX_FIELD + 1) { // field and line break
+                const size_t capacity = 2 * block->capacity + FORMAT_MAX_FIELD + 1;
+                char *buffer = (char *)realloc(block->buffer, capacity);
+                if (buffer == NULL) {
+                    block->valid = false;
+                    return NULL;
+                }
+                block->buffer = buffer;
+                block->capacity = capacity;
+            }
+
+            block->size += format_field(block->buffer + block->size, values[col]);
+        }
+        block->buffer[block->size++] = '\n';
+    }
+
+    return NULL;
+}
+
+bool stencil_csv_write(const stencil_matrix_t *matrix, FILE *stream)
+{
+    if (stream == NULL) {
+        return false;
+    }
+
+    // about 8 characters per field ("12.345;"), every thread formats STENCIL_IO_BLOCK_SIZE
+    // bytes per round which are written in order afterwards
+    const size_t row_size = 8 * (matrix->cols > 0 ? matrix->cols : 1);
+    const size_t count = stencil_io_threads(matrix->rows * row_size);
+    const size_t rows_per_block = (STENCIL_IO_BLOCK_SIZE > row_size) ? STENCIL_IO_BLOCK_SIZE / row_size : 1;
+
+    struct block blocks[count];
+    for (size_t i = 0; i < count; i++) {
+        blocks[i].matrix = matrix;
+        blocks[i].buffer = NULL;
+        blocks[i].capacity = 0;
+    }
+
+    bool written = true;
+    for (size_t row = 0; row < matrix->rows && written; row += count * rows_per_block) {
+        for (size_t i = 0; i < count; i++) {
+            const size_t first_row = row + i * rows_per_block;
+            blocks[i].first_row = (first_row < matrix->rows) ? first_row : matrix->rows;
+            blocks[i].rows = (matrix->rows - blocks[i].first_row < rows_per_block) ? matrix->rows - blocks[i].first_row
+                                                                                   : rows_per_block;
+        }
+
+        stencil_io_run_threads(format_rows, blocks, sizeof(struct block), count);
+
+        for (size_t i = 0; i < count && written; i++) {
+            written = blocks[i].valid && (fwrite(blocks[i].buffer, 1, blocks[i].size, stream) == blocks[i].size);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        free(blocks[i].buffer);
+    }
+
+    return written;
+}
@@ -0,0 +1,76 @@
+#ifndef __STENCIL_CSV_H
+#define __STENCIL_CSV_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "matrix.h"
+
+/**
+ * Name of the environment variable which limits the number of threads of the csv
+ * parser and writer (default: number of online processors).
+ */
+#define STENCIL_IO_THREADS_ENV "STENCIL_IO_THREADS"
+
+/**
+ * Name of the environment variable which enables the strict csv parser ("1"): lines with
+ * more fields than columns and lines whose line break would be their last field are
+ * rejected as well (default: accepted like by the strtok parser).
+ */
+#define STENCIL_CSV_STRICT_ENV "STENCIL_CSV_STRICT"
+
+/**
+ * Minimal number of bytes per thread, smaller files are processed by fewer threads.
+ */
+#define STENCIL_IO_CHUNK_SIZE (1024 * 1024)
+
+/**
+ * Number of bytes one thread of the csv writer formats before they are written.
+ */
+#define STENCIL_IO_BLOCK_SIZE (4 * 1024 * 1024)
+
+/**
+ * @param size Number of bytes to process
+ *
+ * @return returns the number of threads for \a size bytes (at least 1)
+ */
+size_t stencil_io_threads(size_t size);
+
+/**
+ * Runs \a function for all \a count arguments (array \a args of elements with \a arg_size
+ * bytes), each one on its own thread (the first one on the calling thread). Arguments
+ * whose thread could not be created are processed afterwards on the calling thread.
+ */
+void stencil_io_run_threads(void *(*function)(void *), void *args, size_t arg_size, size_t count);
+
+/**
+ * Parses the number in [\a begin, \a end) (a field of the csv file) with the result of
+ * strtod. Plain decimals (at most 15 significant digits and 22 fractional digits) are
+ * converted without strtod, the result is exact because both the digits and the power
+ * of ten are exact doubles and the division is correctly rounded.
+ */
+double stencil_csv_parse_double(const char *begin, const char *end);
+
+/**
+ * Reads all values (with boundary) of matrix \a matrix from \a stream, one row per line
+ * and the fields separated by ';' (empty fields are skipped like with strtok). The rest
+ * of the file is read at once and split into row-aligned chunks which are parsed in
+ * parallel.
+ *
+ * @return returns false if a line has fewer fields than columns or the file has fewer
+ *         lines than rows (additional fields and lines are ignored unless
+ *         STENCIL_CSV_STRICT_ENV is set)
+ */
+bool stencil_csv_read_values(stencil_matrix_t *matrix, FILE *stream);
+
+/**
+ * Writes all values (with boundary) of matrix \a matrix to \a stream, byte for byte the
+ * same as fprintf(stream, "%.3f;", value) per value and a line break per row. Blocks of
+ * rows are formatted in parallel into large buffers which are written in order.
+ *
+ * @return returns true if the matrix was written successfully
+ */
+bool stencil_csv_write(const stencil_matrix_t *matrix, FILE *stream);
+
+#endif // __STENCIL_CSV_H
@@ -0,0 +1,287 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "descriptor.h"
+#include "kernel.h"
+
+/* ---------- five-point ---------- */
+
+#define FIVE_POINT(X) \
+    X(-1, 0, 0.25) X(0, -1, 0.25) X(0, 1, 0.25) X(1, 0, 0.25)
+
+STENCIL_DEFINE_POINTS(five_point_offsets, FIVE_POINT)
+
+/**
+ * Uses the vectorized five-point kernel (equal to the generic kernel because
+ * multiplying by 0.25 is exact).
+ */
+static void five_point_row_kernel(const stencil_descriptor_t *descriptor, double *restrict dest,
+                                  const double *const *rows, size_t count)
+{
+    (void)descriptor;
+    stencil_five_point_row(dest, rows[0], rows[1], rows[2], count);
+}
+
+const stencil_descriptor_t stencil_five_point = {
+    .radius = 1,
+    .points = sizeof(five_point_offsets) / sizeof(stencil_point_t),
+    .offsets = five_point_offsets,
+    .row_kernel = five_point_row_kernel,
+};
+
+/* ---------- nine-point ---------- */
+
+#define NINE_POINT(X) \
+    X(-1, -1, 0.05) X(-1, 0, 0.2) X(-1, 1, 0.05) \
+    X( 0, -1, 0.2)                X( 0, 1, 0.2)  \
+    X( 1, -1, 0.05) X( 1, 0, 0.2) X( 1, 1, 0.05)
+
+STENCIL_DEFINE_POINTS(nine_point_offsets, NINE_POINT)
+STENCIL_DEFINE_ROW_KERNEL(nine_point_row_kernel, 1, NINE_POINT)
+
+const stencil_descriptor_t stencil_nine_point = {
+    .radius = 1,
+    .points = sizeof(nine_point_offsets) / sizeof(stencil_point_t),
+    .offsets = nine_point_offsets,
+    .row_kernel = nine_point_row_kernel,
+};
+
+/* ---------- thirteen-point ---------- */
+
+#define THIRTEEN_POINT(X) \
+                                          X(-2, 0, 0.0125)                                     \
+                    X(-1, -1, 0.0625)     X(-1, 0, 0.125)     X(-1, 1, 0.0625)                 \
+    X(0, -2, 0.0125) X(0, -1, 0.125)      X( 0, 0, 0.2)       X( 0, 1, 0.125)  X(0, 2, 0.0125) \
+                    X( 1, -1, 0.0625)     X( 1, 0, 0.125)     X( 1, 1, 0.0625)                 \
+                                          X( 2, 0, 0.0125)
+
+STENCIL_DEFINE_POINTS(thirteen_point_offsets, THIRTEEN_POINT)
+STENCIL_DEFINE_ROW_KERNEL(thirteen_point_row_kernel, 2, THIRTEEN_POINT)
+
+const stencil_descriptor_t stencil_thirteen_point = {
+    .radius = 2,
+    .points = sizeof(thirteen_point_offsets) / sizeof(stencil_point_t),
+    .offsets = thirteen_point_offsets,
+    .row_kernel = thirteen_point_row_kernel,
+};
+
+/* ---------- anisotropic five-point (runtime coefficients) ---------- */
+
+#define ANISOTROPIC_FIVE_POINT(X) \
+    X(-1, 0, STENCIL_COEFFICIENT(0)) X(0, -1, STENCIL_COEFFICIENT(1)) \
+    X(0, 1, STENCIL_COEFFICIENT(2)) X(1, 0, STENCIL_COEFFICIENT(3))
+
+STENCIL_DEFINE_ROW_KERNEL(anisotropic_five_point_row_kernel, 1, ANISOTROPIC_FIVE_POINT)
+
+/* ---------- generic ---------- */
+
+static void generic_row_kernel(const stencil_descriptor_t *descriptor, double *restrict dest,
+                               const double *const *rows, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        dest[i] = -0.0;
+    }
+
+    for (size_t p = 0; p < descriptor->points; p++) {
+        const stencil_point_t *point = &descriptor->offsets[p];
+        const double coefficient = point->coefficient;
+        const double *src = rows[point->row_offset + (long)descriptor->radius] + point->col_offset;
+        for (size_t i = 0; i < count; i++) {
+            dest[i] += coefficient * src[i];
+        }
+    }
+}
+
+static stencil_descriptor_t *stencil_descriptor_alloc(size_t points, const stencil_point_t *offsets,
+                                                      stencil_row_kernel_t row_kernel)
+{
+    stencil_point_t *copy = (stencil_point_t *)malloc(points * sizeof(stencil_point_t));
+    if (!copy) {
+        goto exit_offsets;
+    }
+    memcpy(copy, offsets, points * sizeof(stencil_point_t));
+
+    stencil_descriptor_t *descriptor = (stencil_descriptor_t *)malloc(sizeof(stencil_descriptor_t));
+    if (!descriptor) {
+        goto exit_descriptor;
+    }
+
+    size_t radius = 0;
+    for (size_t p = 0; p < points; p++) {
+        const size_t row_distance = abs(offsets[p].row_offset);
+        const size_t col_distance = abs(offsets[p].col_offset);
+        radius = (row_distance > radius) ? row_distance : radius;
+        radius = (col_distance > radius) ? col_distance : radius;
+    }
+
+    descriptor->radius = radius;
+    descriptor->points = points;
+    descriptor->offsets = copy;
+    descriptor->row_kernel = row_kernel;
+
+    return descriptor;
+
+exit_descriptor:
+    free(copy);
+exit_offsets:
+    return NULL;
+}
+
+stencil_descriptor_t *stencil_descriptor_new(size_t points, const stencil_point_t *offsets)
+{
+    assert(offsets);
+
+    return stencil_descriptor_alloc(points, offsets, generic_row_kernel);
+}
+
+stencil_descriptor_t *stencil_descriptor_new_anisotropic(double weight_vertical, double weight_horizontal)
+{
+    assert(weight_vertical + weight_horizontal > 0.0);
+
+    const double vertical = weight_vertical / (2.0 * (weight_vertical + weight_horizontal));
+    const double horizontal = weight_horizontal / (2.0 * (weight_vertical + weight_horizontal));
+    const stencil_point_t offsets[] = {
+        {-1, 0, vertical}, {0, -1, horizontal}, {0, 1, horizontal}, {1, 0, vertical}
+    };
+
+    return stencil_descriptor_alloc(sizeof(offsets) / sizeof(stencil_point_t), offsets,
+                                    anisotropic_five_point_row_kernel);
+}
+
+void stencil_descriptor_free(stencil_descriptor_t *descriptor)
+{
+    if (!descriptor) {
+        return;
+    }
+
+    free((stencil_point_t *)descriptor->offsets);
+    free(descriptor);
+}
+
+bool stencil_descriptor_has_diagonals(const stencil_descriptor_t *descriptor)
+{
+    assert(descriptor);
+
+    for (size_t p = 0; p < descriptor->points; p++) {
+        if (descriptor->offsets[p].row_offset != 0 && descriptor->offsets[p].col_offset != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void stencil_descriptor_row(const stencil_descriptor_t *descriptor, double *restrict dest,
+                            const stencil_matrix_t *matrix, size_t row, size_t col, size_t count)
+{
+    assert(descriptor);
+    assert(matrix);
+    assert(row >= descriptor->radius && col >= descriptor->radius);
+
+    const size_t radius = descriptor->radius;
+
+    const double *rows[2 * radius + 1];
+    for (size_t i = 0; i <= 2 * radius; i++) {
+        rows[i] = stencil_matrix_get_ptr(matrix, row - radius + i, col);
+    }
+
+    descriptor->row_kernel(descriptor, dest, rows, count);
+}
+
+/**
+ * In-place sweep, calculates the partial residual if \a residual is true.
+ */
+static double descriptor_sweep(const stencil_descriptor_t *descriptor, stencil_matrix_t *matrix, double *buffer,
+                               bool residual, stencil_norm_t norm)
+{
+    assert(descriptor);
+    assert(matrix);
+    assert(matrix->boundary >= descriptor->radius);
+
+    const size_t first_row = matrix->boundary;
+    const size_t end_row = matrix->rows - matrix->boundary;
+    const size_t col = matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    double partial = 0.0;
+
+    if (end_row <= first_row) {
+        return partial;
+    }
+
+    // the five-point stencil has a fused in-place kernel (one vector)
+    if (descriptor->row_kernel == five_point_row_kernel) {
+        if (residual) {
+            partial = stencil_five_point_row_residual(buffer + col,
+                                                      stencil_matrix_get_ptr(matrix, first_row - 1, col),
+                                                      stencil_matrix_get_ptr(matrix, first_row, col),
+                                                      stencil_matrix_get_ptr(matrix, first_row + 1, col),
+                                                      cols, norm);
+        } else {
+            stencil_five_point_row(buffer + col,
+                                   stencil_matrix_get_ptr(matrix, first_row - 1, col),
+                                   stencil_matrix_get_ptr(matrix, first_row, col),
+                                   stencil_matrix_get_ptr(matrix, first_row + 1, col),
+                                   cols);
+        }
+        for (size_t row = first_row + 1; row < end_row; row++) {
+            if (residual) {
+                const double row_partial =
+                    stencil_five_point_row_one_vector_residual(stencil_matrix_get_ptr(matrix, row - 1, col),
+                                                               buffer + col,
+                                                               stencil_matrix_get_ptr(matrix, row, col),
+                                                               stencil_matrix_get_ptr(matrix, row + 1, col),
+                                                               cols, norm);
+                partial = stencil_residual_combine(norm, partial, row_partial);
+            } else {
+                stencil_five_point_row_one_vector(stencil_matrix_get_ptr(matrix, row - 1, col),
+                                                  buffer + col,
+                                                  stencil_matrix_get_ptr(matrix, row, col),
+                                                  stencil_matrix_get_ptr(matrix, row + 1, col),
+                                                  cols);
+            }
+        }
+        memcpy(stencil_matrix_get_ptr(matrix, end_row - 1, col), buffer + col, cols * sizeof(double));
+        return partial;
+    }
+
+    // row r may only be written back after row r + radius has been calculated
+    const size_t radius = descriptor->radius;
+    const size_t slots = radius + 1;
+
+    for (size_t row = first_row; row < end_row; row++) {
+        double *new_values = buffer + (row % slots) * matrix->cols + col;
+        stencil_descriptor_row(descriptor, new_values, matrix, row, col, cols);
+
+        if (residual) {
+            const double row_partial = stencil_row_residual(norm, new_values,
+                                                            stencil_matrix_get_ptr(matrix, row, col), cols);
+            partial = stencil_residual_combine(norm, partial, row_partial);
+        }
+
+        if (row >= first_row + radius) {
+            const size_t done = row - radius;
+            memcpy(stencil_matrix_get_ptr(matrix, done, col), buffer + (done % slots) * matrix->cols + col,
+                   cols * sizeof(double));
+        }
+    }
+
+    // copy back the remaining rows
+    const size_t pending = (end_row - first_row > radius) ? (end_row - radius) : first_row;
+    for (size_t row = pending; row < end_row; row++) {
+        memcpy(stencil_matrix_get_ptr(matrix, row, col), buffer + (row % slots) * matrix->cols + col,
+               cols * sizeof(double));
+    }
+
+    return partial;
+}
+
+void stencil_descriptor_sweep(const stencil_descriptor_t *descriptor, stencil_matrix_t *matrix, double *buffer)
+{
+    descriptor_sweep(descriptor, matrix, buffer, false, STENCIL_NORM_MAX);
+}
+
+double stencil_descriptor_sweep_residual(const stencil_descriptor_t *descriptor, stencil_matrix_t *matrix,
+                                         double *buffer, stencil_norm_t norm)
+{
+    return descriptor_sweep(descriptor, matrix, buffer, true, norm);
+}
@@ -0,0 +1,148 @@
+#ifndef __STENCIL_DESCRIPTOR_H
+#define __STENCIL_DESCRIPTOR_H
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "matrix.h"
+#include "convergence.h"
+
+/**
+ * A point of a stencil: the new value of a field is the sum of
+ * coefficient * matrix[row + row_offset, col + col_offset] over all points.
+ */
+struct stencil_point {
+    int row_offset;
+    int col_offset;
+    double coefficient;
+};
+typedef struct stencil_point stencil_point_t;
+
+struct stencil_descriptor;
+
+/**
+ * Calculates \a count consecutive fields of a row.
+ *
+ * @param descriptor The stencil descriptor
+ * @param dest Destination of the new values (must not overlap the source rows)
+ * @param rows 2 * radius + 1 pointers to the first field of the rows [row - radius, row + radius]
+ * @param count Number of fields to calculate
+ */
+typedef void (*stencil_row_kernel_t)(const struct stencil_descriptor *descriptor, double *restrict dest,
+                                     const double *const *rows, size_t count);
+
+struct stencil_descriptor {
+    size_t radius; // max. row/col distance of the points (the matrix boundary must be at least as large)
+    size_t points;
+    const stencil_point_t *offsets;
+    stencil_row_kernel_t row_kernel;
+};
+typedef struct stencil_descriptor stencil_descriptor_t;
+
+/**
+ * (above + left + right + below) * 0.25, bit-identical to the five-point kernels.
+ */
+extern const stencil_descriptor_t stencil_five_point;
+
+/**
+ * Nine-point (Mehrstellen) Laplace stencil: 0.2 * direct neighbours + 0.05 * diagonal neighbours.
+ */
+extern const stencil_descriptor_t stencil_nine_point;
+
+/**
+ * Thirteen-point stencil with radius 2: 0.2 * center + 0.125 * direct neighbours
+ * + 0.0625 * diagonal neighbours + 0.0125 * neighbours at distance 2.
+ */
+extern const stencil_descriptor_t stencil_thirteen_point;
+
+/**
+ * Creates a new stencil descriptor from the \a points points \a offsets (the points
+ * are copied). The descriptor uses the generic row kernel.
+ *
+ * @return A pointer to a descriptor, NULL on failure.
+ */
+stencil_descriptor_t *stencil_descriptor_new(size_t points, const stencil_point_t *offsets);
+
+/**
+ * Creates a new anisotropic five-point stencil descriptor:
+ * (weight_vertical * (above + below) + weight_horizontal * (left + right)) normalized to a sum of 1.
+ *
+ * @return A pointer to a descriptor, NULL on failure.
+ */
+stencil_descriptor_t *stencil_descriptor_new_anisotropic(double weight_vertical, double weight_horizontal);
+
+/**
+ * Frees a descriptor created by one of the stencil_descriptor_new functions.
+ */
+void stencil_descriptor_free(stencil_descriptor_t *descriptor);
+
+/**
+ * @return True if the stencil reads diagonal neighbours (halo corners are needed).
+ */
+bool stencil_descriptor_has_diagonals(const stencil_descriptor_t *descriptor);
+
+/**
+ * Applies the stencil to \a count consecutive fields of row \a row of matrix \a matrix,
+ * starting at column \a col.
+ *
+ * @param descriptor The stencil descriptor
+ * @param dest Destination of the new values (must not overlap the matrix)
+ * @param matrix A pointer to the matrix (must be valid)
+ * @param row Row index (must be in range [radius, matrix.rows - radius[)
+ * @param col Column index of the first field (must be >= radius)
+ * @param count Number of fields to calculate
+ */
+void stencil_descriptor_row(const stencil_descriptor_t *descriptor, double *restrict dest,
+                            const stencil_matrix_t *matrix, size_t row, size_t col, size_t count);
+
+/**
+ * Performs one in-place iteration of the stencil on the non-boundary fields of matrix \a matrix.
+ * The new rows are buffered until no other row depends on the old values anymore.
+ *
+ * @param descriptor The stencil descriptor (descriptor.radius must be <= matrix.boundary)
+ * @param matrix A pointer to the matrix (must be valid)
+ * @param buffer Buffer of (descriptor.radius + 1) * matrix.cols values
+ */
+void stencil_descriptor_sweep(const stencil_descriptor_t *descriptor, stencil_matrix_t *matrix, double *buffer);
+
+/**
+ * Same as stencil_descriptor_sweep, additionally calculates the partial residual of the sweep.
+ *
+ * @param norm Norm of the residual
+ * @return The partial residual (see stencil_row_residual)
+ */
+double stencil_descriptor_sweep_residual(const stencil_descriptor_t *descriptor, stencil_matrix_t *matrix,
+                                         double *buffer, stencil_norm_t norm);
+
+/*
+ * Macros to generate compile-time specialized row kernels. A stencil is given as a
+ * list macro which calls X(row_offset, col_offset, coefficient) for every point, e.g.
+ *
+ *   #define MY_POINTS(X) X(-1, 0, 0.5) X(1, 0, 0.5)
+ *   STENCIL_DEFINE_POINTS(my_points, MY_POINTS)
+ *   STENCIL_DEFINE_ROW_KERNEL(my_row_kernel, 1, MY_POINTS)
+ *
+ * The terms are summed up in the given order, thus a specialized kernel produces the
+ * same values as the generic kernel for the same points. The coefficient may also be
+ * an expression like STENCIL_COEFFICIENT(i) (runtime coefficients, fixed shape).
+ */
+#define STENCIL_POINT_INITIALIZER(row_offset, col_offset, coefficient) { (row_offset), (col_offset), (coefficient) },
+#define STENCIL_KERNEL_TERM(row_offset, col_offset, coefficient) \
+    + (coefficient) * rows_[(row_offset) + radius_][i_ + (col_offset)]
+#define STENCIL_COEFFICIENT(i) (descriptor_->offsets[i].coefficient)
+
+#define STENCIL_DEFINE_POINTS(name, POINTS) \
+    static const stencil_point_t name[] = { POINTS(STENCIL_POINT_INITIALIZER) };
+
+#define STENCIL_DEFINE_ROW_KERNEL(name, radius, POINTS)                                           \
+    static void name(const stencil_descriptor_t *descriptor_, double *restrict dest_,             \
+                     const double *const *rows_, size_t count_)                                    \
+    {                                                                                             \
+        enum { radius_ = (radius) };                                                              \
+        (void)descriptor_;                                                                        \
+        for (size_t i_ = 0; i_ < count_; i_++) {                                                  \
+            dest_[i_] = -0.0 POINTS(STENCIL_KERNEL_TERM);                                         \
+        }                                                                                         \
+    }
+
+#endif // __STENCIL_DESCRIPTOR_H
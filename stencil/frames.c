@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "frames.h"
+#include "binary.h"
+#include "util.h"
+
+/**
+ * Built-in writer, writes the frame to the file <prefix>.<iteration>.
+ */
+static bool write_frame_file(const stencil_matrix_t *frame, size_t iteration, void *arg)
+{
+    const stencil_frames_t *frames = (const stencil_frames_t *)arg;
+
+    const int len = snprintf(NULL, 0, "%s.%zu", frames->prefix, iteration);
+    char *filepath = (char *)malloc(len + 1);
+    if (filepath == NULL) {
+        return false;
+    }
+    snprintf(filepath, len + 1, "%s.%zu", frames->prefix, iteration);
+
+    bool written = false;
+    FILE *stream = fopen(filepath, (frames->format == STENCIL_FRAME_CSV) ? "w" : "wb");
+    if (stream != NULL) {
+        switch (frames->format) {
+        case STENCIL_FRAME_CSV:
+            written = (fprintf(stream, "%zu;%zu;%zu\n", frame->rows, frame->cols, frame->boundary) > 0) &&
+                      matrix_to_file(frame, stream);
+            break;
+        case STENCIL_FRAME_BINARY:
+            written = stencil_binary_write(frame, stream);
+            break;
+        case STENCIL_FRAME_SNAPSHOT:
+            written = matrix_to_snapshot(frame, stream);
+            break;
+        }
+        written = (fclose(stream) == 0) && written;
+    }
+
+    free(filepath);
+    return written;
+}
+
+/**
+ * Writer thread, writes one frame per post of the semaphore. The post of
+ * stencil_frames_free finds the queue empty and stops the thread.
+ */
+static void *write_frames(void *arg)
+{
+    stencil_frames_t *frames = (stencil_frames_t *)arg;
+
+    for (;;) {
+        while (sem_wait(&frames->filled) != 0) {
+            // interrupted by a signal
+        }
+
+        const size_t tail = frames->tail;
+        if (tail == __atomic_load_n(&frames->head, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+
+        const size_t slot = tail % frames->slot_count;
+        if (!frames->write(frames->slots[slot], frames->slot_iterations[slot], frames->arg)) {
+            frames->failed = true;
+        }
+
+        // the slot can be filled again
+        __atomic_store_n(&frames->tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+stencil_frames_t *stencil_frames_new_callback(stencil_frame_write_t write, void *arg, const stencil_matrix_t *matrix,
+                                              size_t interval, size_t slots)
+{
+    stencil_frames_t *frames = (stencil_frames_t *)malloc(sizeof(stencil_frames_t));
+    if (!frames) {
+        goto exit_frames;
+    }
+
+    frames->slot_count = (slots > 0) ? slots : STENCIL_FRAMES_SLOTS;
+    frames->slots = (stencil_matrix_t **)calloc(frames->slot_count, sizeof(stencil_matrix_t *));
+    if (!frames->slots) {
+        goto exit_slots;
+    }
+    frames->slot_iterations = (size_t *)calloc(frames->slot_count, sizeof(size_t));
+    if (!frames->slot_iterations) {
+        goto exit_slot_iterations;
+    }
+    for (size_t i = 0; i < frames->slot_count; i++) {
+        frames->slots[i] = stencil_matrix_new(matrix->rows, matrix->cols, matrix->boundary);
+        if (!frames->slots[i]) {
+            goto exit_slot_values;
+        }
+    }
+
+    if (sem_init(&frames->filled, 0, 0) != 0) {
+        goto exit_semaphore;
+    }
+
+    frames->interval = interval;
+    frames->write = write;
+    frames->arg = arg;
+    frames->prefix = NULL;
+    frames->format = STENCIL_FRAME_BINARY;
+    frames->head = 0;
+    frames->tail = 0;
+    frames->dropped = 0;
+    frames->failed = false;
+    frames->started = false;
+
+    return frames;
+
+exit_semaphore:
+exit_slot_values:
+    for (size_t i = 0; i < frames->slot_count; i++) {
+        stencil_matrix_free(frames->slots[i]);
+    }
+    free(frames->slot_iterations);
+exit_slot_iterations:
+    free(frames->slots);
+exit_slots:
+    free(frames);
+exit_frames:
+    return NULL;
+}
+
+stencil_frames_t *stencil_frames_new(const char *prefix, stencil_frame_format_t format, const stencil_matrix_t *matrix,
+                                     size_t interval, size_t slots)
+{
+    stencil_frames_t *frames = stencil_frames_new_callback(write_frame_file, NULL, matrix, interval, slots);
+    if (!frames) {
+        return NULL;
+    }
+
+    frames->arg = frames;
+    frames->format = format;
+    frames->prefix = strdup(prefix);
+    if (!frames->prefix) {
+        stencil_frames_free(frames);
+        return NULL;
+    }
+
+    return frames;
+}
+
+bool stencil_frames_free(stencil_frames_t *frames)
+{
+    if (!frames) {
+        return true;
+    }
+
+    if (frames->started) {
+        // the writer writes all waiting frames before it stops
+        sem_post(&frames->filled);
+        pthread_join(frames->thread, NULL);
+    }
+
+    const bool written = !frames->failed;
+
+    for (size_t i = 0; i < frames->slot_count; i++) {
+        stencil_matrix_free(frames->slots[i]);
+    }
+    sem_destroy(&frames->filled);
+    free(frames->prefix);
+    free(frames->slot_iterations);
+    free(frames->slots);
+    free(frames);
+
+    return written;
+}
+
+bool stencil_frames_is_due(const stencil_frames_t *frames, size_t iteration)
+{
+    return (frames->interval > 0) && (iteration % frames->interval == 0);
+}
+
+stencil_matrix_t *stencil_frames_acquire(stencil_frames_t *frames, const stencil_matrix_t *matrix)
+{
+    const size_t head = frames->head;
+    if (head - __atomic_load_n(&frames->tail, __ATOMIC_ACQUIRE) == frames->slot_count) {
+        frames->dropped++;
+        return NULL;
+    }
+
+    // the slots are allocated by stencil_frames_new, the calculation never allocates
+    stencil_matrix_t *values = frames->slots[head % frames->slot_count];
+    if (values->rows != matrix->rows || values->cols != matrix->cols || values->boundary != matrix->boundary) {
+        frames->dropped++;
+        return NULL;
+    }
+
+    return values;
+}
+
+bool stencil_frames_publish(stencil_frames_t *frames, size_t iteration)
+{
+    if (!frames->started) {
+        if (pthread_create(&frames->thread, NULL, write_frames, frames) != 0) {
+            return false;
+        }
+        frames->started = true;
+    }
+
+    const size_t head = frames->head;
+    frames->slot_iterations[head % frames->slot_count] = iteration;
+
+    // the values of the slot are visible to the writer before the new head
+    __atomic_store_n(&frames->head, head + 1, __ATOMIC_RELEASE);
+    sem_post(&frames->filled);
+
+    return true;
+}
+
+bool stencil_frames_capture(stencil_frames_t *frames, const stencil_matrix_t *matrix, size_t iteration)
+{
+    stencil_matrix_t *frame = stencil_frames_acquire(frames, matrix);
+    if (frame == NULL) {
+        return false;
+    }
+
+    stencil_matrix_copy_values(frame, matrix);
+    return stencil_frames_publish(frames, iteration);
+}
@@ -0,0 +1,123 @@
+#ifndef __STENCIL_FRAMES_H
+#define __STENCIL_FRAMES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include "matrix.h"
+
+/**
+ * Default number of frames which can wait for the writer.
+ */
+#define STENCIL_FRAMES_SLOTS 4
+
+/**
+ * Writes the frame \a frame of iteration \a iteration (called on the writer thread).
+ *
+ * @return returns true if the frame was written successfully
+ */
+typedef bool (*stencil_frame_write_t)(const stencil_matrix_t *frame, size_t iteration, void *arg);
+
+enum stencil_frame_format {
+    STENCIL_FRAME_CSV = 0,      // csv file with the size line (see new_matrix_from_file)
+    STENCIL_FRAME_BINARY = 1,   // binary grid file (see binary.h)
+    STENCIL_FRAME_SNAPSHOT = 2  // compressed snapshot (see snapshot.h)
+};
+typedef enum stencil_frame_format stencil_frame_format_t;
+
+/**
+ * Frames of a run, a copy of the matrix every \a interval iterations which is written by
+ * a background thread.
+ *
+ * The frames are copied into a ring of slots, a single-producer single-consumer queue:
+ * the calculation fills the slot at head, the writer writes the slot at tail, each one
+ * only advances its own index (atomically) and reads the other one. If all slots wait
+ * for the writer, the frame is dropped, thus the calculation never waits for the disk.
+ * A semaphore wakes the writer (sem_post does not block).
+ */
+struct stencil_frames {
+    size_t interval;
+    stencil_frame_write_t write;
+    void *arg;
+
+    // built-in writer: <prefix>.<iteration>
+    char *prefix;
+    stencil_frame_format_t format;
+
+    size_t slot_count;
+    stencil_matrix_t **slots;
+    size_t *slot_iterations;
+    size_t head; // frames handed to the writer (written by the calculation)
+    size_t tail; // frames written (written by the writer)
+
+    size_t dropped; // frames dropped because all slots were waiting
+    bool failed; // a write has failed
+
+    bool started; // the writer is started with the first frame
+    pthread_t thread;
+    sem_t filled;
+};
+typedef struct stencil_frames stencil_frames_t;
+
+/**
+ * Creates the frames of a run which are written to the files <prefix>.<iteration>.
+ *
+ * @param matrix the slots are allocated with the size of \a matrix, thus taking a frame
+ *               does not allocate
+ * @param interval a frame is taken every interval iterations
+ * @param slots number of frames which can wait for the writer (0: STENCIL_FRAMES_SLOTS)
+ *
+ * @return A pointer to the frames, NULL on failure
+ */
+stencil_frames_t *stencil_frames_new(const char *prefix, stencil_frame_format_t format, const stencil_matrix_t *matrix,
+                                     size_t interval, size_t slots);
+
+/**
+ * Same as stencil_frames_new, but the frames are handed to \a write.
+ */
+stencil_frames_t *stencil_frames_new_callback(stencil_frame_write_t write, void *arg, const stencil_matrix_t *matrix,
+                                              size_t interval, size_t slots);
+
+/**
+ * Waits until all frames have been written and frees \a frames.
+ *
+ * @return returns false if a frame could not be written
+ */
+bool stencil_frames_free(stencil_frames_t *frames);
+
+/**
+ * @param iteration number of iterations done
+ *
+ * @return returns true if a frame has to be taken after iteration \a iteration
+ */
+bool stencil_frames_is_due(const stencil_frames_t *frames, size_t iteration);
+
+/**
+ * Returns the free slot for the next frame of \a matrix, the values are copied into it
+ * (e.g. by all threads of a parallel region) and it is handed to the writer with
+ * stencil_frames_publish.
+ *
+ * @return A pointer to the slot, NULL if all slots wait for the writer or \a matrix
+ *         differs in size from the slots (the frame is dropped)
+ */
+stencil_matrix_t *stencil_frames_acquire(stencil_frames_t *frames, const stencil_matrix_t *matrix);
+
+/**
+ * Hands the slot returned by stencil_frames_acquire to the writer.
+ *
+ * @param iteration number of iterations done on the values of the frame
+ *
+ * @return returns false if the writer cannot be started
+ */
+bool stencil_frames_publish(stencil_frames_t *frames, size_t iteration);
+
+/**
+ * Copies the values of \a matrix into a free slot and hands it to the writer.
+ *
+ * @return returns false if the frame is dropped or the writer cannot be started
+ */
+bool stencil_frames_capture(stencil_frames_t *frames, const stencil_matrix_t *matrix, size_t iteration);
+
+#endif // __STENCIL_FRAMES_H
@@ -0,0 +1,268 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <immintrin.h>
+
+#include "kernel.h"
+
+// external definitions of the inline functions (C99 inline semantics)
+double stencil_five_point_kernel(const stencil_matrix_t *const matrix, size_t row, size_t col);
+size_t stencil_sor_first(const stencil_matrix_t *matrix, size_t row, stencil_colour_t colour, size_t parity);
+
+struct stencil_kernel_ops {
+    const char *isa;
+    void (*five_point_row)(double *restrict, const double *, const double *, const double *, size_t);
+    void (*five_point_row_one_vector)(double *, double *restrict, const double *, const double *, size_t);
+    double (*five_point_row_residual)(double *restrict, const double *, const double *, const double *, size_t,
+                                      stencil_norm_t);
+    double (*five_point_row_one_vector_residual)(double *, double *restrict, const double *, const double *, size_t,
+                                                 stencil_norm_t);
+    void (*five_point_row_float)(float *restrict, const float *, const float *, const float *, size_t,
+                                 stencil_precision_t);
+    void (*five_point_row_one_vector_float)(float *, float *restrict, const float *, const float *, size_t,
+                                            stencil_precision_t);
+};
+
+/* ---------- SSE2 (baseline) ---------- */
+
+#define KERNEL_FN(name) name ## _sse2
+#define KERNEL_ISA "sse2"
+#define VEC __m128d
+#define VEC_WIDTH 2
+#define VEC_LOAD(p) _mm_loadu_pd(p)
+#define VEC_STORE(p, v) _mm_storeu_pd((p), (v))
+#define VEC_ADD(a, b) _mm_add_pd((a), (b))
+#define VEC_MUL(a, b) _mm_mul_pd((a), (b))
+#define VEC_SET1(x) _mm_set1_pd(x)
+#define VEC_SUB(a, b) _mm_sub_pd((a), (b))
+#define VEC_MAX(a, b) _mm_max_pd((a), (b))
+#define VEC_ABS(a) _mm_andnot_pd(_mm_set1_pd(-0.0), (a))
+#include "kernel_simd.h"
+#undef KERNEL_FN
+#undef KERNEL_ISA
+#undef VEC
+#undef VEC_WIDTH
+#undef VEC_LOAD
+#undef VEC_STORE
+#undef VEC_ADD
+#undef VEC_MUL
+#undef VEC_SET1
+#undef VEC_SUB
+#undef VEC_MAX
+#undef VEC_ABS
+
+/* ---------- AVX2 ---------- */
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define KERNEL_FN(name) name ## _avx2
+#define KERNEL_ISA "avx2"
+#define VEC __m256d
+#define VEC_WIDTH 4
+#define VEC_LOAD(p) _mm256_loadu_pd(p)
+#define VEC_STORE(p, v) _mm256_storeu_pd((p), (v))
+#define VEC_ADD(a, b) _mm256_add_pd((a), (b))
+#define VEC_MUL(a, b) _mm256_mul_pd((a), (b))
+#define VEC_SET1(x) _mm256_set1_pd(x)
+#define VEC_SUB(a, b) _mm256_sub_pd((a), (b))
+#define VEC_MAX(a, b) _mm256_max_pd((a), (b))
+#define VEC_ABS(a) _mm256_andnot_pd(_mm256_set1_pd(-0.0), (a))
+#include "kernel_simd.h"
+#undef KERNEL_FN
+#undef KERNEL_ISA
+#undef VEC
+#undef VEC_WIDTH
+#undef VEC_LOAD
+#undef VEC_STORE
+#undef VEC_ADD
+#undef VEC_MUL
+#undef VEC_SET1
+#undef VEC_SUB
+#undef VEC_MAX
+#undef VEC_ABS
+#pragma GCC pop_options
+
+/* ---------- AVX-512 ---------- */
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#define KERNEL_FN(name) name ## _avx512
+#define KERNEL_ISA "avx512"
+#define VEC __m512d
+#define VEC_WIDTH 8
+#define VEC_LOAD(p) _mm512_loadu_pd(p)
+#define VEC_STORE(p, v) _mm512_storeu_pd((p), (v))
+#define VEC_ADD(a, b) _mm512_add_pd((a), (b))
+#define VEC_MUL(a, b) _mm512_mul_pd((a), (b))
+#define VEC_SET1(x) _mm512_set1_pd(x)
+#define VEC_SUB(a, b) _mm512_sub_pd((a), (b))
+#define VEC_MAX(a, b) _mm512_max_pd((a), (b))
+#define VEC_ABS(a) _mm512_abs_pd(a)
+#include "kernel_simd.h"
+#undef KERNEL_FN
+#undef KERNEL_ISA
+#undef VEC
+#undef VEC_WIDTH
+#undef VEC_LOAD
+#undef VEC_STORE
+#undef VEC_ADD
+#undef VEC_MUL
+#undef VEC_SET1
+#undef VEC_SUB
+#undef VEC_MAX
+#undef VEC_ABS
+#pragma GCC pop_options
+
+/* ---------- runtime dispatch ---------- */
+
+static const struct stencil_kernel_ops *kernel_ops = &kernel_ops_sse2;
+
+/**
+ * Selects the widest instruction set supported by the CPU. The selection can be
+ * limited with the environment variable STENCIL_KERNEL_ISA (sse2, avx2 or avx512),
+ * e.g. for benchmarking. Runs before main, thus the selection is never raced.
+ */
+__attribute__((constructor)) static void stencil_kernel_init()
+{
+    __builtin_cpu_init();
+
+    const bool has_avx2 = __builtin_cpu_supports("avx2");
+    const bool has_avx512 = __builtin_cpu_supports("avx512f");
+
+    const char *requested = getenv("STENCIL_KERNEL_ISA");
+    if (requested == NULL) {
+        requested = "avx512";
+    }
+
+    if (strcmp(requested, "avx512") == 0 && has_avx512) {
+        kernel_ops = &kernel_ops_avx512;
+    } else if (strcmp(requested, "sse2") != 0 && has_avx2) {
+        kernel_ops = &kernel_ops_avx2;
+    } else {
+        kernel_ops = &kernel_ops_sse2;
+    }
+}
+
+void stencil_five_point_row(double *restrict dest, const double *above, const double *current,
+                            const double *below, size_t count)
+{
+    kernel_ops->five_point_row(dest, above, current, below, count);
+}
+
+void stencil_five_point_row_one_vector(double *above, double *restrict tmp, const double *current,
+                                       const double *below, size_t count)
+{
+    kernel_ops->five_point_row_one_vector(above, tmp, current, below, count);
+}
+
+double stencil_five_point_row_residual(double *restrict dest, const double *above, const double *current,
+                                      const double *below, size_t count, stencil_norm_t norm)
+{
+    return kernel_ops->five_point_row_residual(dest, above, current, below, count, norm);
+}
+
+double stencil_five_point_row_one_vector_residual(double *above, double *restrict tmp, const double *current,
+                                                 const double *below, size_t count, stencil_norm_t norm)
+{
+    return kernel_ops->five_point_row_one_vector_residual(above, tmp, current, below, count, norm);
+}
+
+void stencil_five_point_row_float(float *restrict dest, const float *above, const float *current,
+                                  const float *below, size_t count, stencil_precision_t precision)
+{
+    kernel_ops->five_point_row_float(dest, above, current, below, count, precision);
+}
+
+void stencil_five_point_row_one_vector_float(float *above, float *restrict tmp, const float *current,
+                                             const float *below, size_t count, stencil_precision_t precision)
+{
+    kernel_ops->five_point_row_one_vector_float(above, tmp, current, below, count, precision);
+}
+
+void stencil_five_point_sweep_float(stencil_matrix_float_t *matrix, float *buffer, stencil_precision_t precision)
+{
+    assert(matrix->boundary >= 1);
+
+    const size_t first_row = matrix->boundary;
+    const size_t end_row = matrix->rows - matrix->boundary;
+    const size_t col = matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    if (end_row <= first_row) {
+        return;
+    }
+
+    stencil_five_point_row_float(buffer + col,
+                                 stencil_matrix_float_get_ptr(matrix, first_row - 1, col),
+                                 stencil_matrix_float_get_ptr(matrix, first_row, col),
+                                 stencil_matrix_float_get_ptr(matrix, first_row + 1, col),
+                                 cols, precision);
+
+    // calculate the remaining rows (copies back the previously calculated row)
+    for (size_t row = first_row + 1; row < end_row; row++) {
+        stencil_five_point_row_one_vector_float(stencil_matrix_float_get_ptr(matrix, row - 1, col),
+                                                buffer + col,
+                                                stencil_matrix_float_get_ptr(matrix, row, col),
+                                                stencil_matrix_float_get_ptr(matrix, row + 1, col),
+                                                cols, precision);
+    }
+
+    memcpy(stencil_matrix_float_get_ptr(matrix, end_row - 1, col), buffer + col, cols * sizeof(float));
+}
+
+double stencil_five_point_row_sor(double *current, const double *above, const double *below,
+                                  size_t count, size_t first, double omega, stencil_norm_t norm)
+{
+    double residual = 0.0;
+
+    for (size_t i = first; i < count; i += 2) {
+        const double value = (above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25;
+        const double update = (1.0 - omega) * current[i] + omega * value;
+        const double diff = update - current[i];
+        current[i] = update;
+
+        if (norm == STENCIL_NORM_MAX) {
+            residual = (fabs(diff) > residual) ? fabs(diff) : residual;
+        } else {
+            residual += diff * diff;
+        }
+    }
+
+    return residual;
+}
+
+double stencil_five_point_sweep_sor(stencil_matrix_t *matrix, stencil_colour_t colour, size_t parity,
+                                    double omega, stencil_norm_t norm)
+{
+    assert(matrix->boundary >= 1);
+
+    const size_t col = matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    double residual = 0.0;
+    for (size_t row = matrix->boundary; row < matrix->rows - matrix->boundary; row++) {
+        const double row_residual = stencil_five_point_row_sor(stencil_matrix_get_ptr(matrix, row, col),
+                                                               stencil_matrix_get_ptr(matrix, row - 1, col),
+                                                               stencil_matrix_get_ptr(matrix, row + 1, col),
+                                                               cols, stencil_sor_first(matrix, row, colour, parity),
+                                                               omega, norm);
+        residual = stencil_residual_combine(norm, residual, row_residual);
+    }
+
+    return residual;
+}
+
+double stencil_sor_optimal_omega(const stencil_matrix_t *matrix)
+{
+    const double rows = matrix->rows - 2 * matrix->boundary;
+    const double cols = matrix->cols - 2 * matrix->boundary;
+
+    const double rho = (cos(M_PI / (rows + 1.0)) + cos(M_PI / (cols + 1.0))) / 2.0;
+    return 2.0 / (1.0 + sqrt(1.0 - rho * rho));
+}
+
+const char *stencil_kernel_isa()
+{
+    return kernel_ops->isa;
+}
@@ -0,0 +1,177 @@
+#ifndef __STENCIL_KERNEL_H
+#define __STENCIL_KERNEL_H
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "matrix.h"
+#include "convergence.h"
+#include "matrix_float.h"
+
+/**
+ * Calculates the five-point stencil (average of the 4 neighbours) for the
+ * field [\a row, \a col] of matrix \a matrix.
+ *
+ * @note Use the row kernels below whenever consecutive fields of a row are
+ *       calculated, this one is meant for single fields (e.g. columns).
+ *
+ * @param matrix A pointer to the matrix (must be valid)
+ * @param row Row index (must be in range [1, matrix.rows - 1[)
+ * @param col Column index (must be in range [1, matrix.cols - 1[)
+ *
+ * @return The new value of the field [\a row, \a col]
+ */
+inline double stencil_five_point_kernel(const stencil_matrix_t *const matrix, size_t row, size_t col)
+{
+    return (stencil_matrix_get(matrix, row - 1, col) +
+            stencil_matrix_get(matrix, row, col - 1) +
+            stencil_matrix_get(matrix, row, col + 1) +
+            stencil_matrix_get(matrix, row + 1, col)) * 0.25;
+}
+
+/**
+ * Calculates the five-point stencil for \a count consecutive fields of a row:
+ *
+ *   dest[i] = (above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25
+ *
+ * The implementation (SSE2, AVX2 or AVX-512) is selected once at startup
+ * depending on the instruction sets supported by the CPU. All implementations
+ * produce bit-identical results.
+ *
+ * @param dest Destination of the new values (must not overlap the source rows)
+ * @param above Pointer to the first field of the row above
+ * @param current Pointer to the first field of the current row (current[-1] and
+ *                current[count] are read as well)
+ * @param below Pointer to the first field of the row below
+ * @param count Number of fields to calculate
+ */
+void stencil_five_point_row(double *restrict dest, const double *above, const double *current,
+                            const double *below, size_t count);
+
+/**
+ * Same as stencil_five_point_row, but for the in-place "one vector" sweep:
+ * the new values are written to \a tmp, whose previous content (the new
+ * values of the row above) is copied back to \a above.
+ *
+ *   value = (above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25
+ *   above[i] = tmp[i]
+ *   tmp[i] = value
+ *
+ * @param above Pointer to the first field of the row above (gets overwritten)
+ * @param tmp Pointer to the first field of the tmp vector
+ * @param current Pointer to the first field of the current row
+ * @param below Pointer to the first field of the row below
+ * @param count Number of fields to calculate
+ */
+void stencil_five_point_row_one_vector(double *above, double *restrict tmp, const double *current,
+                                       const double *below, size_t count);
+
+/**
+ * Same as stencil_five_point_row, additionally calculates the partial residual
+ * (see stencil_row_residual) of the new values against current[0, count[.
+ *
+ * @param norm Norm of the residual
+ * @return max |dest[i] - current[i]| or sum (dest[i] - current[i])^2
+ */
+double stencil_five_point_row_residual(double *restrict dest, const double *above, const double *current,
+                                      const double *below, size_t count, stencil_norm_t norm);
+
+/**
+ * Same as stencil_five_point_row_one_vector, additionally calculates the partial
+ * residual of the new values against current[0, count[.
+ *
+ * @param norm Norm of the residual
+ * @return max |value - current[i]| or sum (value - current[i])^2
+ */
+double stencil_five_point_row_one_vector_residual(double *above, double *restrict tmp, const double *current,
+                                                 const double *below, size_t count, stencil_norm_t norm);
+
+/**
+ * Single-precision stencil_five_point_row, the sum is calculated in float
+ * (STENCIL_PRECISION_SINGLE) or in double (STENCIL_PRECISION_MIXED).
+ */
+void stencil_five_point_row_float(float *restrict dest, const float *above, const float *current,
+                                  const float *below, size_t count, stencil_precision_t precision);
+
+/**
+ * Single-precision stencil_five_point_row_one_vector (see stencil_five_point_row_float).
+ */
+void stencil_five_point_row_one_vector_float(float *above, float *restrict tmp, const float *current,
+                                             const float *below, size_t count, stencil_precision_t precision);
+
+/**
+ * Performs one in-place (one vector) iteration of the five-point stencil on the
+ * non-boundary fields of the single-precision matrix \a matrix.
+ *
+ * @param matrix A pointer to the matrix (must be valid)
+ * @param buffer Buffer of matrix.cols values
+ * @param precision Arithmetic of the kernel
+ */
+void stencil_five_point_sweep_float(stencil_matrix_float_t *matrix, float *buffer, stencil_precision_t precision);
+
+/**
+ * Colour of the field [row, col] in the red-black ordering: (row + col) % 2. The fields
+ * of one colour only depend on fields of the other colour.
+ */
+enum stencil_colour {
+    STENCIL_RED = 0,
+    STENCIL_BLACK = 1
+};
+typedef enum stencil_colour stencil_colour_t;
+
+/**
+ * Successive over-relaxation of every second field of a row (in place):
+ *
+ *   value = (above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25
+ *   current[i] = (1 - omega) * current[i] + omega * value    for i = first, first + 2, ... < count
+ *
+ * @param current Pointer to the first field of the current row (updated in place)
+ * @param above Pointer to the first field of the row above
+ * @param below Pointer to the first field of the row below
+ * @param count Number of fields of the row
+ * @param first Index of the first updated field (0 or 1)
+ * @param omega Relaxation factor (1 is Gauss-Seidel, ]1, 2[ over-relaxation)
+ * @param norm Norm of the residual
+ *
+ * @return max |update| or sum update^2 of the updated fields
+ */
+double stencil_five_point_row_sor(double *current, const double *above, const double *below,
+                                  size_t count, size_t first, double omega, stencil_norm_t norm);
+
+/**
+ * @param matrix A pointer to the matrix (must be valid)
+ * @param row Row index
+ * @param colour Colour of the updated fields
+ * @param parity (row + col) % 2 of the field [0, 0] of the matrix in the whole grid
+ *               (0 unless the matrix is a part of a larger grid)
+ *
+ * @return returns the index of the first field of colour \a colour in row \a row,
+ *         relative to the first non-boundary field (0 or 1)
+ */
+inline size_t stencil_sor_first(const stencil_matrix_t *matrix, size_t row, stencil_colour_t colour, size_t parity)
+{
+    return (row + matrix->boundary + parity + colour) % 2;
+}
+
+/**
+ * Red-black half sweep: applies stencil_five_point_row_sor to all non-boundary fields of
+ * colour \a colour of matrix \a matrix.
+ *
+ * @param parity see stencil_sor_first
+ * @return The partial residual of the half sweep
+ */
+double stencil_five_point_sweep_sor(stencil_matrix_t *matrix, stencil_colour_t colour, size_t parity,
+                                    double omega, stencil_norm_t norm);
+
+/**
+ * @return The optimal relaxation factor 2 / (1 + sqrt(1 - rho^2)) for the non-boundary fields
+ *         of matrix \a matrix, rho is the spectral radius of the Jacobi iteration
+ */
+double stencil_sor_optimal_omega(const stencil_matrix_t *matrix);
+
+/**
+ * @return The name of the instruction set used by the row kernels ("sse2", "avx2" or "avx512")
+ */
+const char *stencil_kernel_isa();
+
+#endif // __STENCIL_KERNEL_H
@@ -0,0 +1,174 @@
+/*
+ * Row kernel template, included once per instruction set by kernel.c.
+ *
+ * The including file has to define:
+ *   KERNEL_FN(name)  name mangling (e.g. name ## _avx2)
+ *   VEC              vector type holding VEC_WIDTH doubles
+ *   VEC_WIDTH        number of doubles per vector
+ *   VEC_LOAD(p)      unaligned load
+ *   VEC_STORE(p, v)  unaligned store
+ *   VEC_ADD(a, b)    addition
+ *   VEC_MUL(a, b)    multiplication
+ *   VEC_SET1(x)      broadcast
+ *   VEC_SUB(a, b)    subtraction
+ *   VEC_MAX(a, b)    maximum
+ *   VEC_ABS(a)       absolute value
+ *
+ * The additions are done in the same order as the scalar kernel
+ * (above + left + right + below), thus all variants are bit-identical.
+ *
+ * The single-precision kernels are plain loops, they are vectorized by the
+ * compiler for the instruction set of the including target.
+ */
+
+static inline VEC KERNEL_FN(five_point_vec)(const double *above, const double *current,
+                                           const double *below, size_t i, VEC quarter)
+{
+    VEC sum = VEC_ADD(VEC_LOAD(above + i), VEC_LOAD(current + i - 1));
+    sum = VEC_ADD(sum, VEC_LOAD(current + i + 1));
+    sum = VEC_ADD(sum, VEC_LOAD(below + i));
+    return VEC_MUL(sum, quarter);
+}
+
+static void KERNEL_FN(five_point_row)(double *restrict dest, const double *above, const double *current,
+                                      const double *below, size_t count)
+{
+    const VEC quarter = VEC_SET1(0.25);
+
+    size_t i = 0;
+    for (; i + VEC_WIDTH <= count; i += VEC_WIDTH) {
+        VEC_STORE(dest + i, KERNEL_FN(five_point_vec)(above, current, below, i, quarter));
+    }
+    for (; i < count; i++) {
+        dest[i] = (above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25;
+    }
+}
+
+static void KERNEL_FN(five_point_row_one_vector)(double *above, double *restrict tmp, const double *current,
+                                                 const double *below, size_t count)
+{
+    const VEC quarter = VEC_SET1(0.25);
+
+    size_t i = 0;
+    for (; i + VEC_WIDTH <= count; i += VEC_WIDTH) {
+        const VEC value = KERNEL_FN(five_point_vec)(above, current, below, i, quarter);
+        // copy back the previously calculated values before we overwrite them
+        VEC_STORE(above + i, VEC_LOAD(tmp + i));
+        VEC_STORE(tmp + i, value);
+    }
+    for (; i < count; i++) {
+        const double value = (above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25;
+        above[i] = tmp[i];
+        tmp[i] = value;
+    }
+}
+
+static inline VEC KERNEL_FN(residual_accumulate)(VEC residual, VEC value, const double *old_values,
+                                                 stencil_norm_t norm)
+{
+    const VEC diff = VEC_SUB(value, VEC_LOAD(old_values));
+    if (norm == STENCIL_NORM_MAX) {
+        return VEC_MAX(residual, VEC_ABS(diff));
+    }
+    return VEC_ADD(residual, VEC_MUL(diff, diff));
+}
+
+static inline double KERNEL_FN(residual_reduce)(VEC residual, stencil_norm_t norm)
+{
+    double lanes[VEC_WIDTH];
+    VEC_STORE(lanes, residual);
+
+    double result = 0.0;
+    for (size_t l = 0; l < VEC_WIDTH; l++) {
+        result = stencil_residual_combine(norm, result, lanes[l]);
+    }
+    return result;
+}
+
+static double KERNEL_FN(five_point_row_residual)(double *restrict dest, const double *above, const double *current,
+                                                 const double *below, size_t count, stencil_norm_t norm)
+{
+    const VEC quarter = VEC_SET1(0.25);
+    VEC residual = VEC_SET1(0.0);
+
+    size_t i = 0;
+    for (; i + VEC_WIDTH <= count; i += VEC_WIDTH) {
+        const VEC value = KERNEL_FN(five_point_vec)(above, current, below, i, quarter);
+        VEC_STORE(dest + i, value);
+        residual = KERNEL_FN(residual_accumulate)(residual, value, current + i, norm);
+    }
+    const size_t tail = i;
+    for (; i < count; i++) {
+        dest[i] = (above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25;
+    }
+
+    return stencil_residual_combine(norm, KERNEL_FN(residual_reduce)(residual, norm),
+                                    stencil_row_residual(norm, dest + tail, current + tail, count - tail));
+}
+
+static double KERNEL_FN(five_point_row_one_vector_residual)(double *above, double *restrict tmp, const double *current,
+                                                            const double *below, size_t count, stencil_norm_t norm)
+{
+    const VEC quarter = VEC_SET1(0.25);
+    VEC residual = VEC_SET1(0.0);
+
+    size_t i = 0;
+    for (; i + VEC_WIDTH <= count; i += VEC_WIDTH) {
+        const VEC value = KERNEL_FN(five_point_vec)(above, current, below, i, quarter);
+        VEC_STORE(above + i, VEC_LOAD(tmp + i));
+        VEC_STORE(tmp + i, value);
+        residual = KERNEL_FN(residual_accumulate)(residual, value, current + i, norm);
+    }
+    const size_t tail = i;
+    for (; i < count; i++) {
+        const double value = (above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25;
+        above[i] = tmp[i];
+        tmp[i] = value;
+    }
+
+    return stencil_residual_combine(norm, KERNEL_FN(residual_reduce)(residual, norm),
+                                    stencil_row_residual(norm, tmp + tail, current + tail, count - tail));
+}
+
+static void KERNEL_FN(five_point_row_float)(float *restrict dest, const float *above, const float *current,
+                                            const float *below, size_t count, stencil_precision_t precision)
+{
+    if (precision == STENCIL_PRECISION_SINGLE) {
+        for (size_t i = 0; i < count; i++) {
+            dest[i] = (above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25f;
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            dest[i] = (float)(((double)above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25);
+        }
+    }
+}
+
+static void KERNEL_FN(five_point_row_one_vector_float)(float *above, float *restrict tmp, const float *current,
+                                                       const float *below, size_t count,
+                                                       stencil_precision_t precision)
+{
+    if (precision == STENCIL_PRECISION_SINGLE) {
+        for (size_t i = 0; i < count; i++) {
+            const float value = (above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25f;
+            above[i] = tmp[i];
+            tmp[i] = value;
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            const float value = (float)(((double)above[i] + current[i - 1] + current[i + 1] + below[i]) * 0.25);
+            above[i] = tmp[i];
+            tmp[i] = value;
+        }
+    }
+}
+
+static const struct stencil_kernel_ops KERNEL_FN(kernel_ops) = {
+    .isa = KERNEL_ISA,
+    .five_point_row = KERNEL_FN(five_point_row),
+    .five_point_row_one_vector = KERNEL_FN(five_point_row_one_vector),
+    .five_point_row_residual = KERNEL_FN(five_point_row_residual),
+    .five_point_row_one_vector_residual = KERNEL_FN(five_point_row_one_vector_residual),
+    .five_point_row_float = KERNEL_FN(five_point_row_float),
+    .five_point_row_one_vector_float = KERNEL_FN(five_point_row_one_vector_float),
+};
@@ -4,12 +4,6 @@
 #include <math.h>
 #include <float.h>
 
-//#define STENCIL_USE_HUGE_PAGES
-
-#ifdef STENCIL_USE_HUGE_PAGES
-#include <sys/mman.h>
-#endif
-
 #include "matrix.h"
 
 double *stencil_matrix_get_ptr(const stencil_matrix_t *const matrix, size_t row, size_t col)
@@ -18,29 +12,53 @@ double *stencil_matrix_get_ptr(const stencil_matrix_t *const matrix, size_t row,
     assert(0 <= row && row < matrix->rows);
     assert(0 <= col && col < matrix->cols);
 
-    return matrix->values + row * matrix->cols + col;
+    return matrix->values + row * matrix->stride + col;
+}
+
+size_t stencil_matrix_stride(size_t cols, size_t padding, size_t element_size)
+{
+    const size_t alignment = STENCIL_MATRIX_ALIGNMENT / element_size; // in fields
+
+    size_t stride = (cols + alignment - 1) / alignment * alignment;
+    if (padding == STENCIL_MATRIX_PADDING_AUTO) {
+        if ((stride * element_size) % STENCIL_MATRIX_ALIASING_SIZE == 0) {
+            stride += alignment;
+        }
+    } else {
+        stride += (padding + alignment - 1) / alignment * alignment;
+    }
+
+    return stride;
+}
+
+size_t stencil_matrix_alignment_offset(size_t boundary, size_t element_size)
+{
+    const size_t alignment = STENCIL_MATRIX_ALIGNMENT / element_size; // in fields
+
+    return (alignment - boundary % alignment) % alignment;
 }
 
 stencil_matrix_t *stencil_matrix_new(size_t rows, size_t cols, size_t boundary)
+{
+    return stencil_matrix_new_padded(rows, cols, boundary, STENCIL_MATRIX_PADDING);
+}
+
+stencil_matrix_t *stencil_matrix_new_padded(size_t rows, size_t cols, size_t boundary, size_t padding)
 {
     assert(boundary >= 0);
     assert(rows >= 2 * boundary);
     assert(cols >= 2 * boundary);
 
-    const size_t len = rows * cols;
+    const size_t stride = stencil_matrix_stride(cols, padding, sizeof(double));
+    const size_t offset = stencil_matrix_alignment_offset(boundary, sizeof(double));
+    const size_t len = offset + rows * stride;
 
-#ifdef STENCIL_USE_HUGE_PAGES
-    double *values = (double *)mmap(0, len * sizeof(double), PROT_READ | PROT_WRITE,
-                                    MAP_ANONYMOUS | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
-    if (values == MAP_FAILED) {
+    stencil_pages_t pages;
+    double *memory = (double *)stencil_pages_alloc(len * sizeof(double), &pages);
+    if (!memory) {
         goto exit_values;
     }
-#else
-    double *values = (double *)malloc(len * sizeof(double));
-    if (!values) {
-        goto exit_values;
-    }
-#endif
+    stencil_numa_apply(memory, len * sizeof(double)); // falls back to first touch
 
     stencil_matrix_t *matrix = (stencil_matrix_t *)malloc(sizeof(stencil_matrix_t));
     if (!matrix) {
@@ -48,17 +66,15 @@ stencil_matrix_t *stencil_matrix_new(size_t rows, size_t cols, size_t boundary)
     }
     matrix->rows = rows;
     matrix->cols = cols;
+    matrix->stride = stride;
     matrix->boundary = boundary;
-    matrix->values = values;
+    matrix->values = memory + offset;
+    matrix->pages = pages;
 
     return matrix;
 
 exit_matrix:
-#ifdef STENCIL_USE_HUGE_PAGES
-    munmap(values, len * sizeof(double));
-#else
-    free(values);
-#endif
+    stencil_pages_free(memory, len * sizeof(double), pages);
 exit_values:
     return NULL;
 }
@@ -69,11 +85,8 @@ void stencil_matrix_free(stencil_matrix_t *matrix)
         return;
     }
 
-#ifdef STENCIL_USE_HUGE_PAGES
-    munmap(matrix->values, matrix->rows * matrix->cols * sizeof(double));
-#else
-    free(matrix->values);
-#endif
+    const size_t offset = stencil_matrix_alignment_offset(matrix->boundary, sizeof(double));
+    stencil_pages_free(matrix->values - offset, (offset + matrix->rows * matrix->stride) * sizeof(double), matrix->pages);
     free(matrix);
 }
 
@@ -118,7 +131,7 @@ void stencil_matrix_set_column(const stencil_matrix_t *matrix, size_t col, const
     double *dest_it = stencil_matrix_get_ptr(matrix, matrix->boundary, col);
     while (src_it != src_end) {
         *dest_it = *src_it;
-        dest_it += matrix->cols;
+        dest_it += matrix->stride;
         ++src_it;
     }
 }
@@ -138,7 +151,7 @@ stencil_vector_t *stencil_matrix_get_column(const stencil_matrix_t *matrix, size
     double *dest_it = stencil_vector_get_ptr(vector, 0);
     while (src_it != src_end) {
         *dest_it = *src_it;
-        src_it += matrix->cols;
+        src_it += matrix->stride;
         ++dest_it;
     }
 
@@ -177,13 +190,40 @@ stencil_matrix_t *stencil_matrix_get_submatrix(const stencil_matrix_t *const mat
         return NULL;
     }
 
-    for (size_t i = row, j = 0; j < rows; i++, j++) {
+    stencil_matrix_copy_submatrix(matrix, row, col, submatrix);
+
+    return submatrix;
+}
+
+void stencil_matrix_copy_submatrix(const stencil_matrix_t *const matrix, size_t row, size_t col,
+                                   const stencil_matrix_t *submatrix)
+{
+    assert(matrix);
+    assert(submatrix);
+    assert(submatrix->rows <= (matrix->rows - row));
+    assert(submatrix->cols <= (matrix->cols - col));
+
+    for (size_t i = row, j = 0; j < submatrix->rows; i++, j++) {
         double *src = stencil_matrix_get_ptr(matrix, i, col);
         double *dest = stencil_matrix_get_ptr(submatrix, j, 0);
-        memcpy(dest, src, cols * sizeof(double));
+        memcpy(dest, src, submatrix->cols * sizeof(double));
     }
+}
 
-    return submatrix;
+void stencil_matrix_copy_values(const stencil_matrix_t *dest, const stencil_matrix_t *const src)
+{
+    assert(dest);
+    assert(src);
+    assert(dest->rows == src->rows && dest->cols == src->cols);
+
+    if (dest->stride == src->stride) {
+        memcpy(dest->values, src->values, src->rows * src->stride * sizeof(double));
+        return;
+    }
+
+    for (size_t row = 0; row < src->rows; row++) {
+        memcpy(stencil_matrix_get_ptr(dest, row, 0), stencil_matrix_get_ptr(src, row, 0), src->cols * sizeof(double));
+    }
 }
 
 bool stencil_matrix_equals(const stencil_matrix_t *const matrix1, const stencil_matrix_t *const matrix2)
@@ -195,19 +235,26 @@ bool stencil_matrix_equals(const stencil_matrix_t *const matrix1, const stencil_
         return false;
     }
 
-    double *values1 = matrix1->values;
-    double *values2 = matrix2->values;
-
-    const size_t len = matrix1->rows * matrix1->cols;
-    for (size_t i = 0; i < len; i++) {
-        if (fabs(values1[i] - values2[i]) >= DBL_EPSILON) {
-            return false;
+    for (size_t row = 0; row < matrix1->rows; row++) {
+        const double *values1 = stencil_matrix_get_ptr(matrix1, row, 0);
+        const double *values2 = stencil_matrix_get_ptr(matrix2, row, 0);
+        for (size_t col = 0; col < matrix1->cols; col++) {
+            if (fabs(values1[col] - values2[col]) >= DBL_EPSILON) {
+                return false;
+            }
         }
     }
 
     return true;
 }
 
+void stencil_matrix_numa_report(const stencil_matrix_t *const matrix, FILE *stream)
+{
+    assert(matrix);
+
+    stencil_numa_report(matrix->values, matrix->rows * matrix->stride * sizeof(double), stream);
+}
+
 void stencil_matrix_print(const stencil_matrix_t *const matrix)
 {
     assert(matrix);
@@ -3,19 +3,45 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 #include "vector.h"
+#include "pages.h"
+#include "numa.h"
+
+/**
+ * The first non-boundary field of every row is aligned to STENCIL_MATRIX_ALIGNMENT bytes,
+ * thus the rows are padded to a multiple of the alignment.
+ */
+#define STENCIL_MATRIX_ALIGNMENT 64
+
+/**
+ * Padding value which adds one additional cache line to rows whose size is a multiple of
+ * STENCIL_MATRIX_ALIASING_SIZE bytes (power-of-two widths), otherwise neighbouring rows map
+ * to the same cache sets and loads alias with stores (4K aliasing).
+ */
+#define STENCIL_MATRIX_PADDING_AUTO ((size_t)-1)
+#define STENCIL_MATRIX_ALIASING_SIZE 1024
+
+//#define STENCIL_MATRIX_PADDING 0
+
+#ifndef STENCIL_MATRIX_PADDING
+#define STENCIL_MATRIX_PADDING STENCIL_MATRIX_PADDING_AUTO
+#endif
 
 struct stencil_matrix {
     size_t rows;
     size_t cols;
+    size_t stride; // distance between two rows in values (>= cols)
     size_t boundary;
     double *values;
+    stencil_pages_t pages; // page policy of the values which took effect
 };
 typedef struct stencil_matrix stencil_matrix_t;
 
 /**
- * Creates a new matrix of size \a rows rows by \a cols columns.
+ * Creates a new matrix of size \a rows rows by \a cols columns with the default
+ * padding (STENCIL_MATRIX_PADDING).
  *
  * @param rows Number of rows with boundary rows
  * @param cols Number of columns with boundary cols
@@ -25,11 +51,42 @@ typedef struct stencil_matrix stencil_matrix_t;
  */
 stencil_matrix_t *stencil_matrix_new(size_t rows, size_t cols, size_t boundary);
 
+/**
+ * Creates a new matrix of size \a rows rows by \a cols columns.
+ *
+ * @param rows Number of rows with boundary rows
+ * @param cols Number of columns with boundary cols
+ * @param boundary The size of the boundary (rows and cols)
+ * @param padding Number of additional fields per row (rounded up to the alignment)
+ *                or STENCIL_MATRIX_PADDING_AUTO
+ *
+ * @return A pointer to a matrix, NULL on failure.
+ */
+stencil_matrix_t *stencil_matrix_new_padded(size_t rows, size_t cols, size_t boundary, size_t padding);
+
 /**
  * Frees the memory of a matrix \a matrix.
  */
 void stencil_matrix_free(stencil_matrix_t *matrix);
 
+/**
+ * @param cols Number of columns with boundary cols
+ * @param padding Number of additional fields per row or STENCIL_MATRIX_PADDING_AUTO
+ * @param element_size Size of a field in bytes
+ *
+ * @return returns the row stride (in fields) of an aligned and padded matrix
+ */
+size_t stencil_matrix_stride(size_t cols, size_t padding, size_t element_size);
+
+/**
+ * @param boundary The size of the boundary
+ * @param element_size Size of a field in bytes
+ *
+ * @return returns the number of fields in front of the values which align the first
+ *         non-boundary field of a row
+ */
+size_t stencil_matrix_alignment_offset(size_t boundary, size_t element_size);
+
 /**
  * Returns the value at position [\a row, \a col] from matrix \a matrix.
  *
@@ -45,7 +102,7 @@ inline double stencil_matrix_get(const stencil_matrix_t *const matrix, size_t ro
     assert(0 <= row && row < matrix->rows);
     assert(0 <= col && col < matrix->cols);
 
-    return matrix->values[row * matrix->cols + col];
+    return matrix->values[row * matrix->stride + col];
 }
 
 /**
@@ -64,7 +121,7 @@ inline void stencil_matrix_set(const stencil_matrix_t *matrix, size_t row, size_
     assert(matrix->boundary <= row && row < (matrix->rows - matrix->boundary));
     assert(matrix->boundary <= col && col < (matrix->cols - matrix->boundary));
 
-    matrix->values[row * matrix->cols + col] = value;
+    matrix->values[row * matrix->stride + col] = value;
 }
 
 /**
@@ -121,6 +178,24 @@ void stencil_matrix_set_submatrix(const stencil_matrix_t *matrix, size_t row, si
 
 stencil_matrix_t *stencil_matrix_get_submatrix(const stencil_matrix_t *const matrix, size_t row, size_t col, size_t rows, size_t cols, size_t boundary);
 
+/**
+ * Copies the values (with boundary) of the sub-matrix of matrix \a matrix which starts at
+ * row \a row and column \a col into the existing sub-matrix \a submatrix (same as
+ * stencil_matrix_get_submatrix without the allocation).
+ *
+ * @param submatrix A pointer to the sub-matrix (its rows and cols must be in the matrix)
+ */
+void stencil_matrix_copy_submatrix(const stencil_matrix_t *const matrix, size_t row, size_t col,
+                                   const stencil_matrix_t *submatrix);
+
+/**
+ * Copies all values (with boundary) of matrix \a src to matrix \a dest.
+ *
+ * @param dest A pointer to the destination matrix (must be valid)
+ * @param src A pointer to the source matrix (must be valid and of the same size, the stride may differ)
+ */
+void stencil_matrix_copy_values(const stencil_matrix_t *dest, const stencil_matrix_t *const src);
+
 /**
  * Tests the two given matrices \a matrix1 and \a matrix2 for equality.
  *
@@ -131,6 +206,13 @@ stencil_matrix_t *stencil_matrix_get_submatrix(const stencil_matrix_t *const mat
  */
 bool stencil_matrix_equals(const stencil_matrix_t *const matrix1, const stencil_matrix_t *const matrix2);
 
+/**
+ * Prints the NUMA placement of the values of matrix \a matrix to \a stream (see stencil_numa_report).
+ *
+ * @param matrix A pointer to the matrix (must be valid)
+ */
+void stencil_matrix_numa_report(const stencil_matrix_t *const matrix, FILE *stream);
+
 /**
  * Prints the values of the matrix \a matrix to stdout (e.g. for debugging).
  *
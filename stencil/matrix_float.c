@@ -0,0 +1,118 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "matrix_float.h"
+
+float *stencil_matrix_float_get_ptr(const stencil_matrix_float_t *const matrix, size_t row, size_t col)
+{
+    assert(matrix);
+    assert(0 <= row && row < matrix->rows);
+    assert(0 <= col && col < matrix->cols);
+
+    return matrix->values + row * matrix->stride + col;
+}
+
+stencil_matrix_float_t *stencil_matrix_float_new(size_t rows, size_t cols, size_t boundary)
+{
+    assert(rows >= 2 * boundary);
+    assert(cols >= 2 * boundary);
+
+    const size_t stride = stencil_matrix_stride(cols, STENCIL_MATRIX_PADDING, sizeof(float));
+    const size_t offset = stencil_matrix_alignment_offset(boundary, sizeof(float));
+
+    const size_t len = offset + rows * stride;
+
+    stencil_pages_t pages;
+    float *memory = (float *)stencil_pages_alloc(len * sizeof(float), &pages);
+    if (!memory) {
+        goto exit_values;
+    }
+    stencil_numa_apply(memory, len * sizeof(float)); // falls back to first touch
+
+    stencil_matrix_float_t *matrix = (stencil_matrix_float_t *)malloc(sizeof(stencil_matrix_float_t));
+    if (!matrix) {
+        goto exit_matrix;
+    }
+    matrix->rows = rows;
+    matrix->cols = cols;
+    matrix->stride = stride;
+    matrix->boundary = boundary;
+    matrix->values = memory + offset;
+    matrix->pages = pages;
+
+    return matrix;
+
+exit_matrix:
+    stencil_pages_free(memory, len * sizeof(float), pages);
+exit_values:
+    return NULL;
+}
+
+void stencil_matrix_float_free(stencil_matrix_float_t *matrix)
+{
+    if (!matrix) {
+        return;
+    }
+
+    const size_t offset = stencil_matrix_alignment_offset(matrix->boundary, sizeof(float));
+    stencil_pages_free(matrix->values - offset, (offset + matrix->rows * matrix->stride) * sizeof(float), matrix->pages);
+    free(matrix);
+}
+
+void stencil_matrix_float_copy_values(const stencil_matrix_float_t *dest, const stencil_matrix_float_t *const src)
+{
+    assert(dest);
+    assert(src);
+    assert(dest->rows == src->rows && dest->cols == src->cols && dest->stride == src->stride);
+
+    memcpy(dest->values, src->values, src->rows * src->stride * sizeof(float));
+}
+
+stencil_matrix_float_t *stencil_matrix_float_copy(const stencil_matrix_float_t *const matrix)
+{
+    assert(matrix);
+
+    stencil_matrix_float_t *copy = stencil_matrix_float_new(matrix->rows, matrix->cols, matrix->boundary);
+    if (!copy) {
+        return NULL;
+    }
+
+    stencil_matrix_float_copy_values(copy, matrix);
+
+    return copy;
+}
+
+stencil_matrix_float_t *stencil_matrix_float_from_matrix(const stencil_matrix_t *const matrix)
+{
+    assert(matrix);
+
+    stencil_matrix_float_t *matrix_float = stencil_matrix_float_new(matrix->rows, matrix->cols, matrix->boundary);
+    if (!matrix_float) {
+        return NULL;
+    }
+
+    for (size_t row = 0; row < matrix->rows; row++) {
+        const double *src = stencil_matrix_get_ptr(matrix, row, 0);
+        float *dest = stencil_matrix_float_get_ptr(matrix_float, row, 0);
+        for (size_t col = 0; col < matrix->cols; col++) {
+            dest[col] = (float)src[col];
+        }
+    }
+
+    return matrix_float;
+}
+
+void stencil_matrix_float_to_matrix(const stencil_matrix_float_t *const src, stencil_matrix_t *dest)
+{
+    assert(src);
+    assert(dest);
+    assert(src->rows == dest->rows && src->cols == dest->cols);
+
+    for (size_t row = 0; row < src->rows; row++) {
+        const float *src_row = stencil_matrix_float_get_ptr(src, row, 0);
+        double *dest_row = stencil_matrix_get_ptr(dest, row, 0);
+        for (size_t col = 0; col < src->cols; col++) {
+            dest_row[col] = src_row[col];
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef __STENCIL_MATRIX_FLOAT_H
+#define __STENCIL_MATRIX_FLOAT_H
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include "matrix.h"
+
+/**
+ * Arithmetic used for matrices with single-precision values.
+ */
+enum stencil_precision {
+    STENCIL_PRECISION_SINGLE, // calculate in float
+    STENCIL_PRECISION_MIXED   // calculate in double, store float
+};
+typedef enum stencil_precision stencil_precision_t;
+
+/**
+ * Matrix with single-precision values (half the memory and bandwidth of stencil_matrix_t).
+ */
+struct stencil_matrix_float {
+    size_t rows;
+    size_t cols;
+    size_t stride; // distance between two rows in values (>= cols, aligned like stencil_matrix_t)
+    size_t boundary;
+    float *values;
+    stencil_pages_t pages; // page policy of the values which took effect
+};
+typedef struct stencil_matrix_float stencil_matrix_float_t;
+
+/**
+ * Creates a new matrix of size \a rows rows by \a cols columns.
+ *
+ * @param rows Number of rows with boundary rows
+ * @param cols Number of columns with boundary cols
+ * @param boundary The size of the boundary (rows and cols)
+ *
+ * @return A pointer to a matrix, NULL on failure.
+ */
+stencil_matrix_float_t *stencil_matrix_float_new(size_t rows, size_t cols, size_t boundary);
+
+/**
+ * Frees the memory of a matrix \a matrix.
+ */
+void stencil_matrix_float_free(stencil_matrix_float_t *matrix);
+
+/**
+ * @param matrix matrix
+ * @param row row of the field
+ * @param col column of the filed
+ *
+ * @return returns a pointer to the matrix field specified with \a row and \a col
+ */
+float *stencil_matrix_float_get_ptr(const stencil_matrix_float_t *const matrix, size_t row, size_t col);
+
+/**
+ * @return A copy of matrix \a matrix (with boundary), NULL on failure.
+ */
+stencil_matrix_float_t *stencil_matrix_float_copy(const stencil_matrix_float_t *const matrix);
+
+/**
+ * Copies all values (with boundary) of matrix \a src to matrix \a dest, both matrices
+ * must have the same size.
+ */
+void stencil_matrix_float_copy_values(const stencil_matrix_float_t *dest, const stencil_matrix_float_t *const src);
+
+/**
+ * Converts the matrix \a matrix (with boundary) to single-precision.
+ *
+ * @return A pointer to a matrix, NULL on failure.
+ */
+stencil_matrix_float_t *stencil_matrix_float_from_matrix(const stencil_matrix_t *const matrix);
+
+/**
+ * Copies the values of matrix \a src (with boundary) to matrix \a dest, both matrices
+ * must have the same size.
+ */
+void stencil_matrix_float_to_matrix(const stencil_matrix_float_t *const src, stencil_matrix_t *dest);
+
+#endif // __STENCIL_MATRIX_FLOAT_H
@@ -0,0 +1,174 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "numa.h"
+
+// mbind modes (numaif.h), the system calls are used directly to avoid a dependency on libnuma
+#define NUMA_MPOL_BIND 2
+#define NUMA_MPOL_INTERLEAVE 3
+
+#define NUMA_MAX_NODES 64
+#define NUMA_REPORT_CHUNK 1024
+
+static stencil_numa_t numa_policy = STENCIL_NUMA_FIRST_TOUCH;
+static int numa_node = 0;
+static pthread_once_t numa_policy_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Reads the initial policy from STENCIL_NUMA_ENV (once, the getter is called by the
+ * threads of the parallel backends as well).
+ */
+static void init_numa_policy(void)
+{
+    const char *env = getenv(STENCIL_NUMA_ENV);
+    if (env != NULL) {
+        if (strcmp(env, "first-touch") == 0) {
+            numa_policy = STENCIL_NUMA_FIRST_TOUCH;
+        } else if (strcmp(env, "interleave") == 0) {
+            numa_policy = STENCIL_NUMA_INTERLEAVE;
+        } else if (strncmp(env, "bind", 4) == 0) {
+            numa_policy = STENCIL_NUMA_BIND;
+            numa_node = (env[4] == ':') ? strtol(env + 5, NULL, 10) : 0;
+        }
+    }
+}
+
+void stencil_numa_set_policy(stencil_numa_t numa, int node)
+{
+    pthread_once(&numa_policy_once, init_numa_policy);
+    numa_policy = numa;
+    numa_node = node;
+}
+
+stencil_numa_t stencil_numa_get_policy(int *node)
+{
+    pthread_once(&numa_policy_once, init_numa_policy);
+
+    if (node != NULL) {
+        *node = numa_node;
+    }
+    return numa_policy;
+}
+
+/**
+ * Reads the online nodes (e.g. "0-1,3") into the node mask \a mask.
+ */
+static bool online_nodes(unsigned long *mask)
+{
+    FILE *file = fopen("/sys/devices/system/node/online", "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    *mask = 0;
+    int first;
+    while (fscanf(file, "%d", &first) == 1) {
+        int last = first;
+        int separator = fgetc(file);
+        if (separator == '-') {
+            if (fscanf(file, "%d", &last) != 1) {
+                break;
+            }
+            separator = fgetc(file);
+        }
+        for (int node = first; node <= last && node < NUMA_MAX_NODES; node++) {
+            *mask |= 1UL << node;
+        }
+        if (separator != ',') {
+            break;
+        }
+    }
+
+    fclose(file);
+    return *mask != 0;
+}
+
+bool stencil_numa_apply(void *memory, size_t size)
+{
+    int node;
+    const stencil_numa_t numa = stencil_numa_get_policy(&node);
+
+    if (numa == STENCIL_NUMA_FIRST_TOUCH || memory == NULL || size == 0) {
+        return true;
+    }
+
+#ifdef SYS_mbind
+    unsigned long mask = 0;
+    int mode;
+    if (numa == STENCIL_NUMA_INTERLEAVE) {
+        if (!online_nodes(&mask)) {
+            return false;
+        }
+        mode = NUMA_MPOL_INTERLEAVE;
+    } else {
+        if (node < 0 || node >= NUMA_MAX_NODES) {
+            return false;
+        }
+        mask = 1UL << node;
+        mode = NUMA_MPOL_BIND;
+    }
+
+    // mbind needs page aligned addresses
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    const size_t start = (size_t)memory / page_size * page_size;
+    const size_t end = ((size_t)memory + size + page_size - 1) / page_size * page_size;
+
+    return syscall(SYS_mbind, start, end - start, mode, &mask, NUMA_MAX_NODES + 1, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+void stencil_numa_report(const void *memory, size_t size, FILE *stream)
+{
+#ifdef SYS_move_pages
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    const size_t start = (size_t)memory / page_size * page_size;
+    const size_t pages = ((size_t)memory + size - start + page_size - 1) / page_size;
+
+    size_t counts[NUMA_MAX_NODES] = { 0 };
+    size_t not_present = 0;
+
+    void *addresses[NUMA_REPORT_CHUNK];
+    int status[NUMA_REPORT_CHUNK];
+    for (size_t first = 0; first < pages; first += NUMA_REPORT_CHUNK) {
+        const size_t count = (pages - first < NUMA_REPORT_CHUNK) ? (pages - first) : NUMA_REPORT_CHUNK;
+        for (size_t i = 0; i < count; i++) {
+            addresses[i] = (void *)(start + (first + i) * page_size);
+        }
+
+        // without target nodes move_pages only queries the node of every page
+        if (syscall(SYS_move_pages, 0, count, addresses, NULL, status, 0) != 0) {
+            fprintf(stream, "numa: unknown\n");
+            return;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            if (status[i] >= 0 && status[i] < NUMA_MAX_NODES) {
+                counts[status[i]]++;
+            } else {
+                not_present++;
+            }
+        }
+    }
+
+    fprintf(stream, "numa:");
+    for (int node = 0; node < NUMA_MAX_NODES; node++) {
+        if (counts[node] > 0) {
+            fprintf(stream, " node%d=%.1f%%", node, 100.0 * counts[node] / pages);
+        }
+    }
+    if (not_present > 0) {
+        fprintf(stream, " not-present=%.1f%%", 100.0 * not_present / pages);
+    }
+    fprintf(stream, " (%zu pages)\n", pages);
+#else
+    (void)memory;
+    (void)size;
+    fprintf(stream, "numa: unknown\n");
+#endif
+}
@@ -0,0 +1,55 @@
+#ifndef __STENCIL_NUMA_H
+#define __STENCIL_NUMA_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * NUMA placement of the matrix values.
+ */
+enum stencil_numa {
+    STENCIL_NUMA_FIRST_TOUCH, // a page is placed on the node of the thread which touches it first
+    STENCIL_NUMA_INTERLEAVE,  // the pages are interleaved over all nodes
+    STENCIL_NUMA_BIND         // all pages are placed on one node
+};
+typedef enum stencil_numa stencil_numa_t;
+
+/**
+ * Name of the environment variable which sets the initial NUMA policy
+ * ("first-touch", "interleave", "bind" or "bind:<node>").
+ */
+#define STENCIL_NUMA_ENV "STENCIL_NUMA"
+
+/**
+ * Sets the NUMA policy of all following allocations (not while other threads allocate).
+ *
+ * @param numa NUMA policy
+ * @param node Node of STENCIL_NUMA_BIND (ignored otherwise)
+ */
+void stencil_numa_set_policy(stencil_numa_t numa, int node);
+
+/**
+ * @param node Returns the node of STENCIL_NUMA_BIND (may be NULL)
+ *
+ * @return returns the NUMA policy of all following allocations, initially the
+ *         policy given by STENCIL_NUMA_ENV or STENCIL_NUMA_FIRST_TOUCH
+ */
+stencil_numa_t stencil_numa_get_policy(int *node);
+
+/**
+ * Applies the current NUMA policy to the (untouched) memory \a memory. Nothing has to
+ * be done for STENCIL_NUMA_FIRST_TOUCH, the parallel backends touch the values in the
+ * partitioning of their calculation (see first_touch_matrix of the OpenMP and Cilk backends).
+ *
+ * @return True if the policy took effect, false otherwise (the pages are placed by first touch).
+ */
+bool stencil_numa_apply(void *memory, size_t size);
+
+/**
+ * Prints the share of the pages of \a memory on every NUMA node to \a stream
+ * (e.g. "numa: node0=50.0% node1=50.0% (1024 pages)").
+ */
+void stencil_numa_report(const void *memory, size_t size, FILE *stream);
+
+#endif // __STENCIL_NUMA_H
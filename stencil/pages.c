@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+
+#include "pages.h"
+
+#define STENCIL_PAGES_ALIGNMENT 64
+
+static stencil_pages_t page_policy = STENCIL_PAGES_HUGE;
+static pthread_once_t page_policy_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Reads the initial policy from STENCIL_PAGES_ENV, run once by the first call of the
+ * getter or setter (from any thread).
+ */
+static void init_page_policy(void)
+{
+    const char *env = getenv(STENCIL_PAGES_ENV);
+    if (env != NULL) {
+        if (strcmp(env, "normal") == 0) {
+            page_policy = STENCIL_PAGES_NORMAL;
+        } else if (strcmp(env, "transparent") == 0) {
+            page_policy = STENCIL_PAGES_TRANSPARENT;
+        } else if (strcmp(env, "huge") == 0) {
+            page_policy = STENCIL_PAGES_HUGE;
+        }
+    }
+}
+
+void stencil_pages_set_policy(stencil_pages_t pages)
+{
+    pthread_once(&page_policy_once, init_page_policy);
+    page_policy = pages;
+}
+
+stencil_pages_t stencil_pages_get_policy(void)
+{
+    pthread_once(&page_policy_once, init_page_policy);
+    return page_policy;
+}
+
+const char *stencil_pages_name(stencil_pages_t pages)
+{
+    switch (pages) {
+    case STENCIL_PAGES_MAPPED:
+        return "mapped";
+    case STENCIL_PAGES_HUGE:
+        return "huge";
+    case STENCIL_PAGES_TRANSPARENT:
+        return "transparent";
+    default:
+        return "normal";
+    }
+}
+
+static size_t huge_page_size(size_t size)
+{
+    return (size + STENCIL_HUGE_PAGE_SIZE - 1) / STENCIL_HUGE_PAGE_SIZE * STENCIL_HUGE_PAGE_SIZE;
+}
+
+void *stencil_pages_alloc(size_t size, stencil_pages_t *pages)
+{
+    const stencil_pages_t policy = (size >= STENCIL_HUGE_PAGE_SIZE) ? stencil_pages_get_policy() : STENCIL_PAGES_NORMAL;
+
+    if (policy >= STENCIL_PAGES_HUGE) {
+        void *memory = mmap(NULL, huge_page_size(size), PROT_READ | PROT_WRITE,
+                            MAP_ANONYMOUS | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            *pages = STENCIL_PAGES_HUGE;
+            return memory;
+        }
+    }
+
+    void *memory;
+
+#ifdef MADV_HUGEPAGE
+    if (policy >= STENCIL_PAGES_TRANSPARENT) {
+        // the huge pages are only used for the 2 MiB aligned parts of the memory
+        if (posix_memalign(&memory, STENCIL_HUGE_PAGE_SIZE, huge_page_size(size)) != 0) {
+            return NULL;
+        }
+        if (madvise(memory, huge_page_size(size), MADV_HUGEPAGE) == 0) {
+            *pages = STENCIL_PAGES_TRANSPARENT;
+        } else {
+            *pages = STENCIL_PAGES_NORMAL; // e.g. transparent huge pages are disabled
+        }
+        return memory;
+    }
+#endif
+
+    if (posix_memalign(&memory, STENCIL_PAGES_ALIGNMENT, size) != 0) {
+        return NULL;
+    }
+    *pages = STENCIL_PAGES_NORMAL;
+    return memory;
+}
+
+void stencil_pages_free(void *memory, size_t size, stencil_pages_t pages)
+{
+    if (!memory) {
+        return;
+    }
+
+    if (pages == STENCIL_PAGES_HUGE) {
+        munmap(memory, huge_page_size(size));
+    } else if (pages == STENCIL_PAGES_MAPPED) {
+        const uintptr_t page_mask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+        void *mapping = (void *)((uintptr_t)memory & ~page_mask);
+        munmap(mapping, size + ((char *)memory - (char *)mapping));
+    } else {
+        free(memory);
+    }
+}
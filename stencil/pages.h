@@ -0,0 +1,64 @@
+#ifndef __STENCIL_PAGES_H
+#define __STENCIL_PAGES_H
+
+#include <stddef.h>
+
+/**
+ * Page policy of the matrix values, ordered from the smallest to the largest pages.
+ */
+enum stencil_pages {
+    STENCIL_PAGES_NORMAL,      // normal (4 KiB) pages
+    STENCIL_PAGES_TRANSPARENT, // transparent huge pages (madvise(MADV_HUGEPAGE))
+    STENCIL_PAGES_HUGE,        // explicit huge pages (MAP_HUGETLB, needs reserved hugetlbfs pages)
+    STENCIL_PAGES_MAPPED       // private mapping of a grid file (see binary.h), not an allocation policy
+};
+typedef enum stencil_pages stencil_pages_t;
+
+#define STENCIL_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+/**
+ * Name of the environment variable which sets the initial page policy
+ * ("normal", "transparent" or "huge").
+ */
+#define STENCIL_PAGES_ENV "STENCIL_PAGES"
+
+/**
+ * Sets the page policy of all following allocations (not while other threads allocate).
+ * An allocation falls back to the next smaller pages if a policy is not available
+ * (huge -> transparent -> normal).
+ */
+void stencil_pages_set_policy(stencil_pages_t pages);
+
+/**
+ * @return returns the page policy of all following allocations, initially the
+ *         policy given by STENCIL_PAGES_ENV or STENCIL_PAGES_HUGE
+ */
+stencil_pages_t stencil_pages_get_policy(void);
+
+/**
+ * @return returns the name of the page policy \a pages
+ */
+const char *stencil_pages_name(stencil_pages_t pages);
+
+/**
+ * Allocates \a size bytes (aligned to at least 64 bytes) with the current page policy.
+ * Allocations smaller than a huge page always use normal pages.
+ *
+ * @param size Number of bytes
+ * @param pages Returns the page policy which took effect (must be valid)
+ *
+ * @return A pointer to the memory, NULL on failure.
+ */
+void *stencil_pages_alloc(size_t size, stencil_pages_t *pages);
+
+/**
+ * Frees memory allocated with stencil_pages_alloc (or the mapping of a grid file,
+ * STENCIL_PAGES_MAPPED, which starts in the same page as \a memory).
+ *
+ * @param memory A pointer to the memory (may be NULL)
+ * @param size Number of bytes (same as on the allocation)
+ * @param pages Page policy returned by the allocation
+ */
+void stencil_pages_free(void *memory, size_t size, stencil_pages_t pages);
+
+#endif // __STENCIL_PAGES_H
@@ -0,0 +1,560 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "snapshot.h"
+#include "csv.h"
+
+#define HEADER_VERSION 8
+#define HEADER_ROWS 16
+#define HEADER_COLS 24
+#define HEADER_BOUNDARY 32
+#define HEADER_BLOCK_ROWS 40
+#define HEADER_BLOCKS 48
+
+#define PLANES sizeof(double)
+
+#define HASH_BITS 14
+#define MIN_MATCH 4
+#define MAX_OFFSET 65535
+#define RUN_MASK 15
+#define SKIP_SHIFT 6 // literals without a match make the search faster (incompressible planes)
+
+static void put_le(uint8_t *dest, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++) {
+        dest[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t get_le(const uint8_t *src, size_t bytes)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= (uint64_t)src[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint32_t read32(const uint8_t *src)
+{
+    uint32_t value;
+    memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static uint32_t hash32(uint32_t value)
+{
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/**
+ * Writes the remainder \a length of a literal or match length which does not fit into
+ * the token (bytes of 255 and the rest).
+ */
+static uint8_t *put_length(uint8_t *dest, size_t length)
+{
+    for (; length >= 255; length -= 255) {
+        *dest++ = 255;
+    }
+    *dest++ = (uint8_t)length;
+    return dest;
+}
+
+/**
+ * Reads a length written by put_length and adds it to \a length.
+ *
+ * @return returns false if the input ends before the length
+ */
+static bool get_length(const uint8_t **src, const uint8_t *end, size_t *length)
+{
+    uint8_t byte;
+    do {
+        if (*src >= end) {
+            return false;
+        }
+        byte = *(*src)++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+/**
+ * Writes the sequence of the \a literals bytes of \a src and a match of \a match bytes
+ * at distance \a offset (no match: \a match is 0, only for the last sequence).
+ *
+ * @return returns the end of the sequence in \a dest, NULL if it does not fit
+ */
+static uint8_t *put_sequence(uint8_t *dest, const uint8_t *dest_end, const uint8_t *src, size_t literals,
+                             size_t offset, size_t match)
+{
+    const size_t match_length = (match > 0) ? match - MIN_MATCH : 0;
+    const size_t max_size = 1 + (literals / 255 + 1) + literals + 2 + (match_length / 255 + 1);
+    if (max_size > (size_t)(dest_end - dest)) {
+        return NULL;
+    }
+
+    *dest++ = (uint8_t)(((literals < RUN_MASK) ? literals : RUN_MASK) << 4 |
+                        ((match_length < RUN_MASK) ? match_length : RUN_MASK));
+    if (literals >= RUN_MASK) {
+        dest = put_length(dest, literals - RUN_MASK);
+    }
+    memcpy(dest, src, literals);
+    dest += literals;
+
+    if (match > 0) {
+        put_le(dest, offset, 2);
+        dest += 2;
+        if (match_length >= RUN_MASK) {
+            dest = put_length(dest, match_length - RUN_MASK);
+        }
+    }
+    return dest;
+}
+
+size_t stencil_snapshot_compress(const uint8_t *src, size_t size, uint8_t *dest, size_t capacity)
+{
+    uint32_t table[1 << HASH_BITS]; // position + 1 of the last occurrence (0: none)
+    memset(table, 0, sizeof(table));
+
+    uint8_t *out = dest;
+    const uint8_t *out_end = dest + capacity;
+    size_t anchor = 0;
+    size_t position = 0;
+
+    while (position + MIN_MATCH <= size) {
+        const uint32_t hash = hash32(read32(src + position));
+        const size_t candidate = table[hash];
+        table[hash] = (uint32_t)(position + 1);
+
+        if (candidate == 0 || position - (candidate - 1) > MAX_OFFSET ||
+            read32(src + candidate - 1) != read32(src + position)) {
+            position += 1 + ((position - anchor) >> SKIP_SHIFT);
+            continue;
+        }
+
+        const size_t reference = candidate - 1;
+        size_t match = MIN_MATCH;
+        while (position + match < size && src[reference + match] == src[position + match]) {
+            match++;
+        }
+
+        out = put_sequence(out, out_end, src + anchor, position - anchor, position - reference, match);
+        if (out == NULL) {
+            return 0;
+        }
+        position += match;
+        anchor = position;
+    }
+
+    out = put_sequence(out, out_end, src + anchor, size - anchor, 0, 0);
+    return (out != NULL) ? (size_t)(out - dest) : 0;
+}
+
+bool stencil_snapshot_decompress(const uint8_t *src, size_t size, uint8_t *dest, size_t dest_size)
+{
+    const uint8_t *in = src;
+    const uint8_t *in_end = src + size;
+    uint8_t *out = dest;
+    const uint8_t *out_end = dest + dest_size;
+
+    for (;;) {
+        if (in >= in_end) {
+            return false;
+        }
+        const uint8_t token = *in++;
+
+        size_t literals = token >> 4;
+        if (literals == RUN_MASK && !get_length(&in, in_end, &literals)) {
+            return false;
+        }
+        if (literals > (size_t)(in_end - in) || literals > (size_t)(out_end - out)) {
+            return false;
+        }
+        memcpy(out, in, literals);
+        in += literals;
+        out += literals;
+
+        if (in == in_end) {
+            break; // the last sequence has no match
+        }
+
+        if (in_end - in < 2) {
+            return false;
+        }
+        const size_t offset = (size_t)get_le(in, 2);
+        in += 2;
+        size_t match = token & RUN_MASK;
+        if (match == RUN_MASK && !get_length(&in, in_end, &match)) {
+            return false;
+        }
+        match += MIN_MATCH;
+        if (offset == 0 || offset > (size_t)(out - dest) || match > (size_t)(out_end - out)) {
+            return false;
+        }
+
+        // the match may overlap the bytes it produces (runs)
+        const uint8_t *reference = out - offset;
+        for (size_t i = 0; i < match; i++) {
+            out[i] = reference[i];
+        }
+        out += match;
+    }
+
+    return out == out_end;
+}
+
+/**
+ * Byte-shuffles the values of the rows [\a first_row, \a last_row[ of \a matrix into
+ * \a planes (byte k of value i at k * count + i, the byte order of the values is
+ * little-endian on every host).
+ */
+static void shuffle_rows(const stencil_matrix_t *matrix, size_t first_row, size_t last_row, uint8_t *planes)
+{
+    const size_t count = (last_row - first_row) * matrix->cols;
+
+    for (size_t row = first_row; row < last_row; row++) {
+        const double *values = stencil_matrix_get_ptr(matrix, row, 0);
+        const size_t first = (row - first_row) * matrix->cols;
+        for (size_t col = 0; col < matrix->cols; col++) {
+            uint64_t bits;
+            memcpy(&bits, &values[col], sizeof(bits));
+            for (size_t plane = 0; plane < PLANES; plane++) {
+                planes[plane * count + first + col] = (uint8_t)(bits >> (8 * plane));
+            }
+        }
+    }
+}
+
+/**
+ * Reverses shuffle_rows for the rows [\a first_row, \a last_row[ of a block which starts
+ * at row \a block_row and contains \a count values.
+ */
+static void unshuffle_rows(stencil_matrix_t *matrix, size_t block_row, size_t first_row, size_t last_row,
+                           const uint8_t *planes, size_t count)
+{
+    for (size_t row = first_row; row < last_row; row++) {
+        double *values = stencil_matrix_get_ptr(matrix, row, 0);
+        const size_t first = (row - block_row) * matrix->cols;
+        for (size_t col = 0; col < matrix->cols; col++) {
+            uint64_t bits = 0;
+            for (size_t plane = 0; plane < PLANES; plane++) {
+                bits |= (uint64_t)planes[plane * count + first + col] << (8 * plane);
+            }
+            memcpy(&values[col], &bits, sizeof(bits));
+        }
+    }
+}
+
+/**
+ * Blocks of a snapshot (compressed by write_blocks, decompressed by read_blocks), the
+ * thread with index i processes the blocks i, i + threads, ... of [first_block, last_block[.
+ */
+struct block_job {
+    stencil_matrix_t *matrix;
+    size_t block_rows;
+    size_t first_block;
+    size_t last_block;
+    size_t threads;
+
+    // write_blocks: the compressed blocks
+    uint8_t **data;
+    size_t *sizes;
+
+    // read_blocks: the mapped file and the rows to read
+    const uint8_t *mapping;
+    size_t file_size;
+    size_t first_row;
+    size_t last_row;
+
+    bool valid;
+};
+
+static void *write_blocks(void *arg)
+{
+    struct block_job *job = (struct block_job *)arg;
+    const size_t rows = job->matrix->rows;
+
+    uint8_t *planes = (uint8_t *)malloc(job->block_rows * job->matrix->cols * PLANES);
+    job->valid = (planes != NULL);
+
+    for (size_t block = job->first_block; job->valid && block < job->last_block; block += job->threads) {
+        const size_t first_row = block * job->block_rows;
+        const size_t last_row = (first_row + job->block_rows < rows) ? first_row + job->block_rows : rows;
+        const size_t size = (last_row - first_row) * job->matrix->cols * PLANES;
+
+        shuffle_rows(job->matrix, first_row, last_row, planes);
+
+        uint8_t *data = (uint8_t *)malloc(size);
+        if (data == NULL) {
+            job->valid = false;
+            break;
+        }
+
+        // a block is only compressed if it gets smaller
+        size_t compressed = stencil_snapshot_compress(planes, size, data, size - 1);
+        if (compressed == 0) {
+            memcpy(data, planes, size);
+            compressed = size;
+        }
+        job->data[block] = data;
+        job->sizes[block] = compressed;
+    }
+
+    free(planes);
+    return NULL;
+}
+
+static void *read_blocks(void *arg)
+{
+    struct block_job *job = (struct block_job *)arg;
+    const size_t rows = job->matrix->rows;
+    const size_t blocks = (rows + job->block_rows - 1) / job->block_rows;
+    const uint8_t *index = job->mapping + STENCIL_SNAPSHOT_HEADER_SIZE;
+
+    uint8_t *planes = (uint8_t *)malloc(job->block_rows * job->matrix->cols * PLANES);
+    job->valid = (planes != NULL);
+
+    for (size_t block = job->first_block; job->valid && block < job->last_block; block += job->threads) {
+        const size_t block_row = block * job->block_rows;
+        const size_t block_end = (block_row + job->block_rows < rows) ? block_row + job->block_rows : rows;
+        const size_t count = (block_end - block_row) * job->matrix->cols;
+        const size_t size = count * PLANES;
+
+        const uint64_t offset = get_le(index + block * STENCIL_SNAPSHOT_INDEX_ENTRY_SIZE, 8);
+        const uint64_t compressed = get_le(index + block * STENCIL_SNAPSHOT_INDEX_ENTRY_SIZE + 8, 8);
+        if (offset < STENCIL_SNAPSHOT_HEADER_SIZE + blocks * STENCIL_SNAPSHOT_INDEX_ENTRY_SIZE ||
+            offset > job->file_size || compressed > job->file_size - offset || compressed > size) {
+            job->valid = false;
+            break;
+        }
+
+        const uint8_t *data = job->mapping + offset;
+        if (compressed < size) {
+            if (!stencil_snapshot_decompress(data, compressed, planes, size)) {
+                job->valid = false;
+                break;
+            }
+            data = planes;
+        }
+
+        const size_t first_row = (job->first_row > block_row) ? job->first_row : block_row;
+        const size_t last_row = (job->last_row < block_end) ? job->last_row : block_end;
+        unshuffle_rows(job->matrix, block_row, first_row, last_row, data, count);
+    }
+
+    free(planes);
+    return NULL;
+}
+
+bool stencil_snapshot_is_snapshot(FILE *stream)
+{
+    const long position = ftell(stream);
+
+    char magic[STENCIL_SNAPSHOT_MAGIC_SIZE];
+    const bool snapshot = (fread(magic, 1, STENCIL_SNAPSHOT_MAGIC_SIZE, stream) == STENCIL_SNAPSHOT_MAGIC_SIZE) &&
+                          (memcmp(magic, STENCIL_SNAPSHOT_MAGIC, STENCIL_SNAPSHOT_MAGIC_SIZE) == 0);
+
+    fseek(stream, position, SEEK_SET);
+    return snapshot;
+}
+
+bool stencil_snapshot_write(const stencil_matrix_t *matrix, size_t block_rows, FILE *stream)
+{
+    if (stream == NULL) {
+        return false;
+    }
+
+    const size_t row_size = matrix->cols * PLANES;
+    if (block_rows == 0) {
+        block_rows = (row_size < STENCIL_SNAPSHOT_BLOCK_SIZE) ? STENCIL_SNAPSHOT_BLOCK_SIZE / row_size : 1;
+    }
+    const size_t blocks = (matrix->rows + block_rows - 1) / block_rows;
+
+    uint8_t **data = (uint8_t **)calloc(blocks ? blocks : 1, sizeof(uint8_t *));
+    size_t *sizes = (size_t *)calloc(blocks ? blocks : 1, sizeof(size_t));
+    bool written = (data != NULL) && (sizes != NULL);
+
+    if (written) {
+        const size_t threads = stencil_io_threads(matrix->rows * row_size);
+        struct block_job jobs[threads];
+        for (size_t i = 0; i < threads; i++) {
+            jobs[i] = (struct block_job) {
+                .matrix = (stencil_matrix_t *)matrix, .block_rows = block_rows, .first_block = i,
+                .last_block = blocks, .threads = threads, .data = data, .sizes = sizes
+            };
+        }
+        stencil_io_run_threads(write_blocks, jobs, sizeof(struct block_job), threads);
+        for (size_t i = 0; i < threads; i++) {
+            written = written && jobs[i].valid;
+        }
+    }
+
+    if (written) {
+        uint8_t header[STENCIL_SNAPSHOT_HEADER_SIZE];
+        memset(header, 0, sizeof(header));
+        memcpy(header, STENCIL_SNAPSHOT_MAGIC, STENCIL_SNAPSHOT_MAGIC_SIZE);
+        put_le(header + HEADER_VERSION, STENCIL_SNAPSHOT_VERSION, 4);
+        put_le(header + HEADER_ROWS, matrix->rows, 8);
+        put_le(header + HEADER_COLS, matrix->cols, 8);
+        put_le(header + HEADER_BOUNDARY, matrix->boundary, 8);
+        put_le(header + HEADER_BLOCK_ROWS, block_rows, 8);
+        put_le(header + HEADER_BLOCKS, blocks, 8);
+        written = (fwrite(header, 1, sizeof(header), stream) == sizeof(header));
+
+        size_t offset = STENCIL_SNAPSHOT_HEADER_SIZE + blocks * STENCIL_SNAPSHOT_INDEX_ENTRY_SIZE;
+        for (size_t block = 0; written && block < blocks; block++) {
+            uint8_t entry[STENCIL_SNAPSHOT_INDEX_ENTRY_SIZE];
+            put_le(entry, offset, 8);
+            put_le(entry + 8, sizes[block], 8);
+            written = (fwrite(entry, 1, sizeof(entry), stream) == sizeof(entry));
+            offset += sizes[block];
+        }
+
+        for (size_t block = 0; written && block < blocks; block++) {
+            written = (fwrite(data[block], 1, sizes[block], stream) == sizes[block]);
+        }
+    }
+
+    if (data != NULL) {
+        for (size_t block = 0; block < blocks; block++) {
+            free(data[block]);
+        }
+    }
+    free(sizes);
+    free(data);
+
+    return written && (fflush(stream) == 0);
+}
+
+/**
+ * Maps the snapshot file \a filepath (read-only) and decodes its header.
+ *
+ * @return returns a pointer to the mapping, NULL on failure
+ */
+static uint8_t *map_snapshot(const char *filepath, size_t *file_size, size_t *rows, size_t *cols,
+                             size_t *boundary, size_t *block_rows)
+{
+    int fd = open(filepath, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || (size_t)file_stat.st_size < STENCIL_SNAPSHOT_HEADER_SIZE) {
+        goto exit;
+    }
+    *file_size = file_stat.st_size;
+
+    uint8_t *mapping = (uint8_t *)mmap(NULL, *file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        goto exit;
+    }
+
+    if (memcmp(mapping, STENCIL_SNAPSHOT_MAGIC, STENCIL_SNAPSHOT_MAGIC_SIZE) != 0 ||
+        get_le(mapping + HEADER_VERSION, 4) != STENCIL_SNAPSHOT_VERSION) {
+        goto exit_mapping;
+    }
+
+    *rows = get_le(mapping + HEADER_ROWS, 8);
+    *cols = get_le(mapping + HEADER_COLS, 8);
+    *boundary = get_le(mapping + HEADER_BOUNDARY, 8);
+    *block_rows = get_le(mapping + HEADER_BLOCK_ROWS, 8);
+    const size_t blocks = get_le(mapping + HEADER_BLOCKS, 8);
+
+    // the index has to be in the file, the size of a block must not overflow
+    if (*rows < 2 * *boundary || *cols < 2 * *boundary || *cols == 0 || *block_rows == 0 ||
+        *cols > SIZE_MAX / PLANES / *block_rows || blocks != (*rows + *block_rows - 1) / *block_rows ||
+        blocks > (*file_size - STENCIL_SNAPSHOT_HEADER_SIZE) / STENCIL_SNAPSHOT_INDEX_ENTRY_SIZE) {
+        goto exit_mapping;
+    }
+
+    close(fd); // the mapping stays valid
+    return mapping;
+
+exit_mapping:
+    munmap(mapping, *file_size);
+exit:
+    close(fd);
+    return NULL;
+}
+
+/**
+ * Decompresses the blocks of the rows [\a first_row, \a last_row[ of the mapped snapshot
+ * \a mapping into \a matrix.
+ */
+static bool read_rows(const uint8_t *mapping, size_t file_size, size_t block_rows, size_t first_row,
+                      size_t last_row, stencil_matrix_t *matrix)
+{
+    if (first_row >= last_row) {
+        return true;
+    }
+
+    const size_t first_block = first_row / block_rows;
+    const size_t last_block = (last_row + block_rows - 1) / block_rows;
+    const size_t threads = stencil_io_threads((last_row - first_row) * matrix->cols * PLANES);
+
+    struct block_job jobs[threads];
+    for (size_t i = 0; i < threads; i++) {
+        jobs[i] = (struct block_job) {
+            .matrix = matrix, .block_rows = block_rows, .first_block = first_block + i, .last_block = last_block,
+            .threads = threads, .mapping = mapping, .file_size = file_size, .first_row = first_row,
+            .last_row = last_row
+        };
+    }
+    stencil_io_run_threads(read_blocks, jobs, sizeof(struct block_job), threads);
+
+    bool valid = true;
+    for (size_t i = 0; i < threads; i++) {
+        valid = valid && jobs[i].valid;
+    }
+    return valid;
+}
+
+stencil_matrix_t *stencil_snapshot_read(const char *filepath)
+{
+    size_t file_size, rows, cols, boundary, block_rows;
+    uint8_t *mapping = map_snapshot(filepath, &file_size, &rows, &cols, &boundary, &block_rows);
+    if (!mapping) {
+        goto exit_mapping;
+    }
+
+    stencil_matrix_t *matrix = stencil_matrix_new(rows, cols, boundary);
+    if (!matrix) {
+        goto exit_matrix;
+    }
+
+    if (!read_rows(mapping, file_size, block_rows, 0, rows, matrix)) {
+        goto exit_values;
+    }
+
+    munmap(mapping, file_size);
+    return matrix;
+
+exit_values:
+    stencil_matrix_free(matrix);
+exit_matrix:
+    munmap(mapping, file_size);
+exit_mapping:
+    return NULL;
+}
+
+bool stencil_snapshot_read_rows(const char *filepath, size_t first_row, size_t rows, stencil_matrix_t *matrix)
+{
+    size_t file_size, snapshot_rows, cols, boundary, block_rows;
+    uint8_t *mapping = map_snapshot(filepath, &file_size, &snapshot_rows, &cols, &boundary, &block_rows);
+    if (!mapping) {
+        return false;
+    }
+
+    const bool valid = (matrix->rows == snapshot_rows) && (matrix->cols == cols) && (first_row <= snapshot_rows) &&
+                       (rows <= snapshot_rows - first_row) &&
+                       read_rows(mapping, file_size, block_rows, first_row, first_row + rows, matrix);
+
+    munmap(mapping, file_size);
+    return valid;
+}
@@ -0,0 +1,99 @@
+#ifndef __STENCIL_SNAPSHOT_H
+#define __STENCIL_SNAPSHOT_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+
+/**
+ * Compressed snapshot file (version 1), all fields little-endian:
+ *
+ *   offset  size  field
+ *        0     8  magic "STNCSNAP"
+ *        8     4  version
+ *       12     4  reserved (0)
+ *       16     8  rows (with boundary)
+ *       24     8  cols (with boundary)
+ *       32     8  boundary
+ *       40     8  rows per block (the last block may have fewer)
+ *       48     8  number of blocks
+ *       56     8  reserved (0)
+ *
+ * followed by the block index (offset of the block in the file and its size in bytes,
+ * 8 bytes each per block) and the blocks. A block contains the values of its rows
+ * (without padding) byte-shuffled: byte k of all values is stored in plane k (the
+ * planes of the sign and exponent bytes of smooth grids are long runs), the planes are
+ * compressed with the LZ codec below. A block which does not get smaller is stored
+ * shuffled but uncompressed (its size is the size of the values).
+ *
+ * The blocks are compressed in parallel, the index allows to decompress only the
+ * blocks of a range of rows (stencil_snapshot_read_rows).
+ */
+#define STENCIL_SNAPSHOT_MAGIC "STNCSNAP"
+#define STENCIL_SNAPSHOT_MAGIC_SIZE 8
+#define STENCIL_SNAPSHOT_VERSION 1
+#define STENCIL_SNAPSHOT_HEADER_SIZE 64
+#define STENCIL_SNAPSHOT_INDEX_ENTRY_SIZE 16
+
+/**
+ * Number of bytes of values per block if the rows per block are not given.
+ */
+#define STENCIL_SNAPSHOT_BLOCK_SIZE (1024 * 1024)
+
+/**
+ * Compresses the \a size bytes of \a src into \a dest (LZ77, byte-aligned sequences of
+ * a token, literals, a 16 bit offset and the match length like LZ4).
+ *
+ * @param capacity size of \a dest in bytes
+ *
+ * @return returns the size of the compressed data, 0 if it needs more than \a capacity bytes
+ */
+size_t stencil_snapshot_compress(const uint8_t *src, size_t size, uint8_t *dest, size_t capacity);
+
+/**
+ * Decompresses the \a size bytes of \a src (see stencil_snapshot_compress) into \a dest.
+ *
+ * @return returns false if the data is corrupt or does not decompress to exactly
+ *         \a dest_size bytes
+ */
+bool stencil_snapshot_decompress(const uint8_t *src, size_t size, uint8_t *dest, size_t dest_size);
+
+/**
+ * @param stream stream positioned at the start of the file (the position is restored)
+ *
+ * @return returns true if the stream starts with the magic of a snapshot file
+ */
+bool stencil_snapshot_is_snapshot(FILE *stream);
+
+/**
+ * Writes all values (with boundary) of matrix \a matrix as compressed snapshot to
+ * \a stream. All blocks are compressed before they are written, thus the stream does
+ * not need to be seekable.
+ *
+ * @param block_rows rows per block (0: STENCIL_SNAPSHOT_BLOCK_SIZE bytes per block)
+ *
+ * @return returns true if the matrix was written successfully
+ */
+bool stencil_snapshot_write(const stencil_matrix_t *matrix, size_t block_rows, FILE *stream);
+
+/**
+ * Reads the snapshot file \a filepath into a new matrix, the blocks are decompressed
+ * in parallel.
+ *
+ * @return A pointer to a matrix, NULL on failure
+ */
+stencil_matrix_t *stencil_snapshot_read(const char *filepath);
+
+/**
+ * Reads the rows [\a first_row, \a first_row + \a rows[ of the snapshot file \a filepath
+ * into the same rows of \a matrix (which has the size of the snapshot), only the blocks
+ * of these rows are decompressed.
+ *
+ * @return returns true if the rows were read successfully
+ */
+bool stencil_snapshot_read_rows(const char *filepath, size_t first_row, size_t rows, stencil_matrix_t *matrix);
+
+#endif // __STENCIL_SNAPSHOT_H
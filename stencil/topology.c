@@ -0,0 +1,337 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "topology.h"
+
+#define CPU_MASK_BITS STENCIL_AFFINITY_CPUS
+#define CPU_MASK_WORD_BITS (8 * sizeof(unsigned long))
+
+#define TOPOLOGY_MAX_NODES 64
+#define TOPOLOGY_MAX_CACHES 16 // cache indices of a CPU
+#define TOPOLOGY_PATH_SIZE 128
+
+static stencil_placement_t placement = STENCIL_PLACEMENT_NONE;
+static pthread_once_t placement_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Reads the initial placement from STENCIL_PLACEMENT_ENV, run once by the first call of
+ * the getter or setter (from any thread).
+ */
+static void init_placement(void)
+{
+    const char *env = getenv(STENCIL_PLACEMENT_ENV);
+    if (env != NULL) {
+        if (strcmp(env, "none") == 0) {
+            placement = STENCIL_PLACEMENT_NONE;
+        } else if (strcmp(env, "topology") == 0) {
+            placement = STENCIL_PLACEMENT_TOPOLOGY;
+        }
+    }
+}
+
+void stencil_topology_set_placement(stencil_placement_t value)
+{
+    pthread_once(&placement_once, init_placement);
+    placement = value;
+}
+
+stencil_placement_t stencil_topology_get_placement(void)
+{
+    pthread_once(&placement_once, init_placement);
+    return placement;
+}
+
+/**
+ * Reads the first integer of the file \a path.
+ */
+static bool read_int(const char *path, int *value)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    const bool read = (fscanf(file, "%d", value) == 1);
+    fclose(file);
+    return read;
+}
+
+/**
+ * Reads the CPU list (e.g. "0-3,8-11") of the file \a path.
+ *
+ * @param first returns the first CPU of the list
+ * @param below returns the number of CPUs of the list below \a cpu
+ */
+static bool read_cpu_list(const char *path, int cpu, int *first, int *below)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    bool read = false;
+    *below = 0;
+    int range_first;
+    while (fscanf(file, "%d", &range_first) == 1) {
+        int range_last = range_first;
+        int separator = fgetc(file);
+        if (separator == '-') {
+            if (fscanf(file, "%d", &range_last) != 1) {
+                break;
+            }
+            separator = fgetc(file);
+        }
+
+        if (!read) {
+            *first = range_first;
+            read = true;
+        }
+        for (int i = range_first; i <= range_last && i < cpu; i++) {
+            (*below)++;
+        }
+
+        if (separator != ',') {
+            break;
+        }
+    }
+
+    fclose(file);
+    return read;
+}
+
+/**
+ * Reads the topology of CPU \a cpu, the values which cannot be read are unique to it.
+ */
+static void probe_cpu(struct stencil_topology_cpu *topology_cpu, int cpu)
+{
+    char path[TOPOLOGY_PATH_SIZE];
+    int below;
+
+    topology_cpu->cpu = cpu;
+    topology_cpu->smt = 0;
+    topology_cpu->node = 0;
+    topology_cpu->package = 0;
+    topology_cpu->llc = cpu;
+    topology_cpu->l2 = cpu;
+    topology_cpu->core = cpu;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+    read_int(path, &topology_cpu->package);
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", cpu);
+    if (read_cpu_list(path, cpu, &topology_cpu->core, &below)) {
+        topology_cpu->smt = below;
+    }
+
+    for (int node = 0; node < TOPOLOGY_MAX_NODES; node++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d", cpu, node);
+        if (access(path, F_OK) == 0) {
+            topology_cpu->node = node;
+            break;
+        }
+    }
+
+    // the data and unified caches, the last level is the highest one
+    int llc_level = 0;
+    for (int index = 0; index < TOPOLOGY_MAX_CACHES; index++) {
+        int level;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpu, index);
+        if (!read_int(path, &level)) {
+            break;
+        }
+
+        char type[16] = "";
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/type", cpu, index);
+        FILE *file = fopen(path, "r");
+        if (file != NULL) {
+            if (fscanf(file, "%15s", type) != 1) {
+                type[0] = '\0';
+            }
+            fclose(file);
+        }
+        if (strcmp(type, "Instruction") == 0) {
+            continue;
+        }
+
+        int first;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list", cpu, index);
+        if (!read_cpu_list(path, cpu, &first, &below)) {
+            continue;
+        }
+
+        if (level == 2) {
+            topology_cpu->l2 = first;
+        }
+        if (level > llc_level) {
+            topology_cpu->llc = first;
+            llc_level = level;
+        }
+    }
+}
+
+static int compare_cpus(const void *a, const void *b)
+{
+    const struct stencil_topology_cpu *x = (const struct stencil_topology_cpu *)a;
+    const struct stencil_topology_cpu *y = (const struct stencil_topology_cpu *)b;
+
+    const int keys_x[] = {x->smt, x->node, x->package, x->llc, x->l2, x->core, x->cpu};
+    const int keys_y[] = {y->smt, y->node, y->package, y->llc, y->l2, y->core, y->cpu};
+    for (size_t i = 0; i < sizeof(keys_x) / sizeof(keys_x[0]); i++) {
+        if (keys_x[i] != keys_y[i]) {
+            return (keys_x[i] < keys_y[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+stencil_topology_t *stencil_topology_probe(void)
+{
+    unsigned long mask[CPU_MASK_BITS / CPU_MASK_WORD_BITS];
+    memset(mask, 0, sizeof(mask));
+    if (syscall(SYS_sched_getaffinity, 0, sizeof(mask), mask) <= 0) {
+        goto exit_mask;
+    }
+
+    stencil_topology_t *topology = (stencil_topology_t *)malloc(sizeof(stencil_topology_t));
+    if (!topology) {
+        goto exit_mask;
+    }
+
+    topology->count = 0;
+    for (int cpu = 0; cpu < CPU_MASK_BITS; cpu++) {
+        if (mask[cpu / CPU_MASK_WORD_BITS] & (1UL << (cpu % CPU_MASK_WORD_BITS))) {
+            topology->count++;
+        }
+    }
+    if (topology->count == 0) {
+        goto exit_cpus;
+    }
+
+    topology->cpus = (struct stencil_topology_cpu *)malloc(topology->count * sizeof(struct stencil_topology_cpu));
+    if (!topology->cpus) {
+        goto exit_cpus;
+    }
+
+    size_t i = 0;
+    for (int cpu = 0; cpu < CPU_MASK_BITS; cpu++) {
+        if (mask[cpu / CPU_MASK_WORD_BITS] & (1UL << (cpu % CPU_MASK_WORD_BITS))) {
+            probe_cpu(&topology->cpus[i++], cpu);
+        }
+    }
+    qsort(topology->cpus, topology->count, sizeof(struct stencil_topology_cpu), compare_cpus);
+
+    return topology;
+
+exit_cpus:
+    free(topology);
+exit_mask:
+    return NULL;
+}
+
+void stencil_topology_free(stencil_topology_t *topology)
+{
+    if (!topology) {
+        return;
+    }
+
+    free(topology->cpus);
+    free(topology);
+}
+
+bool stencil_topology_pin(const stencil_topology_t *topology, size_t thread)
+{
+    const int cpu = topology->cpus[thread % topology->count].cpu;
+
+    unsigned long mask[CPU_MASK_BITS / CPU_MASK_WORD_BITS];
+    memset(mask, 0, sizeof(mask));
+    mask[cpu / CPU_MASK_WORD_BITS] = 1UL << (cpu % CPU_MASK_WORD_BITS);
+
+    return syscall(SYS_sched_setaffinity, 0, sizeof(mask), mask) == 0;
+}
+
+bool stencil_topology_get_affinity(stencil_affinity_t *affinity)
+{
+    memset(affinity->mask, 0, sizeof(affinity->mask));
+    return syscall(SYS_sched_getaffinity, 0, sizeof(affinity->mask), affinity->mask) > 0;
+}
+
+bool stencil_topology_set_affinity(const stencil_affinity_t *affinity)
+{
+    return syscall(SYS_sched_setaffinity, 0, sizeof(affinity->mask), affinity->mask) == 0;
+}
+
+size_t stencil_topology_group_size(const stencil_topology_t *topology, size_t threads)
+{
+    if (threads == 0 || threads > topology->count) {
+        return 0;
+    }
+
+    const struct stencil_topology_cpu *cpus = topology->cpus;
+
+    size_t group_size = 1;
+    while (group_size < threads && cpus[group_size].llc == cpus[0].llc) {
+        group_size++;
+    }
+    if (threads % group_size != 0) {
+        return 0;
+    }
+
+    for (size_t first = 0; first < threads; first += group_size) {
+        for (size_t i = first; i < first + group_size; i++) {
+            if (cpus[i].llc != cpus[first].llc) {
+                return 0;
+            }
+        }
+        if (first + group_size < threads && cpus[first + group_size].llc == cpus[first].llc) {
+            return 0;
+        }
+    }
+
+    return group_size;
+}
+
+void stencil_topology_block(size_t group_size, size_t blocks_horizontal, size_t blocks_vertical, size_t thread,
+                            size_t *row, size_t *col)
+{
+    // the rectangle of a group with the shortest halo (perimeter)
+    size_t group_horizontal = 0;
+    size_t group_vertical = 0;
+    for (size_t h = 1; h <= group_size; h++) {
+        const size_t v = group_size / h;
+        if (h * v != group_size || blocks_horizontal % h != 0 || blocks_vertical % v != 0) {
+            continue;
+        }
+        if (group_horizontal == 0 || h + v < group_horizontal + group_vertical) {
+            group_horizontal = h;
+            group_vertical = v;
+        }
+    }
+
+    if (group_size <= 1 || group_horizontal == 0) {
+        *row = thread / blocks_horizontal;
+        *col = thread % blocks_horizontal;
+        return;
+    }
+
+    // the groups are placed row by row, the threads of a group as well
+    const size_t group = thread / group_size;
+    const size_t index = thread % group_size;
+    const size_t groups_horizontal = blocks_horizontal / group_horizontal;
+
+    *row = (group / groups_horizontal) * group_vertical + index / group_horizontal;
+    *col = (group % groups_horizontal) * group_horizontal + index % group_horizontal;
+}
+
+void stencil_topology_report(const stencil_topology_t *topology, FILE *stream)
+{
+    fprintf(stream, "topology:");
+    for (size_t i = 0; i < topology->count; i++) {
+        const bool new_group = (i == 0) || (topology->cpus[i].llc != topology->cpus[i - 1].llc);
+        fprintf(stream, "%s%d", (i == 0) ? " " : (new_group ? " | " : ","), topology->cpus[i].cpu);
+    }
+    fprintf(stream, "\n");
+}
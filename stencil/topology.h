@@ -0,0 +1,126 @@
+#ifndef __STENCIL_TOPOLOGY_H
+#define __STENCIL_TOPOLOGY_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Placement of the threads of the parallel backends.
+ */
+enum stencil_placement {
+    STENCIL_PLACEMENT_NONE,    // the threads are placed by the runtime (e.g. OMP_PROC_BIND)
+    STENCIL_PLACEMENT_TOPOLOGY // the threads are pinned in the order of the topology
+};
+typedef enum stencil_placement stencil_placement_t;
+
+/**
+ * Name of the environment variable which sets the initial placement ("none" or "topology").
+ */
+#define STENCIL_PLACEMENT_ENV "STENCIL_PLACEMENT"
+
+/**
+ * CPU of the topology, the caches and cores are identified by their first CPU.
+ */
+struct stencil_topology_cpu {
+    int cpu;
+    int smt;     // index of the CPU among the SMT siblings of its core
+    int node;    // NUMA node
+    int package;
+    int llc;     // first CPU sharing the last level cache
+    int l2;      // first CPU sharing the L2 cache
+    int core;    // first CPU of the core
+};
+
+/**
+ * CPUs the calling thread may run on (read from /sys/devices/system/cpu), ordered such
+ * that consecutive CPUs share as much as possible: first one CPU per core, then the
+ * SMT siblings, each by NUMA node, package, last level cache, L2 cache and core. Thread
+ * i is pinned to CPU i, thus neighbouring threads share a cache.
+ */
+struct stencil_topology {
+    size_t count;
+    struct stencil_topology_cpu *cpus;
+};
+typedef struct stencil_topology stencil_topology_t;
+
+#define STENCIL_AFFINITY_CPUS 1024 // CPUs of an affinity mask (the default size of cpu_set_t)
+
+/**
+ * Affinity mask of a thread, saved before it is pinned.
+ */
+struct stencil_affinity {
+    unsigned long mask[STENCIL_AFFINITY_CPUS / (8 * sizeof(unsigned long))];
+};
+typedef struct stencil_affinity stencil_affinity_t;
+
+/**
+ * Sets the placement of all following calculations (not while other threads calculate).
+ */
+void stencil_topology_set_placement(stencil_placement_t placement);
+
+/**
+ * @return returns the placement of all following calculations, initially the placement
+ *         given by STENCIL_PLACEMENT_ENV or STENCIL_PLACEMENT_NONE
+ */
+stencil_placement_t stencil_topology_get_placement(void);
+
+/**
+ * Reads the topology of the CPUs of the calling thread (its affinity mask), unknown
+ * caches and nodes are not shared with other CPUs.
+ *
+ * @return A pointer to the topology, NULL on failure
+ */
+stencil_topology_t *stencil_topology_probe(void);
+
+void stencil_topology_free(stencil_topology_t *topology);
+
+/**
+ * Pins the calling thread to the CPU of thread \a thread (round robin if there are more
+ * threads than CPUs).
+ *
+ * @return returns false if the thread cannot be pinned
+ */
+bool stencil_topology_pin(const stencil_topology_t *topology, size_t thread);
+
+/**
+ * Reads the affinity mask of the calling thread.
+ *
+ * @return returns false if the mask cannot be read
+ */
+bool stencil_topology_get_affinity(stencil_affinity_t *affinity);
+
+/**
+ * Sets the affinity mask of the calling thread (e.g. restores a mask saved by
+ * stencil_topology_get_affinity).
+ *
+ * @return returns false if the mask cannot be set
+ */
+bool stencil_topology_set_affinity(const stencil_affinity_t *affinity);
+
+/**
+ * @return returns the number of consecutive threads (of \a threads pinned threads) which
+ *         share a last level cache, 0 if the groups of the threads differ in size
+ */
+size_t stencil_topology_group_size(const stencil_topology_t *topology, size_t threads);
+
+/**
+ * Maps thread \a thread to a block of a grid of \a blocks_vertical x \a blocks_horizontal
+ * blocks (one block per thread). The threads of a group of \a group_size threads get a
+ * rectangle of neighbouring blocks (as square as possible), thus the halos between them
+ * stay in the shared cache. If the groups do not tile the grid, the blocks are mapped
+ * row by row.
+ *
+ * @param row returns the row of the block
+ * @param col returns the col of the block
+ */
+void stencil_topology_block(size_t group_size, size_t blocks_horizontal, size_t blocks_vertical, size_t thread,
+                            size_t *row, size_t *col);
+
+/**
+ * Prints the CPUs in their order, the groups of the last level cache are separated
+ * by | (e.g. "topology: 0,1,2,3 | 4,5,6,7").
+ */
+void stencil_topology_report(const stencil_topology_t *topology, FILE *stream);
+
+#endif // __STENCIL_TOPOLOGY_H
@@ -7,6 +7,9 @@
 #include <sys/time.h>
 
 #include "util.h"
+#include "binary.h"
+#include "csv.h"
+#include "snapshot.h"
 
 stencil_matrix_t* new_matrix_from_file(const char* filepath)
 {
@@ -15,6 +18,16 @@ stencil_matrix_t* new_matrix_from_file(const char* filepath)
         return NULL;
     }
 
+    if (stencil_binary_is_binary(stream)) {
+        fclose(stream);
+        return stencil_binary_map(filepath);
+    }
+
+    if (stencil_snapshot_is_snapshot(stream)) {
+        fclose(stream);
+        return stencil_snapshot_read(filepath);
+    }
+
     /* read number of rows, columns and boundary size */
     char* line = NULL;
     size_t len = 0;
@@ -44,51 +57,31 @@ stencil_matrix_t* new_matrix_from_file(const char* filepath)
         goto exit;
     }
 
-    /* read matrix values */
-    matrix->boundary = 0; // we need to be able to change the boundary values
-    for (size_t row = 0; row < matrix->rows; ++row) {
-        if (getline(&line, &len, stream) == 0) {
-            goto exit_matrix;
-        }
-
-        char* record = strtok(line, ";");
-        for (size_t col = 0; col < matrix->cols; ++col) {
-            if (record == NULL) {
-                goto exit_matrix;
-            }
-            stencil_matrix_set(matrix, row, col, strtod(record, NULL));
-            record = strtok(NULL, ";");
-        }
+    /* read matrix values (in parallel, see csv.h) */
+    if (!stencil_csv_read_values(matrix, stream)) {
+        goto exit_matrix;
     }
-    matrix->boundary = boundary; // change it back to the original value
 
+    free(line);
     fclose(stream);
     return matrix;
 
 exit_matrix:
-    free(matrix);
+    stencil_matrix_free(matrix);
 exit:
+    free(line);
     fclose(stream);
     return NULL;
 }
 
 bool matrix_to_file(const stencil_matrix_t* matrix, FILE *stream)
 {
-    if (stream == NULL) {
-        return false;
-    }
+    return stencil_csv_write(matrix, stream);
+}
 
-    for(size_t row = 0; row < matrix->rows; ++row) {
-        for(size_t col = 0; col < matrix->cols; ++col) {
-           if (fprintf(stream, "%.3f;", stencil_matrix_get(matrix, row, col)) < 0) {
-               return false;
-           }
-        }
-        if (fprintf(stream, "\n") < 0) {
-            return false;
-        }
-    }
-    return true;
+bool matrix_to_snapshot(const stencil_matrix_t* matrix, FILE *stream)
+{
+    return stencil_snapshot_write(matrix, 0, stream);
 }
 
 stencil_matrix_t* new_randomized_matrix(size_t rows, size_t cols, size_t boundary, int min_value, int max_value)
@@ -98,6 +91,15 @@ stencil_matrix_t* new_randomized_matrix(size_t rows, size_t cols, size_t boundar
         return NULL;
     }
 
+    randomize_matrix(matrix, min_value, max_value);
+
+    return matrix;
+}
+
+void randomize_matrix(stencil_matrix_t* matrix, int min_value, int max_value)
+{
+    const size_t boundary = matrix->boundary;
+
     srand((unsigned int)time(NULL));
 
     matrix->boundary = 0; // we need to be able to change the boundary values
@@ -107,8 +109,17 @@ stencil_matrix_t* new_randomized_matrix(size_t rows, size_t cols, size_t boundar
         }
     }
     matrix->boundary = boundary; // change it back to the original value
+}
 
-    return matrix;
+size_t partition_range(size_t size, size_t parts, size_t part, size_t *first)
+{
+    assert(parts > 0 && part < parts);
+
+    const size_t base = size / parts;
+    const size_t remainder = size % parts;
+
+    *first = part * base + ((part < remainder) ? part : remainder);
+    return base + ((part < remainder) ? 1 : 0);
 }
 
 double get_time()
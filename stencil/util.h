@@ -11,6 +11,8 @@
  * creates a new matrix with values from the provided csv file \a filepath
  * the first line of the file has to contain
  * the number of rows and number of columns
+ * binary grid files (see binary.h) are mapped instead of parsed,
+ * compressed snapshots (see snapshot.h) are decompressed
  *
  * @param filepath path to the csv file
  *
@@ -32,8 +34,19 @@ stencil_matrix_t* new_matrix_from_file(const char* filepath);
  */
 stencil_matrix_t* new_randomized_matrix(size_t rows, size_t cols, size_t boundary, int min_value, int max_value);
 
+/**
+ * sets all values (with boundary) of the matrix \a matrix to random values
+ * in the interval [\a min_value, \a max_value)
+ *
+ * @param matrix matrix to randomize
+ * @param min_value lower end of the value interval
+ * @param max_value upper end of the value interval
+ */
+void randomize_matrix(stencil_matrix_t* matrix, int min_value, int max_value);
+
 /**
  * writes the matrix \a matrix to the csv file \a filepath
+ * ("%.3f;" per value, formatted in parallel, see stencil_csv_write)
  *
  * @param matrix matrix to write
  * @param filepath file name
@@ -42,6 +55,29 @@ stencil_matrix_t* new_randomized_matrix(size_t rows, size_t cols, size_t boundar
  */
 bool matrix_to_file(const stencil_matrix_t* matrix, FILE *stream);
 
+/**
+ * writes the matrix \a matrix as compressed snapshot to \a stream
+ * (byte-shuffled blocks of rows compressed in parallel, see stencil_snapshot_write),
+ * the snapshot is read by new_matrix_from_file
+ *
+ * @param matrix matrix to write
+ * @param stream output stream
+ *
+ * @return returns true if the matrix was written successfully
+ */
+bool matrix_to_snapshot(const stencil_matrix_t* matrix, FILE *stream);
+
+/**
+ * splits \a size rows (or columns) into \a parts parts which differ by at most one,
+ * the first size % parts parts get one more
+ *
+ * @param part index of the part
+ * @param first receives the first row of the part (relative to the first row)
+ *
+ * @return returns the number of rows of the part
+ */
+size_t partition_range(size_t size, size_t parts, size_t part, size_t *first);
+
 /**
  * @return returns the current time in msec
  */
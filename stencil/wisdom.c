@@ -0,0 +1,190 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "wisdom.h"
+
+#define TMP_SUFFIX ".XXXXXX" // template of mkstemp
+#define LINE_SIZE 256
+
+size_t stencil_wisdom_class(size_t size)
+{
+    size_t size_class = 0;
+    while (size > 1) {
+        size >>= 1;
+        size_class++;
+    }
+    return size_class;
+}
+
+/**
+ * @return returns the entry of the class, NULL if there is none
+ */
+static stencil_wisdom_entry_t *find_entry(const stencil_wisdom_t *wisdom, size_t rows_class, size_t cols_class,
+                                          int threads)
+{
+    for (size_t i = 0; i < wisdom->count; i++) {
+        stencil_wisdom_entry_t *entry = &wisdom->entries[i];
+        if (entry->rows_class == rows_class && entry->cols_class == cols_class && entry->threads == threads) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Adds or replaces the entry of the class of \a entry.
+ *
+ * @return returns false if the entry cannot be allocated
+ */
+static bool put_entry(stencil_wisdom_t *wisdom, const stencil_wisdom_entry_t *entry)
+{
+    stencil_wisdom_entry_t *existing = find_entry(wisdom, entry->rows_class, entry->cols_class, entry->threads);
+    if (existing != NULL) {
+        *existing = *entry;
+        return true;
+    }
+
+    if (wisdom->count == wisdom->capacity) {
+        const size_t capacity = (wisdom->capacity > 0) ? 2 * wisdom->capacity : 16;
+        stencil_wisdom_entry_t *entries =
+            (stencil_wisdom_entry_t *)realloc(wisdom->entries, capacity * sizeof(stencil_wisdom_entry_t));
+        if (entries == NULL) {
+            return false;
+        }
+        wisdom->entries = entries;
+        wisdom->capacity = capacity;
+    }
+
+    wisdom->entries[wisdom->count++] = *entry;
+    return true;
+}
+
+stencil_wisdom_t *stencil_wisdom_load(const char *filepath)
+{
+    stencil_wisdom_t *wisdom = (stencil_wisdom_t *)malloc(sizeof(stencil_wisdom_t));
+    if (!wisdom) {
+        goto exit_wisdom;
+    }
+
+    wisdom->filepath = strdup(filepath);
+    if (!wisdom->filepath) {
+        goto exit_filepath;
+    }
+    wisdom->count = 0;
+    wisdom->capacity = 0;
+    wisdom->entries = NULL;
+
+    FILE *stream = fopen(filepath, "r");
+    if (stream == NULL) {
+        return wisdom; // no wisdom yet
+    }
+
+    char line[LINE_SIZE];
+    while (fgets(line, sizeof(line), stream) != NULL) {
+        if (line[0] == '#') {
+            continue;
+        }
+
+        stencil_wisdom_entry_t entry;
+        if (sscanf(line, "%zu %zu %d %31s %d %lf", &entry.rows_class, &entry.cols_class, &entry.threads,
+                   entry.variant, &entry.param, &entry.time) != 6) {
+            continue;
+        }
+        if (!put_entry(wisdom, &entry)) {
+            goto exit_entries;
+        }
+    }
+    fclose(stream);
+
+    return wisdom;
+
+exit_entries:
+    fclose(stream);
+    free(wisdom->entries);
+    free(wisdom->filepath);
+exit_filepath:
+    free(wisdom);
+exit_wisdom:
+    return NULL;
+}
+
+bool stencil_wisdom_save(const stencil_wisdom_t *wisdom)
+{
+    char *tmp_filepath = (char *)malloc(strlen(wisdom->filepath) + sizeof(TMP_SUFFIX));
+    if (tmp_filepath == NULL) {
+        return false;
+    }
+    strcpy(tmp_filepath, wisdom->filepath);
+    strcat(tmp_filepath, TMP_SUFFIX);
+
+    // a unique file next to the wisdom file, concurrent runs do not write the same one
+    const int fd = mkstemp(tmp_filepath);
+    if (fd < 0) {
+        free(tmp_filepath);
+        return false;
+    }
+
+    bool written = false;
+    FILE *stream = (fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) == 0) ? fdopen(fd, "w") : NULL;
+    if (stream != NULL) {
+        written = (fprintf(stream, "# rows_class cols_class threads variant param time\n") > 0);
+        for (size_t i = 0; i < wisdom->count && written; i++) {
+            const stencil_wisdom_entry_t *entry = &wisdom->entries[i];
+            written = (fprintf(stream, "%zu %zu %d %s %d %f\n", entry->rows_class, entry->cols_class,
+                               entry->threads, entry->variant, entry->param, entry->time) > 0);
+        }
+        // the content is on the disk before the file replaces the old one
+        written = written && (fflush(stream) == 0) && (fsync(fd) == 0);
+        written = (fclose(stream) == 0) && written;
+    } else {
+        close(fd);
+    }
+
+    // the rename is atomic, concurrent runs never read a partial file
+    written = written && (rename(tmp_filepath, wisdom->filepath) == 0);
+    if (!written) {
+        unlink(tmp_filepath);
+    }
+
+    free(tmp_filepath);
+    return written;
+}
+
+void stencil_wisdom_free(stencil_wisdom_t *wisdom)
+{
+    if (!wisdom) {
+        return;
+    }
+
+    free(wisdom->entries);
+    free(wisdom->filepath);
+    free(wisdom);
+}
+
+const stencil_wisdom_entry_t *stencil_wisdom_lookup(const stencil_wisdom_t *wisdom, size_t rows, size_t cols,
+                                                    int threads)
+{
+    return find_entry(wisdom, stencil_wisdom_class(rows), stencil_wisdom_class(cols), threads);
+}
+
+bool stencil_wisdom_store(stencil_wisdom_t *wisdom, size_t rows, size_t cols, int threads, const char *variant,
+                          int param, double time)
+{
+    if (strlen(variant) >= STENCIL_WISDOM_VARIANT_SIZE || strchr(variant, ' ') != NULL) {
+        return false;
+    }
+
+    stencil_wisdom_entry_t entry;
+    entry.rows_class = stencil_wisdom_class(rows);
+    entry.cols_class = stencil_wisdom_class(cols);
+    entry.threads = threads;
+    strcpy(entry.variant, variant);
+    entry.param = param;
+    entry.time = time;
+
+    return put_entry(wisdom, &entry);
+}
@@ -0,0 +1,79 @@
+#ifndef __STENCIL_WISDOM_H
+#define __STENCIL_WISDOM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define STENCIL_WISDOM_VARIANT_SIZE 32
+
+/**
+ * Fastest variant of a class of problems, the class is given by the number of threads
+ * and the sizes of the matrix rounded down to a power of two (see stencil_wisdom_class).
+ */
+struct stencil_wisdom_entry {
+    size_t rows_class;
+    size_t cols_class;
+    int threads;
+    char variant[STENCIL_WISDOM_VARIANT_SIZE]; // name of the variant (without spaces)
+    int param; // parameter of the variant (e.g. the partitioning), 0 if it has none
+    double time; // measured time of the variant in msec
+};
+typedef struct stencil_wisdom_entry stencil_wisdom_entry_t;
+
+/**
+ * Wisdom of a backend: the fastest variant per class of problems, measured once and
+ * kept in a text file with one entry per line
+ *
+ *   <rows class> <cols class> <threads> <variant> <param> <time>
+ *
+ * (lines starting with # are comments), thus later runs dispatch to the variant without
+ * measuring it again. Lines which cannot be parsed are ignored.
+ */
+struct stencil_wisdom {
+    char *filepath;
+    size_t count;
+    size_t capacity;
+    stencil_wisdom_entry_t *entries;
+};
+typedef struct stencil_wisdom stencil_wisdom_t;
+
+/**
+ * @return returns the class of the size \a size (log2 of size rounded down)
+ */
+size_t stencil_wisdom_class(size_t size);
+
+/**
+ * Loads the wisdom file \a filepath, a file which does not exist yet is empty wisdom.
+ *
+ * @return A pointer to the wisdom, NULL on failure
+ */
+stencil_wisdom_t *stencil_wisdom_load(const char *filepath);
+
+/**
+ * Writes all entries of \a wisdom to its file (written to a unique temporary file next
+ * to it, synced and renamed afterwards, thus the file is always complete and concurrent
+ * runs do not interfere; the last rename wins).
+ *
+ * @return returns true if the wisdom was written successfully
+ */
+bool stencil_wisdom_save(const stencil_wisdom_t *wisdom);
+
+void stencil_wisdom_free(stencil_wisdom_t *wisdom);
+
+/**
+ * @return returns the entry of the class of a \a rows x \a cols matrix and \a threads
+ *         threads, NULL if there is none
+ */
+const stencil_wisdom_entry_t *stencil_wisdom_lookup(const stencil_wisdom_t *wisdom, size_t rows, size_t cols,
+                                                    int threads);
+
+/**
+ * Adds the entry for the class of a \a rows x \a cols matrix and \a threads threads or
+ * replaces it (the file is not written, see stencil_wisdom_save).
+ *
+ * @return returns false if the variant name is too long or the entry cannot be allocated
+ */
+bool stencil_wisdom_store(stencil_wisdom_t *wisdom, size_t rows, size_t cols, int threads, const char *variant,
+                          int param, double time);
+
+#endif // __STENCIL_WISDOM_H
@@ -13,6 +13,10 @@
 
 #define BENCHMARK_ITERATIONS 30
 
+//#define STENCIL_TRAPEZOID
+//#define STENCIL_CONVERGENCE
+//#define STENCIL_FLOAT
+
 int main(int argc, char **argv)
 {
     if (argc < 5) {
@@ -25,16 +29,49 @@ int main(int argc, char **argv)
 
     __cilkrts_set_param("nworkers", argv[4]);
 
-    stencil_matrix_t *matrix = new_randomized_matrix(rows, cols, 1, 0, 100);
+#if defined(STENCIL_CONVERGENCE)
+    // tolerance 0 (all iterations are done), measures the overhead of the residual checks
+    size_t check_interval = (argc > 5) ? strtol(argv[5], NULL, 10) : STENCIL_CONVERGENCE_CHECK_INTERVAL;
+    stencil_convergence_t convergence;
+#elif defined(STENCIL_FLOAT)
+    // "mixed" calculates in double precision, the matrix is stored in single precision
+    stencil_precision_t precision = (argc > 5 && strcmp(argv[5], "mixed") == 0) ? STENCIL_PRECISION_MIXED
+                                                                              : STENCIL_PRECISION_SINGLE;
+#endif
+
+    stencil_matrix_t *matrix = stencil_matrix_new(rows, cols, 1);
     if (matrix == NULL) {
         return EXIT_FAILURE;
     }
+    // the workers place the pages (STENCIL_NUMA=first-touch) before they are initialized
+    cilk_first_touch_matrix(matrix);
+    randomize_matrix(matrix, 0, 100);
+
+    // the page and NUMA policy which took effect (STENCIL_PAGES=normal|transparent|huge)
+    fprintf(stderr, "pages: %s\n", stencil_pages_name(matrix->pages));
+    stencil_matrix_numa_report(matrix, stderr);
+#if defined(STENCIL_FLOAT)
+    stencil_matrix_float_t *matrix_float = stencil_matrix_float_from_matrix(matrix);
+    if (matrix_float == NULL) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+#endif
 
     double min = DBL_MAX;
     double max = DBL_MIN;
     double sum = 0.0;
     for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+#if defined(STENCIL_TRAPEZOID)
+        const double elapsed_time = cilk_stencil_trapezoid(matrix, iterations);
+#elif defined(STENCIL_CONVERGENCE)
+        stencil_convergence_init(&convergence, STENCIL_NORM_MAX, 0.0, check_interval, iterations);
+        const double elapsed_time = cilk_stencil_until_converged(matrix, &convergence);
+#elif defined(STENCIL_FLOAT)
+        const double elapsed_time = cilk_stencil_float(matrix_float, iterations, precision);
+#else
         const double elapsed_time = cilk_stencil_one_vector_tld(matrix, iterations);
+#endif
         min = fmin(min, elapsed_time);
         max = fmax(max, elapsed_time);
         sum += elapsed_time;
@@ -43,6 +80,9 @@ int main(int argc, char **argv)
     const double avg = sum / BENCHMARK_ITERATIONS;
     fprintf(stdout, "%f;%f;%f", min, avg, max);
 
+#if defined(STENCIL_FLOAT)
+    stencil_matrix_float_free(matrix_float);
+#endif
     stencil_matrix_free(matrix);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
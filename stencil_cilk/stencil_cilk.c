@@ -8,24 +8,74 @@
 
 #include <cilk/cilk.h>
 #include <cilk/cilk_api.h>
+#include <cilk/reducer_max.h>
+#include <cilk/reducer_opadd.h>
 
+#include "stencil/kernel.h"
+#include "stencil/descriptor.h"
+#include "stencil/convergence.h"
+#include "stencil/checkpoint.h"
 #include "stencil_cilk.h"
 
-inline double stencil_five_point_kernel(const stencil_matrix_t *const matrix, size_t row, size_t col)
+void cilk_first_touch_matrix(stencil_matrix_t *matrix)
 {
-    return (stencil_matrix_get(matrix, row - 1, col) +
-            stencil_matrix_get(matrix, row, col - 1) +
-            stencil_matrix_get(matrix, row, col + 1) +
-            stencil_matrix_get(matrix, row + 1, col)) * 0.25;
+    const size_t rows = matrix->rows - matrix->boundary;
+
+    // same loop as the calculation (the workers get chunks of rows)
+    cilk_for (size_t row = matrix->boundary; row < rows; row++) {
+        memset(stencil_matrix_get_ptr(matrix, row, 0), 0, matrix->stride * sizeof(double));
+    }
+
+    for (size_t row = 0; row < matrix->boundary; row++) {
+        memset(stencil_matrix_get_ptr(matrix, row, 0), 0, matrix->stride * sizeof(double));
+        memset(stencil_matrix_get_ptr(matrix, rows + row, 0), 0, matrix->stride * sizeof(double));
+    }
 }
 
-static void five_point_stencil_for_row(const stencil_matrix_t *matrix, const stencil_vector_t *vector, const size_t row)
+/**
+ * @return returns a copy of matrix \a matrix which is first touched (copied) by the
+ *         workers, NULL on failure
+ */
+static stencil_matrix_t *first_touch_copy(const stencil_matrix_t *matrix)
 {
-    const size_t cols = matrix->cols - matrix->boundary;
+    stencil_matrix_t *copy = stencil_matrix_new(matrix->rows, matrix->cols, matrix->boundary);
+    if (!copy) {
+        return NULL;
+    }
+
+    const size_t rows = matrix->rows - matrix->boundary;
 
-    for (size_t col = matrix->boundary; col < cols; col++) {
-        stencil_vector_set(vector, col, stencil_five_point_kernel(matrix, row, col));
+    cilk_for (size_t row = matrix->boundary; row < rows; row++) {
+        memcpy(stencil_matrix_get_ptr(copy, row, 0), stencil_matrix_get_ptr(matrix, row, 0),
+               matrix->cols * sizeof(double));
     }
+
+    for (size_t row = 0; row < matrix->boundary; row++) {
+        memcpy(stencil_matrix_get_ptr(copy, row, 0), stencil_matrix_get_ptr(matrix, row, 0),
+               matrix->cols * sizeof(double));
+        memcpy(stencil_matrix_get_ptr(copy, rows + row, 0), stencil_matrix_get_ptr(matrix, rows + row, 0),
+               matrix->cols * sizeof(double));
+    }
+
+    return copy;
+}
+
+static void five_point_stencil_for_row(const stencil_matrix_t *matrix, const stencil_vector_t *vector, const size_t row)
+{
+    stencil_five_point_row(stencil_vector_get_ptr(vector, matrix->boundary),
+                           stencil_matrix_get_ptr(matrix, row - 1, matrix->boundary),
+                           stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                           stencil_matrix_get_ptr(matrix, row + 1, matrix->boundary),
+                           matrix->cols - 2 * matrix->boundary);
+}
+
+static void five_point_stencil_for_row_one_vector(const stencil_matrix_t *matrix, const stencil_vector_t *vector, const size_t row)
+{
+    stencil_five_point_row_one_vector(stencil_matrix_get_ptr(matrix, row - 1, matrix->boundary),
+                                      stencil_vector_get_ptr(vector, matrix->boundary),
+                                      stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                      stencil_matrix_get_ptr(matrix, row + 1, matrix->boundary),
+                                      matrix->cols - 2 * matrix->boundary);
 }
 
 static void five_point_stencil_with_tmp_matrix(stencil_matrix_t *matrix, const size_t start_row, const size_t rows)
@@ -35,14 +85,17 @@ static void five_point_stencil_with_tmp_matrix(stencil_matrix_t *matrix, const s
     }
 
     const size_t end_row = start_row + rows;
-    const size_t cols = matrix->cols - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
 
     stencil_matrix_t *tmp_matrix = stencil_matrix_get_submatrix(matrix, start_row - 1, 0, rows + 2, matrix->cols, 0);
 
     for (size_t row = start_row; row < end_row; row++) {
-        for (size_t col = matrix->boundary; col < cols; col++) {
-            stencil_matrix_set(matrix, row, col, stencil_five_point_kernel(tmp_matrix, row - start_row + 1, col));
-        }
+        const size_t tmp_row = row - start_row + 1;
+        stencil_five_point_row(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                               stencil_matrix_get_ptr(tmp_matrix, tmp_row - 1, matrix->boundary),
+                               stencil_matrix_get_ptr(tmp_matrix, tmp_row, matrix->boundary),
+                               stencil_matrix_get_ptr(tmp_matrix, tmp_row + 1, matrix->boundary),
+                               cols);
     }
 
     stencil_matrix_free(tmp_matrix);
@@ -55,7 +108,6 @@ static void five_point_stencil_with_two_vectors(stencil_matrix_t *matrix, const
     }
 
     const size_t end_row = start_row + rows;
-    const size_t cols = matrix->cols - matrix->boundary;
 
     stencil_vector_t *above = stencil_vector_new(matrix->cols);
     stencil_vector_t *current = stencil_vector_new(matrix->cols);
@@ -65,10 +117,7 @@ static void five_point_stencil_with_two_vectors(stencil_matrix_t *matrix, const
 
     // calculate the remaining rows
     for (size_t row = start_row + 1; row < end_row; row++) {
-        for (size_t col = matrix->boundary; col < cols; col++) {
-            const double value = stencil_five_point_kernel(matrix, row, col);
-            stencil_vector_set(current, col, value);
-        }
+        five_point_stencil_for_row(matrix, current, row);
 
         stencil_matrix_set_row(matrix, row - 1, above);
         stencil_vector_t *tmp = above;
@@ -89,21 +138,15 @@ static void five_point_stencil_with_one_vector(stencil_matrix_t *matrix, const s
         return;
     }
 
-    const size_t cols = matrix->cols - matrix->boundary;
     const size_t end_row = start_row + rows;
 
     // calculate first row
     stencil_vector_t *tmp = stencil_vector_new(matrix->cols);
     five_point_stencil_for_row(matrix, tmp, start_row);
 
-    // calculate the remaining rows
+    // calculate the remaining rows (copies back the previously calculated row)
     for (size_t row = start_row + 1; row < end_row; row++) {
-        for (size_t col = matrix->boundary; col < cols; col++) {
-            const double value = stencil_five_point_kernel(matrix, row, col);
-            // copy back the previosly calculated value before we overwrite it
-            stencil_matrix_set(matrix, row - 1, col, stencil_vector_get(tmp, col));
-            stencil_vector_set(tmp, col, value);
-        }
+        five_point_stencil_for_row_one_vector(matrix, tmp, row);
     }
     // copy back the last row
     stencil_matrix_set_row(matrix, end_row - 1, tmp);
@@ -172,7 +215,6 @@ stencil_sequential_node(const size_t workers, const size_t worker, stencil_matri
     // tmp row vector
     stencil_vector_t *tmp = stencil_vector_new(matrix->cols);
 
-    const size_t cols = submatrix->cols - submatrix->boundary;
     const size_t end_row = rows - 1;
 
     for (size_t iteration = 1; iteration <= iterations; iteration++) {
@@ -200,14 +242,9 @@ stencil_sequential_node(const size_t workers, const size_t worker, stencil_matri
         // calculate first row
         five_point_stencil_for_row(submatrix, tmp, 1);
 
-        // calculate the remaining rows
+        // calculate the remaining rows (copies back the previously calculated row)
         for (size_t row = 2; row < end_row; row++) {
-            for (size_t col = matrix->boundary; col < cols; col++) {
-                const double value = stencil_five_point_kernel(submatrix, row, col);
-                // copy back the previosly calculated value before we overwrite it
-                stencil_matrix_set(submatrix, row - 1, col, stencil_vector_get(tmp, col));
-                stencil_vector_set(tmp, col, value);
-            }
+            five_point_stencil_for_row_one_vector(submatrix, tmp, row);
         }
         // copy back the last row
         stencil_matrix_set_row(submatrix, end_row - 1, tmp);
@@ -261,4 +298,416 @@ double cilk_stencil_two_vectors(stencil_matrix_t *matrix, const size_t iteration
 double cilk_stencil_tmp_matrix(stencil_matrix_t *matrix, const size_t iterations)
 {
     return run_parallel(matrix, iterations, five_point_stencil_with_tmp_matrix);
-}
\ No newline at end of file
+}
+
+#define TRAPEZOID_SLOPE 1
+#define TRAPEZOID_MIN_ROWS 16
+#define TRAPEZOID_MIN_COLS 256
+
+/**
+ * A trapezoid in space-time: the time steps [t0, t1[ of the rows [r0, r1[ and
+ * cols [c0, c1[ (at time t0). The edges move by dr0, dr1, dc0 and dc1 per time step.
+ */
+struct trapezoid {
+    size_t t0, t1;
+    long r0, dr0, r1, dr1;
+    long c0, dc0, c1, dc1;
+};
+
+/**
+ * Calculates all points of the trapezoid \a z time step by time step. The values
+ * of time step t are stored in buffers[t % 2].
+ */
+static void trapezoid_base(stencil_matrix_t *const buffers[2], const struct trapezoid z)
+{
+    for (size_t t = z.t0; t < z.t1; t++) {
+        const long dt = t - z.t0;
+        const stencil_matrix_t *src = buffers[t & 1];
+        stencil_matrix_t *dest = buffers[(t + 1) & 1];
+
+        const long r1 = z.r1 + z.dr1 * dt;
+        const long c0 = z.c0 + z.dc0 * dt;
+        const long c1 = z.c1 + z.dc1 * dt;
+        if (c1 <= c0) {
+            continue;
+        }
+
+        for (long row = z.r0 + z.dr0 * dt; row < r1; row++) {
+            stencil_five_point_row(stencil_matrix_get_ptr(dest, row, c0),
+                                   stencil_matrix_get_ptr(src, row - 1, c0),
+                                   stencil_matrix_get_ptr(src, row, c0),
+                                   stencil_matrix_get_ptr(src, row + 1, c0),
+                                   c1 - c0);
+        }
+    }
+}
+
+/**
+ * Frigo-Strumpen style cache oblivious walk over the trapezoid \a z.
+ *
+ * Wide trapezoids are cut in space into three pieces: an upright trapezoid is cut into
+ * two upright trapezoids (calculated in parallel) followed by an inverted one in the
+ * middle, an inverted trapezoid into an upright one in the middle followed by two
+ * inverted ones (calculated in parallel). Trapezoids which are too narrow to be cut
+ * in space are cut in time, small ones are calculated directly.
+ */
+static void trapezoid_walk(stencil_matrix_t *const buffers[2], const struct trapezoid z)
+{
+    const long dt = z.t1 - z.t0;
+    const long s = TRAPEZOID_SLOPE;
+
+    const long rows_bottom = z.r1 - z.r0;
+    const long rows_top = (z.r1 + z.dr1 * dt) - (z.r0 + z.dr0 * dt);
+    const long cols_bottom = z.c1 - z.c0;
+    const long cols_top = (z.c1 + z.dc1 * dt) - (z.c0 + z.dc0 * dt);
+
+    // space cut (rows)
+    if ((rows_bottom + rows_top) >= 4 * TRAPEZOID_MIN_ROWS) {
+        if (rows_bottom >= rows_top && rows_bottom >= 4 * s * dt) {
+            const long rm = z.r0 + rows_bottom / 2;
+            struct trapezoid left = z, right = z, middle = z;
+            left.r1 = rm;
+            left.dr1 = -s;
+            right.r0 = rm;
+            right.dr0 = s;
+            middle.r0 = middle.r1 = rm;
+            middle.dr0 = -s;
+            middle.dr1 = s;
+
+            cilk_spawn trapezoid_walk(buffers, left);
+            trapezoid_walk(buffers, right);
+            cilk_sync;
+            trapezoid_walk(buffers, middle);
+            return;
+        } else if (rows_bottom < rows_top && rows_bottom >= 2 * s * dt) {
+            struct trapezoid left = z, right = z, middle = z;
+            middle.dr0 = s;
+            middle.dr1 = -s;
+            left.r1 = z.r0;
+            left.dr1 = s;
+            right.r0 = z.r1;
+            right.dr0 = -s;
+
+            trapezoid_walk(buffers, middle);
+            cilk_spawn trapezoid_walk(buffers, left);
+            trapezoid_walk(buffers, right);
+            cilk_sync;
+            return;
+        }
+    }
+
+    // space cut (cols)
+    if ((cols_bottom + cols_top) >= 4 * TRAPEZOID_MIN_COLS) {
+        if (cols_bottom >= cols_top && cols_bottom >= 4 * s * dt) {
+            const long cm = z.c0 + cols_bottom / 2;
+            struct trapezoid left = z, right = z, middle = z;
+            left.c1 = cm;
+            left.dc1 = -s;
+            right.c0 = cm;
+            right.dc0 = s;
+            middle.c0 = middle.c1 = cm;
+            middle.dc0 = -s;
+            middle.dc1 = s;
+
+            cilk_spawn trapezoid_walk(buffers, left);
+            trapezoid_walk(buffers, right);
+            cilk_sync;
+            trapezoid_walk(buffers, middle);
+            return;
+        } else if (cols_bottom < cols_top && cols_bottom >= 2 * s * dt) {
+            struct trapezoid left = z, right = z, middle = z;
+            middle.dc0 = s;
+            middle.dc1 = -s;
+            left.c1 = z.c0;
+            left.dc1 = s;
+            right.c0 = z.c1;
+            right.dc0 = -s;
+
+            trapezoid_walk(buffers, middle);
+            cilk_spawn trapezoid_walk(buffers, left);
+            trapezoid_walk(buffers, right);
+            cilk_sync;
+            return;
+        }
+    }
+
+    // time cut (only if the trapezoid doesn't fit into the cache anyway)
+    const bool is_small = (rows_bottom + rows_top) < 4 * TRAPEZOID_MIN_ROWS &&
+                          (cols_bottom + cols_top) < 4 * TRAPEZOID_MIN_COLS;
+    if (dt > 1 && !is_small) {
+        const long half = dt / 2;
+        struct trapezoid bottom = z, top = z;
+        bottom.t1 = z.t0 + half;
+        top.t0 = z.t0 + half;
+        top.r0 = z.r0 + z.dr0 * half;
+        top.r1 = z.r1 + z.dr1 * half;
+        top.c0 = z.c0 + z.dc0 * half;
+        top.c1 = z.c1 + z.dc1 * half;
+
+        trapezoid_walk(buffers, bottom);
+        trapezoid_walk(buffers, top);
+        return;
+    }
+
+    trapezoid_base(buffers, z);
+}
+
+double cilk_stencil_trapezoid(stencil_matrix_t *matrix, const size_t iterations)
+{
+    assert(matrix->boundary >= 1);
+
+    stencil_matrix_t *tmp_matrix = first_touch_copy(matrix);
+    stencil_matrix_t *const buffers[2] = {matrix, tmp_matrix};
+
+    // the boundary never changes, thus its edges are vertical
+    const struct trapezoid domain = {
+        .t0 = 0, .t1 = iterations,
+        .r0 = matrix->boundary, .dr0 = 0, .r1 = matrix->rows - matrix->boundary, .dr1 = 0,
+        .c0 = matrix->boundary, .dc0 = 0, .c1 = matrix->cols - matrix->boundary, .dc1 = 0,
+    };
+
+    double t1 = get_time();
+
+    trapezoid_walk(buffers, domain);
+
+    double t2 = get_time();
+
+    // the last time step is stored in the tmp matrix
+    if (iterations % 2 != 0) {
+        stencil_matrix_set_submatrix(matrix, matrix->boundary, matrix->boundary, tmp_matrix);
+    }
+
+    stencil_matrix_free(tmp_matrix);
+
+    return t2 - t1;
+}
+
+double cilk_stencil_descriptor(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor, const size_t iterations)
+{
+    assert(matrix->boundary >= descriptor->radius);
+
+    stencil_matrix_t *tmp_matrix = first_touch_copy(matrix);
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    double t1 = get_time();
+
+    for (size_t iteration = 1; iteration <= iterations; iteration++) {
+        cilk_for (size_t row = matrix->boundary; row < rows; row++) {
+            stencil_descriptor_row(descriptor, stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                   tmp_matrix, row, matrix->boundary, cols);
+        }
+
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    }
+
+    double t2 = get_time();
+
+    if (iterations % 2 != 0) {
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    } else {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_copy_values(matrix, tmp_matrix);
+    }
+
+    stencil_matrix_free(tmp_matrix);
+
+    return t2 - t1;
+}
+
+double cilk_stencil_checkpoint(stencil_matrix_t *matrix, const size_t iterations, stencil_checkpoint_t *checkpoint)
+{
+    assert(matrix->boundary >= 1);
+
+    stencil_matrix_t *tmp_matrix = first_touch_copy(matrix);
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+    const size_t first = checkpoint->iteration + 1;
+    const size_t count = (iterations >= first) ? iterations - first + 1 : 0;
+
+    double t1 = get_time();
+
+    for (size_t iteration = first; iteration <= iterations; iteration++) {
+        cilk_for (size_t row = matrix->boundary; row < rows; row++) {
+            stencil_five_point_row(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                   cols);
+        }
+
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+
+        // the tmp matrix holds the values of this iteration
+        if (stencil_checkpoint_is_due(checkpoint, iteration)) {
+            stencil_checkpoint_take(checkpoint, tmp_matrix, iteration);
+        }
+    }
+
+    double t2 = get_time();
+
+    if (count % 2 != 0) {
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    } else {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_copy_values(matrix, tmp_matrix);
+    }
+
+    stencil_matrix_free(tmp_matrix);
+
+    return t2 - t1;
+}
+
+/**
+ * One iteration from \a tmp_matrix to \a matrix, the partial residuals of the rows
+ * are collected with a reducer.
+ */
+static double five_point_iteration_with_residual(stencil_matrix_t *matrix, const stencil_matrix_t *tmp_matrix,
+                                                 stencil_norm_t norm)
+{
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    double residual;
+
+    if (norm == STENCIL_NORM_MAX) {
+        CILK_C_REDUCER_MAX(residual_max, double, 0.0);
+        CILK_C_REGISTER_REDUCER(residual_max);
+
+        cilk_for (size_t row = matrix->boundary; row < rows; row++) {
+            const double row_residual =
+                stencil_five_point_row_residual(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                                stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                                stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                                stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                                cols, norm);
+            CILK_C_REDUCER_MAX_CALC(residual_max, row_residual);
+        }
+
+        CILK_C_UNREGISTER_REDUCER(residual_max);
+        residual = residual_max.value;
+    } else {
+        CILK_C_REDUCER_OPADD(residual_sum, double, 0.0);
+        CILK_C_REGISTER_REDUCER(residual_sum);
+
+        cilk_for (size_t row = matrix->boundary; row < rows; row++) {
+            REDUCER_VIEW(residual_sum) +=
+                stencil_five_point_row_residual(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                                stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                                stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                                stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                                cols, norm);
+        }
+
+        CILK_C_UNREGISTER_REDUCER(residual_sum);
+        residual = residual_sum.value;
+    }
+
+    return residual;
+}
+
+double cilk_stencil_until_converged(stencil_matrix_t *matrix, stencil_convergence_t *convergence)
+{
+    assert(matrix->boundary >= 1);
+
+    stencil_matrix_t *tmp_matrix = first_touch_copy(matrix);
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    size_t iterations = 0;
+
+    double t1 = get_time();
+
+    while (iterations < convergence->max_iterations) {
+        const size_t iteration = ++iterations;
+
+        bool converged = false;
+        if (stencil_convergence_is_check(convergence, iteration)) {
+            const double residual = five_point_iteration_with_residual(matrix, tmp_matrix, convergence->norm);
+            converged = stencil_convergence_update(convergence, iteration, residual);
+        } else {
+            cilk_for (size_t row = matrix->boundary; row < rows; row++) {
+                stencil_five_point_row(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                       stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                       stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                       stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                       cols);
+            }
+        }
+
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+
+        if (converged) {
+            break;
+        }
+    }
+
+    double t2 = get_time();
+
+    if (iterations % 2 != 0) {
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    } else {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_copy_values(matrix, tmp_matrix);
+    }
+
+    stencil_matrix_free(tmp_matrix);
+
+    return t2 - t1;
+}
+
+double cilk_stencil_float(stencil_matrix_float_t *matrix, const size_t iterations, stencil_precision_t precision)
+{
+    assert(matrix->boundary >= 1);
+
+    stencil_matrix_float_t *tmp_matrix = stencil_matrix_float_copy(matrix);
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    double t1 = get_time();
+
+    for (size_t iteration = 1; iteration <= iterations; iteration++) {
+        cilk_for (size_t row = matrix->boundary; row < rows; row++) {
+            stencil_five_point_row_float(stencil_matrix_float_get_ptr(matrix, row, matrix->boundary),
+                                         stencil_matrix_float_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                         stencil_matrix_float_get_ptr(tmp_matrix, row, matrix->boundary),
+                                         stencil_matrix_float_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                         cols, precision);
+        }
+
+        stencil_matrix_float_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    }
+
+    double t2 = get_time();
+
+    if (iterations % 2 != 0) {
+        stencil_matrix_float_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    } else {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_float_copy_values(matrix, tmp_matrix);
+    }
+
+    stencil_matrix_float_free(tmp_matrix);
+
+    return t2 - t1;
+}
@@ -4,6 +4,17 @@
 #include "stencil/matrix.h"
 #include "stencil/vector.h"
 #include "stencil/util.h"
+#include "stencil/descriptor.h"
+#include "stencil/convergence.h"
+#include "stencil/matrix_float.h"
+#include "stencil/checkpoint.h"
+
+/**
+ * Touches the (not yet initialized) values of matrix \a matrix with the workers (cilk_for over
+ * the rows like the calculation), thus with the first-touch policy the pages are spread over
+ * the NUMA nodes of the workers.
+ */
+void cilk_first_touch_matrix(stencil_matrix_t *matrix);
 
 /**
  * calculates at first the first row of the area which is assigned to each worker
@@ -44,5 +55,58 @@ double cilk_stencil_tmp_matrix(stencil_matrix_t *matrix, const size_t iterations
 
 double cilk_stencil_one_vector_tld(stencil_matrix_t *matrix, const size_t iterations);
 
+/**
+ * cache oblivious trapezoidal space-time recursion (Frigo-Strumpen)
+ * the space-time domain is recursively cut into trapezoids, independent
+ * trapezoids are spawned, thus there is no global barrier per iteration and
+ * several time steps are calculated while the data is in the cache.
+ *
+ * uses a tmp matrix (the time steps alternate between the two matrices)
+ *
+ * @param matrix matrix
+ * @return returns the needed time for the calculation in msec
+ */
+double cilk_stencil_trapezoid(stencil_matrix_t *matrix, const size_t iterations);
+
+/**
+ * applies the stencil described by \a descriptor, the rows are distributed
+ * with cilk_for.
+ *
+ * uses a tmp matrix (the iterations alternate between the two matrices)
+ *
+ * @param matrix matrix (the boundary must be at least as large as the stencil radius)
+ * @param descriptor stencil descriptor
+ * @return returns the needed time for the calculation in msec
+ */
+double cilk_stencil_descriptor(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor, const size_t iterations);
+
+/**
+ * tmp matrix iterations with periodic checkpoints, the rows are distributed with cilk_for
+ * while the background thread of \a checkpoint writes the snapshot.
+ *
+ * @param matrix matrix after checkpoint->iteration iterations (see stencil_checkpoint_restore)
+ * @param iterations total number of iterations (including the restored ones)
+ * @return returns the needed time for the calculation in msec
+ */
+double cilk_stencil_checkpoint(stencil_matrix_t *matrix, const size_t iterations, stencil_checkpoint_t *checkpoint);
+
+/**
+ * tmp matrix iterations until the residual drops below the tolerance, the residual
+ * is collected with a reducer (max or sum) on every check iteration.
+ *
+ * @param matrix matrix
+ * @param convergence convergence parameters, receives the number of iterations and the last residual
+ * @return returns the needed time for the calculation in msec
+ */
+double cilk_stencil_until_converged(stencil_matrix_t *matrix, stencil_convergence_t *convergence);
+
+/**
+ * tmp matrix iterations on a single-precision matrix, the rows are distributed with cilk_for.
+ *
+ * @param matrix matrix
+ * @param precision arithmetic of the kernel (float or double with float storage)
+ * @return returns the needed time for the calculation in msec
+ */
+double cilk_stencil_float(stencil_matrix_float_t *matrix, const size_t iterations, stencil_precision_t precision);
 
 #endif // __STENCIL_CILK_H
\ No newline at end of file
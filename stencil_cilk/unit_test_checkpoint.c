@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <sys/time.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cilk/cilk.h>
+#include <cilk/cilk_api.h>
+
+#include "stencil/util.h"
+#include "stencil_cilk.h"
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stdout, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+    if (matrix == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    // the first run stops after 3 iterations, the second one restarts from its last checkpoint
+    char filepath[] = "unit_test_checkpoint_XXXXXX";
+    close(mkstemp(filepath));
+
+    stencil_checkpoint_t *checkpoint = stencil_checkpoint_new(filepath, 2, 0.0);
+    cilk_stencil_checkpoint(matrix, 3, checkpoint);
+    stencil_checkpoint_free(checkpoint);
+    stencil_matrix_free(matrix);
+
+    checkpoint = stencil_checkpoint_new(filepath, 2, 0.0);
+    matrix = stencil_checkpoint_restore(checkpoint);
+    if (matrix == NULL || checkpoint->iteration != 2) {
+        stencil_checkpoint_free(checkpoint);
+        unlink(filepath);
+        return EXIT_FAILURE;
+    }
+    cilk_stencil_checkpoint(matrix, 5, checkpoint);
+    stencil_checkpoint_free(checkpoint);
+    unlink(filepath);
+
+    matrix_to_file(matrix, stdout);
+
+    stencil_matrix_free(matrix);
+    return EXIT_SUCCESS;
+}
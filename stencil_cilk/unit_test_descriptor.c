@@ -0,0 +1,39 @@
+#include <stdio.h>
+#include <sys/time.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <cilk/cilk.h>
+#include <cilk/cilk_api.h>
+
+#include "stencil/util.h"
+#include "stencil/descriptor.h"
+#include "stencil_cilk.h"
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stdout, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    // five-point stencil using the generic kernel
+    const stencil_point_t points[] = {{-1, 0, 0.25}, {0, -1, 0.25}, {0, 1, 0.25}, {1, 0, 0.25}};
+    stencil_descriptor_t *descriptor = stencil_descriptor_new(4, points);
+    if (descriptor == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+    if (matrix == NULL) {
+        stencil_descriptor_free(descriptor);
+        return EXIT_FAILURE;
+    }
+    cilk_stencil_descriptor(matrix, descriptor, 5);
+    matrix_to_file(matrix, stdout);
+
+    stencil_matrix_free(matrix);
+    stencil_descriptor_free(descriptor);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include <sys/time.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <cilk/cilk.h>
+#include <cilk/cilk_api.h>
+
+#include "stencil/util.h"
+#include "stencil_cilk.h"
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stdout, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+    if (matrix == NULL) {
+        return EXIT_FAILURE;
+    }
+    stencil_matrix_float_t *matrix_float = stencil_matrix_float_from_matrix(matrix);
+    if (matrix_float == NULL) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+    cilk_stencil_float(matrix_float, 5, STENCIL_PRECISION_SINGLE);
+    stencil_matrix_float_to_matrix(matrix_float, matrix);
+    matrix_to_file(matrix, stdout);
+
+    stencil_matrix_float_free(matrix_float);
+    stencil_matrix_free(matrix);
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -18,9 +18,21 @@ int main(int argc, char **argv)
         return EXIT_FAILURE;
     }
 
+#if defined(STENCIL_HYBRID)
+    // only the master thread of the OpenMP teams calls MPI
+    int provided;
+    if (MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided) != MPI_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+    if (provided < MPI_THREAD_FUNNELED) {
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+#else
     if (MPI_Init(&argc, &argv) != MPI_SUCCESS) {
         return EXIT_FAILURE;
     }
+#endif
 
     size_t rows = strtol(argv[1], NULL, 10);
     size_t cols = strtol(argv[2], NULL, 10);
@@ -35,6 +47,8 @@ int main(int argc, char **argv)
             MPI_Finalize();
             return EXIT_FAILURE;
         }
+        // the page policy which took effect (STENCIL_PAGES=normal|transparent|huge)
+        fprintf(stderr, "pages: %s\n", stencil_pages_name(matrix->pages));
 
         double min = DBL_MAX;
         double max = DBL_MIN;
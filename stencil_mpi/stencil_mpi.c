@@ -8,15 +8,26 @@
 
 #include <mpi.h>
 
-#include <stencil/vector.h>
+#include <stencil/descriptor.h>
+#include <stencil/convergence.h>
+#include <stencil/matrix_float.h>
+#include <stencil/kernel.h>
+#include <stencil/binary.h>
+#include <stencil/checkpoint.h>
+#include <stencil/util.h>
 
 #include "stencil_mpi.h"
 
+#if defined(STENCIL_HYBRID)
+#include <omp.h>
+
+#include "stencil_openmp/stencil_openmp.h"
+#endif
+
 #define MASTER 0
 #define DIMENSIONS 2
 #define DIM_HORIZONTAL 0
 #define DIM_VERTICAL 1
-#define STENCIL_BOUNDARY 1
 
 // for cart shifting
 #define DIM_SHIFT_UP (-1)
@@ -34,138 +45,289 @@ enum mpi_tags_t {
     TOP_HALO_TAG,
     BOTTOM_HALO_TAG,
     LEFT_HALO_TAG,
-    RIGHT_HALO_TAG
+    RIGHT_HALO_TAG,
+    SCATTER_TAG,
+    GATHER_TAG
+};
+
+/**
+ * View of a matrix with double (MPI_DOUBLE) or float (MPI_FLOAT) values, exactly
+ * one of matrix and matrix_float is set.
+ */
+struct grid {
+    size_t rows;
+    size_t cols;
+    size_t stride;
+    size_t boundary;
+    void *values;
+    MPI_Datatype element_type;
+    size_t element_size;
+    stencil_matrix_t *matrix;
+    stencil_matrix_float_t *matrix_float;
+};
+
+static struct grid grid_from_matrix(stencil_matrix_t *matrix)
+{
+    const struct grid grid = {
+        .rows = matrix->rows, .cols = matrix->cols, .stride = matrix->stride, .boundary = matrix->boundary, .values = matrix->values,
+        .element_type = MPI_DOUBLE, .element_size = sizeof(double), .matrix = matrix, .matrix_float = NULL
+    };
+    return grid;
+}
+
+static struct grid grid_from_matrix_float(stencil_matrix_float_t *matrix)
+{
+    const struct grid grid = {
+        .rows = matrix->rows, .cols = matrix->cols, .stride = matrix->stride, .boundary = matrix->boundary, .values = matrix->values,
+        .element_type = MPI_FLOAT, .element_size = sizeof(float), .matrix = NULL, .matrix_float = matrix
+    };
+    return grid;
+}
+
+static inline void *grid_get_ptr(const struct grid *grid, size_t row, size_t col)
+{
+    return (char *)grid->values + (row * grid->stride + col) * grid->element_size;
+}
+
+/**
+ * Block of the interior of a matrix calculated by a node, the blocks of the nodes differ
+ * by at most one row and col (see partition_range).
+ */
+struct node_block {
+    size_t first_row; // first interior row of the block (relative to the first interior row)
+    size_t first_col;
+    size_t rows;
+    size_t cols;
 };
 
+/**
+ * @return returns the block of the node at \a coords in the grid of nodes \a dims of a
+ *         \a rows x \a cols matrix with boundary \a boundary
+ */
+static struct node_block node_block(size_t rows, size_t cols, size_t boundary, const int dims[], const int coords[])
+{
+    struct node_block block;
+    block.rows = partition_range(rows - 2 * boundary, dims[DIM_VERTICAL], coords[DIM_VERTICAL], &block.first_row);
+    block.cols = partition_range(cols - 2 * boundary, dims[DIM_HORIZONTAL], coords[DIM_HORIZONTAL],
+                                 &block.first_col);
+    return block;
+}
+
 //#define SENDRECV_BOUNDARY_EXCHANGE
 //#define NONBLOCKING_BOUNDARY_EXCHANGE
 //#define ONESIDED_FENCE_BOUNDARY_EXCHANGE
 //#define ONESIDED_PSCW_BOUNDARY_EXCHANGE
 
-inline double stencil_five_point_kernel(const stencil_matrix_t *const matrix, size_t row, size_t col)
-{
-    return (stencil_matrix_get(matrix, row - 1, col) +
-            stencil_matrix_get(matrix, row, col - 1) +
-            stencil_matrix_get(matrix, row, col + 1) +
-            stencil_matrix_get(matrix, row + 1, col)) * 0.25;
-}
+//#define STENCIL_HYBRID // the nodes calculate their blocks with an OpenMP team
 
-static void exchange_boundary_data_sendrecv(stencil_matrix_t *matrix,
+static void exchange_boundary_data_sendrecv(const struct grid *grid,
                                             int neighbours_source[], int neighbours_dest[],
                                             MPI_Datatype matrix_row_t, MPI_Datatype matrix_col_t,
                                             MPI_Comm comm_card)
 {
     MPI_Status status;
 
-    MPI_Sendrecv(stencil_matrix_get_ptr(matrix, 1, 0), 1, matrix_row_t,
+    const size_t boundary = grid->boundary;
+
+    MPI_Sendrecv(grid_get_ptr(grid, boundary, 0), 1, matrix_row_t,
                  neighbours_dest[NEIGHBOUR_ABOVE], TOP_HALO_TAG,
-                 stencil_matrix_get_ptr(matrix, matrix->rows - 1, 0), 1, matrix_row_t,
+                 grid_get_ptr(grid, grid->rows - boundary, 0), 1, matrix_row_t,
                  neighbours_source[NEIGHBOUR_BELOW], TOP_HALO_TAG, comm_card, &status);
 
-    MPI_Sendrecv(stencil_matrix_get_ptr(matrix, matrix->rows - 2, 0), 1, matrix_row_t,
+    MPI_Sendrecv(grid_get_ptr(grid, grid->rows - 2 * boundary, 0), 1, matrix_row_t,
                  neighbours_dest[NEIGHBOUR_BELOW], BOTTOM_HALO_TAG,
-                 stencil_matrix_get_ptr(matrix, 0, 0), 1, matrix_row_t,
+                 grid_get_ptr(grid, 0, 0), 1, matrix_row_t,
                  neighbours_source[NEIGHBOUR_ABOVE], BOTTOM_HALO_TAG, comm_card, &status);
 
-    MPI_Sendrecv(stencil_matrix_get_ptr(matrix, 0, 1), 1, matrix_col_t,
+    // the columns include the received halo rows, thus the corners are exchanged too
+    MPI_Sendrecv(grid_get_ptr(grid, 0, boundary), 1, matrix_col_t,
                  neighbours_dest[NEIGHBOUR_LEFT], LEFT_HALO_TAG,
-                 stencil_matrix_get_ptr(matrix, 0, matrix->cols - 1), 1, matrix_col_t,
+                 grid_get_ptr(grid, 0, grid->cols - boundary), 1, matrix_col_t,
                  neighbours_source[NEIGHBOUR_RIGHT], LEFT_HALO_TAG, comm_card, &status);
 
-    MPI_Sendrecv(stencil_matrix_get_ptr(matrix, 0, matrix->cols - 2), 1, matrix_col_t,
+    MPI_Sendrecv(grid_get_ptr(grid, 0, grid->cols - 2 * boundary), 1, matrix_col_t,
                  neighbours_dest[NEIGHBOUR_RIGHT], RIGHT_HALO_TAG,
-                 stencil_matrix_get_ptr(matrix, 0, 0), 1, matrix_col_t,
+                 grid_get_ptr(grid, 0, 0), 1, matrix_col_t,
                  neighbours_source[NEIGHBOUR_LEFT], RIGHT_HALO_TAG, comm_card, &status);
 }
 
-static void exchange_boundary_data_nonblocking(stencil_matrix_t *matrix,
+static void exchange_boundary_data_nonblocking(const struct grid *grid,
                                                int neighbours_source[], int neighbours_dest[],
                                                MPI_Datatype matrix_row_t, MPI_Datatype matrix_col_t,
-                                               MPI_Comm comm_card)
+                                               bool corners, MPI_Comm comm_card)
 {
     int req_count = 0;
     MPI_Request reqs[8];
     MPI_Status states[8];
 
+    const size_t boundary = grid->boundary;
+
     if (neighbours_dest[NEIGHBOUR_ABOVE] != NO_NEIGHBOUR) {
-        MPI_Isend(stencil_matrix_get_ptr(matrix, 1, 0), 1, matrix_row_t,
+        MPI_Isend(grid_get_ptr(grid, boundary, 0), 1, matrix_row_t,
                   neighbours_dest[NEIGHBOUR_ABOVE], TOP_HALO_TAG, comm_card, &reqs[req_count++]);
-        MPI_Irecv(stencil_matrix_get_ptr(matrix, 0, 0), 1, matrix_row_t,
+        MPI_Irecv(grid_get_ptr(grid, 0, 0), 1, matrix_row_t,
                   neighbours_source[NEIGHBOUR_ABOVE], BOTTOM_HALO_TAG, comm_card, &reqs[req_count++]);
     }
     if (neighbours_dest[NEIGHBOUR_BELOW] != NO_NEIGHBOUR) {
-        MPI_Isend(stencil_matrix_get_ptr(matrix, matrix->rows - 2, 0), 1, matrix_row_t,
+        MPI_Isend(grid_get_ptr(grid, grid->rows - 2 * boundary, 0), 1, matrix_row_t,
                   neighbours_dest[NEIGHBOUR_BELOW], BOTTOM_HALO_TAG, comm_card, &reqs[req_count++]);
-        MPI_Irecv(stencil_matrix_get_ptr(matrix, matrix->rows - 1, 0), 1, matrix_row_t,
+        MPI_Irecv(grid_get_ptr(grid, grid->rows - boundary, 0), 1, matrix_row_t,
                   neighbours_source[NEIGHBOUR_BELOW], TOP_HALO_TAG, comm_card, &reqs[req_count++]);
     }
+
+    // the corners are part of the halo rows, they have to be received before the columns are sent
+    if (corners) {
+        MPI_Waitall(req_count, reqs, states);
+        req_count = 0;
+    }
+
     if (neighbours_dest[NEIGHBOUR_LEFT] != NO_NEIGHBOUR) {
-        MPI_Isend(stencil_matrix_get_ptr(matrix, 0, 1), 1, matrix_col_t,
+        MPI_Isend(grid_get_ptr(grid, 0, boundary), 1, matrix_col_t,
                   neighbours_dest[NEIGHBOUR_LEFT], LEFT_HALO_TAG, comm_card, &reqs[req_count++]);
-        MPI_Irecv(stencil_matrix_get_ptr(matrix, 0, 0), 1, matrix_col_t,
+        MPI_Irecv(grid_get_ptr(grid, 0, 0), 1, matrix_col_t,
                   neighbours_source[NEIGHBOUR_LEFT], RIGHT_HALO_TAG, comm_card, &reqs[req_count++]);
     }
     if (neighbours_dest[NEIGHBOUR_RIGHT] != NO_NEIGHBOUR) {
-        MPI_Isend(stencil_matrix_get_ptr(matrix, 0, matrix->cols - 2), 1, matrix_col_t,
+        MPI_Isend(grid_get_ptr(grid, 0, grid->cols - 2 * boundary), 1, matrix_col_t,
                   neighbours_dest[NEIGHBOUR_RIGHT], RIGHT_HALO_TAG, comm_card, &reqs[req_count++]);
-        MPI_Irecv(stencil_matrix_get_ptr(matrix, 0, matrix->cols - 1), 1, matrix_col_t,
+        MPI_Irecv(grid_get_ptr(grid, 0, grid->cols - boundary), 1, matrix_col_t,
                   neighbours_source[NEIGHBOUR_RIGHT], LEFT_HALO_TAG, comm_card, &reqs[req_count++]);
     }
 
     MPI_Waitall(req_count, reqs, states);
 }
 
-static void exchange_boundary_data_onesided_fence(stencil_matrix_t *matrix,
+/**
+ * Halo of the neighbours for the one-sided exchange: the displacements (in elements) of
+ * the halo rows and cols the boundary of the node is put to and the column types of the
+ * left and right neighbours, their blocks (and strides) can differ from the block of
+ * the node.
+ */
+struct halo_targets {
+    MPI_Aint displacements[4]; // indexed by NEIGHBOUR_*
+    MPI_Datatype col_types[4]; // NEIGHBOUR_LEFT and NEIGHBOUR_RIGHT
+};
+
+#if (defined(ONESIDED_FENCE_BOUNDARY_EXCHANGE) || defined(ONESIDED_PSCW_BOUNDARY_EXCHANGE))
+static void create_halo_targets(const struct grid *grid, const int neighbours_dest[], struct halo_targets *targets,
+                                MPI_Comm comm_card)
+{
+    int nodes;
+    MPI_Comm_size(comm_card, &nodes);
+
+    unsigned long layout[] = {grid->rows, grid->cols, grid->stride};
+    unsigned long layouts[3 * nodes];
+    MPI_Allgather(layout, 3, MPI_UNSIGNED_LONG, layouts, 3, MPI_UNSIGNED_LONG, comm_card);
+
+    for (int neighbour = 0; neighbour < 4; neighbour++) {
+        const int node = neighbours_dest[neighbour];
+        targets->displacements[neighbour] = 0; // the halo below and right starts at 0
+        targets->col_types[neighbour] = MPI_DATATYPE_NULL;
+        if (node == NO_NEIGHBOUR) {
+            continue;
+        }
+
+        const unsigned long rows = layouts[3 * node];
+        const unsigned long cols = layouts[3 * node + 1];
+        const unsigned long stride = layouts[3 * node + 2];
+        if (neighbour == NEIGHBOUR_ABOVE) {
+            targets->displacements[neighbour] = (rows - grid->boundary) * stride;
+        } else if (neighbour == NEIGHBOUR_LEFT || neighbour == NEIGHBOUR_RIGHT) {
+            if (neighbour == NEIGHBOUR_LEFT) {
+                targets->displacements[neighbour] = cols - grid->boundary;
+            }
+            MPI_Type_vector(rows, grid->boundary, stride, grid->element_type, &targets->col_types[neighbour]);
+            MPI_Type_commit(&targets->col_types[neighbour]);
+        }
+    }
+}
+
+static void free_halo_targets(struct halo_targets *targets)
+{
+    for (int neighbour = 0; neighbour < 4; neighbour++) {
+        if (targets->col_types[neighbour] != MPI_DATATYPE_NULL) {
+            MPI_Type_free(&targets->col_types[neighbour]);
+        }
+    }
+}
+#endif
+
+static void exchange_boundary_data_onesided_fence(const struct grid *grid,
                                                   int neighbours_source[], int neighbours_dest[],
                                                   MPI_Datatype matrix_row_t, MPI_Datatype matrix_col_t,
+                                                  const struct halo_targets *targets, bool corners,
                                                   MPI_Win boundary_window, MPI_Comm comm_card)
 {
+    const size_t boundary = grid->boundary;
+
     MPI_Win_fence(MPI_MODE_NOSTORE, boundary_window);
 
     if (neighbours_dest[NEIGHBOUR_ABOVE] != NO_NEIGHBOUR) {
-        MPI_Put(stencil_matrix_get_ptr(matrix, 1, 0), 1, matrix_row_t, neighbours_dest[NEIGHBOUR_ABOVE],
-                (matrix->rows - 1) * matrix->cols, 1, matrix_row_t, boundary_window);
+        MPI_Put(grid_get_ptr(grid, boundary, 0), 1, matrix_row_t, neighbours_dest[NEIGHBOUR_ABOVE],
+                targets->displacements[NEIGHBOUR_ABOVE], 1, matrix_row_t, boundary_window);
     }
     if (neighbours_dest[NEIGHBOUR_BELOW] != NO_NEIGHBOUR) {
-        MPI_Put(stencil_matrix_get_ptr(matrix, matrix->rows - 2, 0), 1, matrix_row_t, neighbours_dest[NEIGHBOUR_BELOW],
-                0, 1, matrix_row_t, boundary_window);
+        MPI_Put(grid_get_ptr(grid, grid->rows - 2 * boundary, 0), 1, matrix_row_t,
+                neighbours_dest[NEIGHBOUR_BELOW], targets->displacements[NEIGHBOUR_BELOW], 1, matrix_row_t,
+                boundary_window);
+    }
+
+    // the corners are part of the halo rows, they have to be received before the columns are sent
+    if (corners) {
+        MPI_Win_fence(MPI_MODE_NOSTORE, boundary_window);
     }
+
     if (neighbours_dest[NEIGHBOUR_LEFT] != NO_NEIGHBOUR) {
-        MPI_Put(stencil_matrix_get_ptr(matrix, 0, 1), 1, matrix_col_t, neighbours_dest[NEIGHBOUR_LEFT],
-                matrix->cols - 1, 1, matrix_col_t, boundary_window);
+        MPI_Put(grid_get_ptr(grid, 0, boundary), 1, matrix_col_t, neighbours_dest[NEIGHBOUR_LEFT],
+                targets->displacements[NEIGHBOUR_LEFT], 1, targets->col_types[NEIGHBOUR_LEFT], boundary_window);
     }
     if (neighbours_dest[NEIGHBOUR_RIGHT] != NO_NEIGHBOUR) {
-        MPI_Put(stencil_matrix_get_ptr(matrix, 0, matrix->cols - 2), 1, matrix_col_t, neighbours_dest[NEIGHBOUR_RIGHT],
-                0, 1, matrix_col_t, boundary_window);
+        MPI_Put(grid_get_ptr(grid, 0, grid->cols - 2 * boundary), 1, matrix_col_t,
+                neighbours_dest[NEIGHBOUR_RIGHT], targets->displacements[NEIGHBOUR_RIGHT], 1,
+                targets->col_types[NEIGHBOUR_RIGHT], boundary_window);
     }
 
     MPI_Win_fence(MPI_MODE_NOSUCCEED, boundary_window);
 }
 
-static void exchange_boundary_data_onesided_pscw(stencil_matrix_t *matrix,
+static void exchange_boundary_data_onesided_pscw(const struct grid *grid,
                                                  int neighbours_source[], int neighbours_dest[],
                                                  MPI_Datatype matrix_row_t, MPI_Datatype matrix_col_t,
-                                                 MPI_Win boundary_window, MPI_Group group,
-                                                 MPI_Comm comm_card)
+                                                 const struct halo_targets *targets, bool corners,
+                                                 MPI_Win boundary_window, MPI_Group group, MPI_Comm comm_card)
 {
+    const size_t boundary = grid->boundary;
+
     MPI_Win_post(group, MPI_MODE_NOSTORE , boundary_window);
     MPI_Win_start(group, 0, boundary_window);
 
     if (neighbours_dest[NEIGHBOUR_ABOVE] != NO_NEIGHBOUR) {
-        MPI_Put(stencil_matrix_get_ptr(matrix, 1, 0), 1, matrix_row_t, neighbours_dest[NEIGHBOUR_ABOVE],
-                (matrix->rows - 1) * matrix->cols, 1, matrix_row_t, boundary_window);
+        MPI_Put(grid_get_ptr(grid, boundary, 0), 1, matrix_row_t, neighbours_dest[NEIGHBOUR_ABOVE],
+                targets->displacements[NEIGHBOUR_ABOVE], 1, matrix_row_t, boundary_window);
     }
     if (neighbours_dest[NEIGHBOUR_BELOW] != NO_NEIGHBOUR) {
-        MPI_Put(stencil_matrix_get_ptr(matrix, matrix->rows - 2, 0), 1, matrix_row_t, neighbours_dest[NEIGHBOUR_BELOW],
-                0, 1, matrix_row_t, boundary_window);
+        MPI_Put(grid_get_ptr(grid, grid->rows - 2 * boundary, 0), 1, matrix_row_t,
+                neighbours_dest[NEIGHBOUR_BELOW], targets->displacements[NEIGHBOUR_BELOW], 1, matrix_row_t,
+                boundary_window);
     }
+
+    // the corners are part of the halo rows, they have to be received before the columns are sent
+    if (corners) {
+        MPI_Win_complete(boundary_window);
+        MPI_Win_wait(boundary_window);
+
+        MPI_Win_post(group, MPI_MODE_NOSTORE , boundary_window);
+        MPI_Win_start(group, 0, boundary_window);
+    }
+
     if (neighbours_dest[NEIGHBOUR_LEFT] != NO_NEIGHBOUR) {
-        MPI_Put(stencil_matrix_get_ptr(matrix, 0, 1), 1, matrix_col_t, neighbours_dest[NEIGHBOUR_LEFT],
-                matrix->cols - 1, 1, matrix_col_t, boundary_window);
+        MPI_Put(grid_get_ptr(grid, 0, boundary), 1, matrix_col_t, neighbours_dest[NEIGHBOUR_LEFT],
+                targets->displacements[NEIGHBOUR_LEFT], 1, targets->col_types[NEIGHBOUR_LEFT], boundary_window);
     }
     if (neighbours_dest[NEIGHBOUR_RIGHT] != NO_NEIGHBOUR) {
-        MPI_Put(stencil_matrix_get_ptr(matrix, 0, matrix->cols - 2), 1, matrix_col_t, neighbours_dest[NEIGHBOUR_RIGHT],
-                0, 1, matrix_col_t, boundary_window);
+        MPI_Put(grid_get_ptr(grid, 0, grid->cols - 2 * boundary), 1, matrix_col_t,
+                neighbours_dest[NEIGHBOUR_RIGHT], targets->displacements[NEIGHBOUR_RIGHT], 1,
+                targets->col_types[NEIGHBOUR_RIGHT], boundary_window);
     }
 
     MPI_Win_complete(boundary_window);
@@ -193,12 +355,339 @@ static MPI_Group create_mpi_group(MPI_Group world_group, int size, ...)
     return group;
 }
 
-static double sequential_five_point_stencil(stencil_matrix_t *matrix, const size_t iterations, MPI_Comm comm_card)
+/**
+ * @return returns the type of the block of \a rows x \a cols values at (\a row, \a col)
+ *         of the values of the grid file \a header, the file type of the view of a node
+ */
+static MPI_Datatype create_file_block_type(const stencil_binary_header_t *header,
+                                           size_t row, size_t col, size_t rows, size_t cols)
 {
-    assert(matrix->boundary >= 1);
+    const int file_size[] = {header->rows, header->stride}; // the padding is part of the file
+    const int block_size[] = {rows, cols};
+    const int block_position[] = {row, col};
+
+    MPI_Datatype block_type;
+    MPI_Type_create_subarray(DIMENSIONS, file_size, block_size, block_position,
+                             MPI_ORDER_C, MPI_DOUBLE, &block_type);
+    MPI_Type_commit(&block_type);
+
+    return block_type;
+}
 
-    const size_t rows = matrix->rows - matrix->boundary;
-    const size_t cols = matrix->cols - matrix->boundary;
+/**
+ * @return returns the type of the block of \a rows x \a cols values at (\a row, \a col)
+ *         of the node matrix \a matrix
+ */
+static MPI_Datatype create_node_block_type(const struct grid *matrix, size_t row, size_t col, size_t rows, size_t cols)
+{
+    const int matrix_size[] = {matrix->rows, matrix->stride};
+    const int block_size[] = {rows, cols};
+    const int block_position[] = {row, col};
+
+    MPI_Datatype block_type;
+    MPI_Type_create_subarray(DIMENSIONS, matrix_size, block_size, block_position,
+                             MPI_ORDER_C, matrix->element_type, &block_type);
+    MPI_Type_commit(&block_type);
+
+    return block_type;
+}
+
+/**
+ * Creates the types of the values the node at \a coords writes to the grid file \a header:
+ * the block of node matrix \a node_matrix without halo, the nodes at the edges also write
+ * the boundary.
+ */
+static void create_write_block_types(const stencil_binary_header_t *header, const struct grid *node_matrix,
+                                     const int dims[], const int coords[],
+                                     MPI_Datatype *file_block_t, MPI_Datatype *node_block_t)
+{
+    const size_t boundary = node_matrix->boundary;
+    const struct node_block block = node_block(header->rows, header->cols, boundary, dims, coords);
+    const size_t first_row = block.first_row;
+    const size_t first_col = block.first_col;
+
+    const size_t top = (coords[DIM_VERTICAL] == 0) ? 0 : boundary;
+    const size_t bottom = (coords[DIM_VERTICAL] == dims[DIM_VERTICAL] - 1) ? node_matrix->rows
+                                                                           : node_matrix->rows - boundary;
+    const size_t left = (coords[DIM_HORIZONTAL] == 0) ? 0 : boundary;
+    const size_t right = (coords[DIM_HORIZONTAL] == dims[DIM_HORIZONTAL] - 1) ? node_matrix->cols
+                                                                              : node_matrix->cols - boundary;
+
+    *file_block_t = create_file_block_type(header, first_row + top, first_col + left, bottom - top, right - left);
+    *node_block_t = create_node_block_type(node_matrix, top, left, bottom - top, right - left);
+}
+
+/**
+ * Checkpoints of a node (see stencil_mpi_checkpoint_t). A per-rank checkpoint is written
+ * by the background thread of \a checkpoint, a collective one from \a snapshot with
+ * non-blocking collective MPI-IO, which is completed before the next checkpoint is taken.
+ */
+struct node_checkpoint {
+    stencil_checkpoint_t *checkpoint; // parameters and per-rank checkpoints
+    stencil_mpi_checkpoint_t layout;
+    bool stale_halo; // the halo of a restored per-rank checkpoint is out of date
+
+    // collective checkpoints
+    char *tmp_filepath;
+    stencil_binary_header_t header;
+    stencil_matrix_t *snapshot;
+    MPI_Datatype file_block_t;
+    MPI_Datatype node_block_t;
+    MPI_File file;
+    MPI_Request request;
+    bool writing;
+    bool failed; // a collective checkpoint could not be written
+};
+
+/**
+ * Receives the checkpoint parameters of master (\a checkpoint and \a layout are only
+ * used by master) and restores the per-rank checkpoints of the nodes. All nodes continue
+ * after the restored iteration if every node has a checkpoint of the same iteration,
+ * otherwise they start from the beginning.
+ *
+ * @return returns false if there are no checkpoints (or they cannot be created)
+ */
+static bool node_checkpoint_init(struct node_checkpoint *node_checkpoint, const stencil_checkpoint_t *checkpoint,
+                                 int layout, const struct grid *matrix, const struct grid *node_matrix,
+                                 const int dims[], const int coords[], MPI_Comm comm_card)
+{
+    // the clients get the checkpoint parameters from master (length 0: no checkpoints)
+    unsigned long length = (checkpoint != NULL) ? strlen(checkpoint->filepath) + 1 : 0;
+    unsigned long interval = (checkpoint != NULL) ? checkpoint->interval : 0;
+    unsigned long iteration = (checkpoint != NULL) ? checkpoint->iteration : 0;
+    double seconds = (checkpoint != NULL) ? checkpoint->seconds : 0.0;
+
+    MPI_Bcast(&length, 1, MPI_UNSIGNED_LONG, MASTER, MPI_COMM_WORLD);
+    if (length == 0) {
+        return false;
+    }
+    MPI_Bcast(&interval, 1, MPI_UNSIGNED_LONG, MASTER, MPI_COMM_WORLD);
+    MPI_Bcast(&iteration, 1, MPI_UNSIGNED_LONG, MASTER, MPI_COMM_WORLD);
+    MPI_Bcast(&seconds, 1, MPI_DOUBLE, MASTER, MPI_COMM_WORLD);
+    MPI_Bcast(&layout, 1, MPI_INT, MASTER, MPI_COMM_WORLD);
+
+    char filepath[length + sizeof(".tmp") + 3 * sizeof(int)];
+    if (checkpoint != NULL) {
+        strcpy(filepath, checkpoint->filepath);
+    }
+    MPI_Bcast(filepath, length, MPI_CHAR, MASTER, MPI_COMM_WORLD);
+
+    int rank;
+    MPI_Comm_rank(comm_card, &rank);
+
+    if (layout == STENCIL_MPI_CHECKPOINT_PER_RANK) {
+        // the rank in the cartesian grid always belongs to the same block
+        sprintf(filepath + length - 1, ".%d", rank);
+    }
+
+    node_checkpoint->checkpoint = stencil_checkpoint_new(filepath, interval, seconds);
+    node_checkpoint->layout = (stencil_mpi_checkpoint_t)layout;
+    node_checkpoint->stale_halo = false;
+    node_checkpoint->tmp_filepath = NULL;
+    node_checkpoint->snapshot = NULL;
+    node_checkpoint->writing = false;
+    node_checkpoint->failed = false;
+
+    int created = (node_checkpoint->checkpoint != NULL);
+    if (layout == STENCIL_MPI_CHECKPOINT_PER_RANK) {
+        stencil_matrix_t *restored = created ? stencil_checkpoint_restore(node_checkpoint->checkpoint) : NULL;
+        unsigned long restored_iteration = 0;
+        if ((restored != NULL) && (restored->rows == node_matrix->rows) && (restored->cols == node_matrix->cols) &&
+            (restored->boundary == node_matrix->boundary)) {
+            restored_iteration = node_checkpoint->checkpoint->iteration;
+        }
+
+        unsigned long first_iteration;
+        unsigned long last_iteration;
+        MPI_Allreduce(&restored_iteration, &first_iteration, 1, MPI_UNSIGNED_LONG, MPI_MIN, comm_card);
+        MPI_Allreduce(&restored_iteration, &last_iteration, 1, MPI_UNSIGNED_LONG, MPI_MAX, comm_card);
+
+        iteration = 0;
+        if ((first_iteration > 0) && (first_iteration == last_iteration)) {
+            stencil_matrix_copy_values(node_matrix->matrix, restored);
+            node_checkpoint->stale_halo = true;
+            iteration = first_iteration;
+        }
+        stencil_matrix_free(restored);
+    } else {
+        // the nodes write their blocks of the matrix to one grid file
+        stencil_binary_header_init(&node_checkpoint->header, STENCIL_BINARY_DOUBLE, matrix->rows, matrix->cols,
+                                   matrix->boundary, matrix->stride);
+        create_write_block_types(&node_checkpoint->header, node_matrix, dims, coords,
+                                 &node_checkpoint->file_block_t, &node_checkpoint->node_block_t);
+
+        node_checkpoint->tmp_filepath = (char *)malloc(length + sizeof(".tmp"));
+        node_checkpoint->snapshot = stencil_matrix_new(node_matrix->rows, node_matrix->cols, node_matrix->boundary);
+        if ((node_checkpoint->tmp_filepath != NULL) && (node_checkpoint->snapshot != NULL)) {
+            sprintf(node_checkpoint->tmp_filepath, "%s.tmp", filepath);
+        } else {
+            created = false;
+        }
+    }
+
+    if (created) {
+        node_checkpoint->checkpoint->iteration = iteration;
+    }
+
+    // the nodes take their checkpoints together
+    int all_created;
+    MPI_Allreduce(&created, &all_created, 1, MPI_INT, MPI_LAND, comm_card);
+    if (!all_created) {
+        if (layout != STENCIL_MPI_CHECKPOINT_PER_RANK) {
+            MPI_Type_free(&node_checkpoint->node_block_t);
+            MPI_Type_free(&node_checkpoint->file_block_t);
+        }
+        free(node_checkpoint->tmp_filepath);
+        stencil_matrix_free(node_checkpoint->snapshot);
+        stencil_checkpoint_free(node_checkpoint->checkpoint);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @return returns true if all nodes take a checkpoint after iteration \a iteration
+ */
+static bool node_checkpoint_is_due(const struct node_checkpoint *node_checkpoint, size_t iteration,
+                                   MPI_Comm comm_card)
+{
+    int due = stencil_checkpoint_is_due(node_checkpoint->checkpoint, iteration);
+
+    if (node_checkpoint->checkpoint->seconds > 0.0) {
+        // the clocks of the nodes differ
+        int all_due;
+        MPI_Allreduce(&due, &all_due, 1, MPI_INT, MPI_LOR, comm_card);
+        due = all_due;
+    }
+
+    return due;
+}
+
+/**
+ * Completes the collective checkpoint which is written and replaces the checkpoint file
+ * with it if all nodes have written their blocks.
+ *
+ * @return returns false if a node could not write its block
+ */
+static bool node_checkpoint_complete(struct node_checkpoint *node_checkpoint, MPI_Comm comm_card)
+{
+    if (!node_checkpoint->writing) {
+        return true;
+    }
+
+    MPI_Status status;
+    int written = (MPI_Wait(&node_checkpoint->request, &status) == MPI_SUCCESS);
+    MPI_File_close(&node_checkpoint->file);
+    node_checkpoint->writing = false;
+
+    int all_written;
+    MPI_Allreduce(&written, &all_written, 1, MPI_INT, MPI_LAND, comm_card);
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (all_written && (rank == MASTER)) {
+        all_written = (rename(node_checkpoint->tmp_filepath, node_checkpoint->checkpoint->filepath) == 0);
+    }
+
+    return all_written;
+}
+
+/**
+ * Takes a checkpoint of the node matrix \a grid after iteration \a iteration, the nodes
+ * continue while it is written.
+ */
+static void node_checkpoint_take(struct node_checkpoint *node_checkpoint, const struct grid *grid,
+                                 size_t iteration, MPI_Comm comm_card)
+{
+    if (node_checkpoint->layout == STENCIL_MPI_CHECKPOINT_PER_RANK) {
+        if (!stencil_checkpoint_take(node_checkpoint->checkpoint, grid->matrix, iteration)) {
+            node_checkpoint->failed = true;
+        }
+        return;
+    }
+
+    // the snapshot is still written by the previous checkpoint
+    if (!node_checkpoint_complete(node_checkpoint, comm_card)) {
+        node_checkpoint->failed = true;
+    }
+
+    stencil_matrix_copy_values(node_checkpoint->snapshot, grid->matrix);
+    node_checkpoint->checkpoint->last_time = get_time();
+    node_checkpoint->header.iteration = iteration;
+
+    if (MPI_File_open(comm_card, node_checkpoint->tmp_filepath, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+                      &node_checkpoint->file) != MPI_SUCCESS) {
+        node_checkpoint->failed = true;
+        return;
+    }
+
+    // the padding of the rows is not written, it reads as zeros
+    MPI_File_set_size(node_checkpoint->file, 0);
+    MPI_File_set_size(node_checkpoint->file, node_checkpoint->header.offset +
+                      node_checkpoint->header.rows * node_checkpoint->header.stride * sizeof(double));
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (rank == MASTER) {
+        MPI_Status status;
+        unsigned char bytes[STENCIL_BINARY_HEADER_SIZE];
+        stencil_binary_encode_header(&node_checkpoint->header, bytes);
+        MPI_File_write_at(node_checkpoint->file, 0, bytes, STENCIL_BINARY_HEADER_SIZE, MPI_BYTE, &status);
+    }
+
+    MPI_File_set_view(node_checkpoint->file, node_checkpoint->header.offset, MPI_DOUBLE,
+                      node_checkpoint->file_block_t, "native", MPI_INFO_NULL);
+    MPI_File_iwrite_at_all(node_checkpoint->file, 0, node_checkpoint->snapshot->values, 1,
+                           node_checkpoint->node_block_t, &node_checkpoint->request);
+    node_checkpoint->writing = true;
+}
+
+/**
+ * Completes the last checkpoint and frees the checkpoints of the node.
+ *
+ * @return returns false if a checkpoint could not be written
+ */
+static bool node_checkpoint_free(struct node_checkpoint *node_checkpoint, MPI_Comm comm_card)
+{
+    bool written = !node_checkpoint->failed;
+    if (node_checkpoint->layout != STENCIL_MPI_CHECKPOINT_PER_RANK) {
+        written = node_checkpoint_complete(node_checkpoint, comm_card) && written;
+
+        MPI_Type_free(&node_checkpoint->node_block_t);
+        MPI_Type_free(&node_checkpoint->file_block_t);
+        free(node_checkpoint->tmp_filepath);
+        stencil_matrix_free(node_checkpoint->snapshot);
+    }
+
+    return stencil_checkpoint_free(node_checkpoint->checkpoint) && written;
+}
+
+/**
+ * Applies the stencil \a iterations times on the node matrix (float matrices use the
+ * five-point stencil with precision \a precision). If \a convergence is not NULL,
+ * the global residual (MPI_Allreduce) is calculated on every check iteration and the
+ * iteration stops on all nodes as soon as it has converged.
+ *
+ * A relaxation factor \a omega > 0 selects red-black SOR (five-point) instead, the halo
+ * is exchanged before each colour. \a parity is the parity of the global position of
+ * the first interior field of the node, so all nodes agree on the colour of a field.
+ *
+ * If \a checkpoint is not NULL, the iteration continues after the restored iteration and
+ * checkpoints of the node matrix are taken.
+ */
+static double sequential_stencil(const struct grid *grid, const stencil_descriptor_t *descriptor,
+                                 stencil_precision_t precision, double omega, size_t parity,
+                                 const size_t iterations, stencil_convergence_t *convergence,
+                                 struct node_checkpoint *checkpoint, MPI_Comm comm_card)
+{
+    assert(grid->boundary >= descriptor->radius);
+    assert(grid->matrix != NULL || (convergence == NULL && omega == 0.0 && checkpoint == NULL));
+
+#if !defined(SENDRECV_BOUNDARY_EXCHANGE)
+    // stencils with diagonal points need the corners of the halo (always exchanged by sendrecv)
+    const bool corners = stencil_descriptor_has_diagonals(descriptor);
+#endif
 
     // find our neighbours
     int neighbours_source[4];
@@ -214,8 +703,10 @@ static double sequential_five_point_stencil(stencil_matrix_t *matrix, const size
 
 #if (defined(ONESIDED_FENCE_BOUNDARY_EXCHANGE) || defined(ONESIDED_PSCW_BOUNDARY_EXCHANGE))
     MPI_Win boundary_window;
-    MPI_Win_create(stencil_matrix_get_ptr(matrix, 0, 0), matrix->cols * matrix->rows * sizeof(double),
-                   sizeof(double), MPI_INFO_NULL, comm_card, &boundary_window);
+    MPI_Win_create(grid->values, grid->stride * grid->rows * grid->element_size,
+                   grid->element_size, MPI_INFO_NULL, comm_card, &boundary_window);
+    struct halo_targets targets;
+    create_halo_targets(grid, neighbours_dest, &targets, comm_card);
 #if defined(ONESIDED_PSCW_BOUNDARY_EXCHANGE)
     MPI_Group world_group;
     MPI_Comm_group(comm_card, &world_group);
@@ -228,64 +719,119 @@ static double sequential_five_point_stencil(stencil_matrix_t *matrix, const size
 #endif
 
     MPI_Datatype matrix_row_t;
-    MPI_Type_vector(1, matrix->cols, matrix->cols, MPI_DOUBLE, &matrix_row_t);
+    MPI_Type_vector(grid->boundary, grid->cols, grid->stride, grid->element_type, &matrix_row_t);
     MPI_Type_commit(&matrix_row_t);
 
     MPI_Datatype matrix_col_t;
-    MPI_Type_vector(matrix->rows, 1, matrix->cols, MPI_DOUBLE, &matrix_col_t);
+    MPI_Type_vector(grid->rows, grid->boundary, grid->stride, grid->element_type, &matrix_col_t);
     MPI_Type_commit(&matrix_col_t);
 
-    stencil_vector_t *tmp = stencil_vector_new(matrix->cols);
+    void *buffer = malloc((descriptor->radius + 1) * grid->cols * grid->element_size);
+
+#if defined(STENCIL_HYBRID)
+    /*
+     * The team of the engine calculates the block of the node (all sweeps but the ones
+     * of single precision grids), the halo is exchanged by the master thread between the
+     * parallel regions (MPI_THREAD_FUNNELED). The threads are not pinned by the engine,
+     * they stay on the CPUs the launcher has bound the node to (OMP_PROC_BIND places them
+     * inside). Every thread gets at least two rows. Without an engine the sweeps fall
+     * back to the sequential ones.
+     */
+    stencil_openmp_engine_t *engine = NULL;
+    if (grid->matrix != NULL) {
+        const int max_threads = (int)((grid->rows - 2 * grid->boundary) / 2);
+        int threads = omp_get_max_threads();
+        if (threads > max_threads) {
+            threads = (max_threads > 0) ? max_threads : 1;
+        }
+        engine = stencil_openmp_engine_new(threads, false);
+    }
+#endif
+
+    // the second colour of the SOR needs the updated first colour of the neighbours
+    const size_t colours = (omega > 0.0) ? 2 : 1;
+    const stencil_norm_t norm = (convergence != NULL) ? convergence->norm : STENCIL_NORM_MAX;
+
+    // a restart continues after the checkpoint, the halo of a per-rank checkpoint is out of date
+    const size_t first = (checkpoint != NULL) ? checkpoint->checkpoint->iteration + 1 : 1;
+    const bool stale_halo = (checkpoint != NULL) && checkpoint->stale_halo;
 
     const double t1 = MPI_Wtime();
 
-    for (size_t iteration = 1; iteration <= iterations; iteration++) {
-        // exchange boundary data (not needed on the first iteration because we
-        // have already received the correct boundary data from master)
-        if (iteration > 1) {
-            #if defined(SENDRECV_BOUNDARY_EXCHANGE)
-                exchange_boundary_data_sendrecv(matrix, neighbours_source, neighbours_dest,
-                                                matrix_row_t, matrix_col_t, comm_card);
-            #elif defined(NONBLOCKING_BOUNDARY_EXCHANGE)
-                exchange_boundary_data_nonblocking(matrix, neighbours_source, neighbours_dest,
-                                                   matrix_row_t, matrix_col_t, comm_card);
-            #elif defined(ONESIDED_FENCE_BOUNDARY_EXCHANGE)
-                exchange_boundary_data_onesided_fence(matrix, neighbours_source, neighbours_dest,
-                                                      matrix_row_t, matrix_col_t, boundary_window,
-                                                      comm_card);
-            #elif defined(ONESIDED_PSCW_BOUNDARY_EXCHANGE)
-                exchange_boundary_data_onesided_pscw(matrix, neighbours_source, neighbours_dest,
-                                                     matrix_row_t, matrix_col_t, boundary_window,
-                                                     group, comm_card);
-            #endif
+    for (size_t iteration = first; iteration <= iterations; iteration++) {
+        const bool check = (convergence != NULL) && stencil_convergence_is_check(convergence, iteration);
+        double partial = 0.0;
+
+        for (size_t colour = 0; colour < colours; colour++) {
+            // exchange boundary data (not needed on the first iteration because we
+            // have already received the correct boundary data from master)
+            if ((iteration > first) || (colour > 0) || stale_halo) {
+                #if defined(SENDRECV_BOUNDARY_EXCHANGE)
+                    exchange_boundary_data_sendrecv(grid, neighbours_source, neighbours_dest,
+                                                    matrix_row_t, matrix_col_t, comm_card);
+                #elif defined(NONBLOCKING_BOUNDARY_EXCHANGE)
+                    exchange_boundary_data_nonblocking(grid, neighbours_source, neighbours_dest,
+                                                       matrix_row_t, matrix_col_t, corners, comm_card);
+                #elif defined(ONESIDED_FENCE_BOUNDARY_EXCHANGE)
+                    exchange_boundary_data_onesided_fence(grid, neighbours_source, neighbours_dest,
+                                                          matrix_row_t, matrix_col_t, &targets, corners,
+                                                          boundary_window, comm_card);
+                #elif defined(ONESIDED_PSCW_BOUNDARY_EXCHANGE)
+                    exchange_boundary_data_onesided_pscw(grid, neighbours_source, neighbours_dest,
+                                                         matrix_row_t, matrix_col_t, &targets, corners,
+                                                         boundary_window, group, comm_card);
+                #endif
+            }
+
+            if (grid->matrix_float != NULL) {
+                stencil_five_point_sweep_float(grid->matrix_float, (float *)buffer, precision);
+#if defined(STENCIL_HYBRID)
+            } else if ((engine != NULL) && (omega > 0.0)) {
+                const double sweep = five_point_stencil_engine_sor_sweep(engine, grid->matrix, (stencil_colour_t)colour,
+                                                                         parity, omega, norm);
+                partial = stencil_residual_combine(norm, partial, sweep);
+            } else if ((engine != NULL) && !check && (descriptor == &stencil_five_point)) {
+                five_point_stencil_engine_one_vector(engine, grid->matrix, 1);
+            } else if (engine != NULL) {
+                partial = stencil_engine_descriptor_sweep(engine, grid->matrix, descriptor, check, norm);
+#endif
+            } else if (omega > 0.0) {
+                const double sweep = stencil_five_point_sweep_sor(grid->matrix, (stencil_colour_t)colour, parity,
+                                                                  omega, norm);
+                partial = stencil_residual_combine(norm, partial, sweep);
+            } else if (!check) {
+                stencil_descriptor_sweep(descriptor, grid->matrix, (double *)buffer);
+            } else {
+                partial = stencil_descriptor_sweep_residual(descriptor, grid->matrix, (double *)buffer, norm);
+            }
         }
 
-        // calculate the first row
-        const size_t first_row = matrix->boundary;
-        for (size_t col = matrix->boundary; col < cols; col++) {
-            stencil_vector_set(tmp, col, stencil_five_point_kernel(matrix, first_row, col));
+        if ((checkpoint != NULL) && node_checkpoint_is_due(checkpoint, iteration, comm_card)) {
+            node_checkpoint_take(checkpoint, grid, iteration, comm_card);
         }
 
-        // calculate the remaining rows
-        for (size_t row = first_row + 1; row < rows; row++) {
-            for (size_t col = matrix->boundary; col < cols; col++) {
-                const double value = stencil_five_point_kernel(matrix, row, col);
-                // copy back the previosly calculated value before we overwrite it
-                stencil_matrix_set(matrix, row - 1, col, stencil_vector_get(tmp, col));
-                stencil_vector_set(tmp, col, value);
-            }
+        if (!check) {
+            continue;
         }
 
-        // copy back calculated values of the last non-boundary row
-        stencil_matrix_set_row(matrix, rows - 1, tmp);
+        double residual;
+        MPI_Allreduce(&partial, &residual, 1, MPI_DOUBLE, (norm == STENCIL_NORM_MAX) ? MPI_MAX : MPI_SUM, comm_card);
+
+        if (stencil_convergence_update(convergence, iteration, residual)) {
+            break;
+        }
     }
 
     const double t2 = MPI_Wtime();
 
-    stencil_vector_free(tmp);
+    free(buffer);
+#if defined(STENCIL_HYBRID)
+    stencil_openmp_engine_free(engine);
+#endif
 
 #if (defined(ONESIDED_FENCE_BOUNDARY_EXCHANGE) || defined(ONESIDED_PSCW_BOUNDARY_EXCHANGE))
     MPI_Win_free(&boundary_window);
+    free_halo_targets(&targets);
 
 #if defined(ONESIDED_PSCW_BOUNDARY_EXCHANGE)
     MPI_Group_free(&world_group);
@@ -299,7 +845,7 @@ static double sequential_five_point_stencil(stencil_matrix_t *matrix, const size
     return (t2 - t1) * 1000;
 }
 
-static void optimize_dims_for_matrix(int dims[], stencil_matrix_t *matrix)
+static void optimize_dims_for_matrix(int dims[], const struct grid *matrix)
 {
     if (((matrix->cols > matrix->rows) && (dims[DIM_HORIZONTAL] < dims[DIM_VERTICAL])) ||
         ((matrix->cols < matrix->rows) && (dims[DIM_HORIZONTAL] > dims[DIM_VERTICAL]))) { // transpose
@@ -336,7 +882,7 @@ static void optimize_dims_for_matrix(int dims[], stencil_matrix_t *matrix)
     }
 }
 
-static MPI_Comm create_cartesian_topology(MPI_Comm old_comm, stencil_matrix_t *matrix)
+static MPI_Comm create_cartesian_topology(MPI_Comm old_comm, const struct grid *matrix)
 {
     int nodes;
     MPI_Comm_size(old_comm, &nodes);
@@ -356,31 +902,132 @@ static MPI_Comm create_cartesian_topology(MPI_Comm old_comm, stencil_matrix_t *m
     return comm_card;
 }
 
-static MPI_Datatype create_submatrix_type(stencil_matrix_t *matrix,
+static MPI_Datatype create_submatrix_type(const struct grid *matrix,
                                           size_t rows, size_t cols, size_t boundary)
 {
-    const int matrix_size[] = {matrix->rows, matrix->cols};
+    const int matrix_size[] = {matrix->rows, matrix->stride}; // the padding is part of the array
     const int data_size[] = {rows, cols};
     const int data_position[] = {boundary, boundary};
 
     MPI_Datatype submatrix_type;
     MPI_Type_create_subarray(DIMENSIONS, matrix_size, data_size, data_position,
-                             MPI_ORDER_C, MPI_DOUBLE, &submatrix_type);
+                             MPI_ORDER_C, matrix->element_type, &submatrix_type);
     MPI_Type_commit(&submatrix_type);
 
     MPI_Datatype resized_submatrix_type;
-    MPI_Type_create_resized(submatrix_type, 0, sizeof(double), &resized_submatrix_type);
+    MPI_Type_create_resized(submatrix_type, 0, matrix->element_size, &resized_submatrix_type);
     MPI_Type_commit(&resized_submatrix_type);
 
     return resized_submatrix_type;
 }
 
-static double five_point_stencil_node(stencil_matrix_t *matrix, size_t iterations)
+/**
+ * Master sends every node its block of matrix \a matrix with halo, the node receives it
+ * into \a node_matrix. The blocks have different sizes, thus every block has its own type
+ * (point-to-point instead of MPI_Scatterv).
+ */
+static void scatter_blocks(const struct grid *matrix, const struct grid *node_matrix, const int dims[],
+                           MPI_Comm comm_card)
 {
+    const size_t boundary = matrix->boundary;
+
+    int rank;
+    MPI_Comm_rank(comm_card, &rank);
+
+    int nodes;
+    MPI_Comm_size(comm_card, &nodes);
+
+    MPI_Request requests[nodes];
+    if (rank == MASTER) {
+        for (int node = 0; node < nodes; node++) {
+            int coords[DIMENSIONS];
+            MPI_Cart_coords(comm_card, node, DIMENSIONS, coords);
+            const struct node_block block = node_block(matrix->rows, matrix->cols, boundary, dims, coords);
+
+            // the block with boundary starts boundary rows and cols before the interior
+            MPI_Datatype block_t = create_submatrix_type(matrix, block.rows + 2 * boundary,
+                                                         block.cols + 2 * boundary, 0);
+            MPI_Isend(grid_get_ptr(matrix, block.first_row, block.first_col), 1, block_t, node, SCATTER_TAG,
+                      comm_card, &requests[node]);
+            MPI_Type_free(&block_t);
+        }
+    }
+
+    MPI_Status status;
+    MPI_Datatype node_block_t = create_submatrix_type(node_matrix, node_matrix->rows, node_matrix->cols, 0);
+    MPI_Recv(node_matrix->values, 1, node_block_t, MASTER, SCATTER_TAG, comm_card, &status);
+    MPI_Type_free(&node_block_t);
+
+    if (rank == MASTER) {
+        MPI_Waitall(nodes, requests, MPI_STATUSES_IGNORE);
+    }
+}
+
+/**
+ * Every node sends the interior of \a node_matrix to master, which receives it into its
+ * block of matrix \a matrix.
+ */
+static void gather_blocks(const struct grid *matrix, const struct grid *node_matrix, const int dims[],
+                          MPI_Comm comm_card)
+{
+    const size_t boundary = matrix->boundary;
+
+    int rank;
+    MPI_Comm_rank(comm_card, &rank);
+
+    int nodes;
+    MPI_Comm_size(comm_card, &nodes);
+
+    MPI_Request request;
+    MPI_Datatype node_block_t = create_submatrix_type(node_matrix, node_matrix->rows - 2 * boundary,
+                                                      node_matrix->cols - 2 * boundary, boundary);
+    MPI_Isend(node_matrix->values, 1, node_block_t, MASTER, GATHER_TAG, comm_card, &request);
+
+    if (rank == MASTER) {
+        for (int node = 0; node < nodes; node++) {
+            int coords[DIMENSIONS];
+            MPI_Cart_coords(comm_card, node, DIMENSIONS, coords);
+            const struct node_block block = node_block(matrix->rows, matrix->cols, boundary, dims, coords);
+
+            MPI_Status status;
+            MPI_Datatype block_t = create_submatrix_type(matrix, block.rows, block.cols, boundary);
+            MPI_Recv(grid_get_ptr(matrix, block.first_row, block.first_col), 1, block_t, node, GATHER_TAG,
+                     comm_card, &status);
+            MPI_Type_free(&block_t);
+        }
+    }
+
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+    MPI_Type_free(&node_block_t);
+}
+
+static double stencil_node(struct grid *matrix, const stencil_descriptor_t *descriptor,
+                           stencil_precision_t precision, double omega, size_t iterations,
+                           stencil_convergence_t *convergence, stencil_checkpoint_t *checkpoint,
+                           stencil_mpi_checkpoint_t layout)
+{
+    // the clients get the element type and the precision from master
+    int single = (matrix->matrix_float != NULL);
+    int precision_value = precision;
+
+    // the clients get the convergence parameters from master (check interval 0: fixed number of iterations)
+    size_t check_interval = (convergence != NULL) ? convergence->check_interval : 0;
+    double tolerance = (convergence != NULL) ? convergence->tolerance : 0.0;
+    int norm = (convergence != NULL) ? convergence->norm : STENCIL_NORM_MAX;
+
     MPI_Bcast(&iterations, 1, MPI_UNSIGNED_LONG, MASTER, MPI_COMM_WORLD);
+    MPI_Bcast(&check_interval, 1, MPI_UNSIGNED_LONG, MASTER, MPI_COMM_WORLD);
+    MPI_Bcast(&tolerance, 1, MPI_DOUBLE, MASTER, MPI_COMM_WORLD);
+    MPI_Bcast(&norm, 1, MPI_INT, MASTER, MPI_COMM_WORLD);
+    MPI_Bcast(&single, 1, MPI_INT, MASTER, MPI_COMM_WORLD);
+    MPI_Bcast(&precision_value, 1, MPI_INT, MASTER, MPI_COMM_WORLD);
+    MPI_Bcast(&omega, 1, MPI_DOUBLE, MASTER, MPI_COMM_WORLD); // 0: Jacobi iterations
     MPI_Bcast(&matrix->rows, 1, MPI_UNSIGNED_LONG, MASTER, MPI_COMM_WORLD);
     MPI_Bcast(&matrix->cols, 1, MPI_UNSIGNED_LONG, MASTER, MPI_COMM_WORLD);
+    MPI_Bcast(&matrix->stride, 1, MPI_UNSIGNED_LONG, MASTER, MPI_COMM_WORLD);
     MPI_Bcast(&matrix->boundary, 1, MPI_UNSIGNED_LONG, MASTER, MPI_COMM_WORLD);
+    matrix->element_type = single ? MPI_FLOAT : MPI_DOUBLE;
+    matrix->element_size = single ? sizeof(float) : sizeof(double);
 
     MPI_Comm comm_card = create_cartesian_topology(MPI_COMM_WORLD, matrix);
 
@@ -398,73 +1045,72 @@ static double five_point_stencil_node(stencil_matrix_t *matrix, size_t iteration
     const int nodes_horizontal = dims[DIM_HORIZONTAL];
     const int nodes_vertical = dims[DIM_VERTICAL];
 
-    if ((((matrix->rows - 2 * matrix->boundary) % nodes_vertical) != 0) ||
-        (((matrix->cols - 2 * matrix->boundary) % nodes_horizontal) != 0)) {
+    // the blocks of the nodes differ by at most one row and col
+    const struct node_block block = node_block(matrix->rows, matrix->cols, matrix->boundary, dims, coords);
+
+    // the colouring of the SOR is global, the node matrix starts at an odd position for odd offsets
+    const size_t parity = (block.first_row + block.first_col) % 2;
+
+    // the halo of a node is filled by the direct neighbours only (the smallest blocks have
+    // the rounded down number of rows and cols)
+    if ((((matrix->rows - 2 * matrix->boundary) / nodes_vertical) < matrix->boundary) ||
+        (((matrix->cols - 2 * matrix->boundary) / nodes_horizontal) < matrix->boundary)) {
         if (rank == MASTER) {
-            fprintf(stderr, "The given matrix cannot be evenly distributed to all nodes, abort ...\n");
+            fprintf(stderr, "The sub-matrices are smaller than the stencil boundary, abort ...\n");
         }
+        MPI_Comm_free(&comm_card);
         return -1.0;
     }
 
-    const size_t rows_per_node = (matrix->rows - 2 * matrix->boundary) / nodes_vertical;
-    const size_t cols_per_node = (matrix->cols - 2 * matrix->boundary) / nodes_horizontal;
-
-    // calculate sub-matrix displacements and block counts (grid looks like [[0,2],[1,3]])
-    int block_counts[nodes];
-    int block_displacements[nodes];
-    for (int i = 0; i < nodes_horizontal; i++) {
-        for (int j = 0; j < nodes_vertical; j++) {
-            const int node = i * nodes_vertical + j;
-            block_counts[node] = 1; // block count is always 1 because we use our special matrix type
-            block_displacements[node] = stencil_matrix_get_ptr(matrix, j * rows_per_node, i * cols_per_node) -
-                                        stencil_matrix_get_ptr(matrix, 0, 0); // we need the relative address
-        }
+    // receive matrix (with boundary)
+    const size_t rows_per_node_with_boundary = block.rows + 2 * matrix->boundary;
+    const size_t cols_per_node_with_boundary = block.cols + 2 * matrix->boundary;
+    struct grid node_matrix;
+    if (single) {
+        node_matrix = grid_from_matrix_float(stencil_matrix_float_new(rows_per_node_with_boundary,
+                                                                      cols_per_node_with_boundary,
+                                                                      matrix->boundary));
+    } else {
+        node_matrix = grid_from_matrix(stencil_matrix_new(rows_per_node_with_boundary,
+                                                          cols_per_node_with_boundary,
+                                                          matrix->boundary));
     }
 
-    // receive matrix (with boundary)
-    const size_t rows_per_node_with_boundary = rows_per_node + 2 * STENCIL_BOUNDARY;
-    const size_t cols_per_node_with_boundary = cols_per_node + 2 * STENCIL_BOUNDARY;
-    stencil_matrix_t *node_matrix = stencil_matrix_new(rows_per_node_with_boundary,
-                                                       cols_per_node_with_boundary,
-                                                       STENCIL_BOUNDARY);
-
-    MPI_Datatype matrix_with_boundary_t = create_submatrix_type(matrix,
-                                                                rows_per_node_with_boundary,
-                                                                cols_per_node_with_boundary,
-                                                                0);
-    MPI_Datatype node_matrix_with_boundary_t = create_submatrix_type(node_matrix,
-                                                                     rows_per_node_with_boundary,
-                                                                     cols_per_node_with_boundary,
-                                                                     0);
-
-    MPI_Scatterv(matrix->values, block_counts, block_displacements, matrix_with_boundary_t, // sender
-                 node_matrix->values, 1, node_matrix_with_boundary_t, // receiver
-                 MASTER, comm_card);
-
-    MPI_Type_free(&node_matrix_with_boundary_t);
-    MPI_Type_free(&matrix_with_boundary_t);
+    scatter_blocks(matrix, &node_matrix, dims, comm_card);
 
     // start calculation
-    double wall_time = sequential_five_point_stencil(node_matrix, iterations, comm_card);
+    stencil_convergence_t node_convergence;
+    if (check_interval > 0) {
+        stencil_convergence_init(&node_convergence, (stencil_norm_t)norm, tolerance, check_interval, iterations);
+    }
 
-    // send back data (without boundary)
-    MPI_Datatype matrix_without_boundary_t = create_submatrix_type(matrix,
-                                                                   rows_per_node,
-                                                                   cols_per_node,
-                                                                   STENCIL_BOUNDARY);
-    MPI_Datatype node_matrix_without_boundary_t = create_submatrix_type(node_matrix,
-                                                                        rows_per_node,
-                                                                        cols_per_node,
-                                                                        STENCIL_BOUNDARY);
+    struct node_checkpoint node_checkpoint;
+    const bool checkpoints = node_checkpoint_init(&node_checkpoint, checkpoint, layout, matrix, &node_matrix,
+                                                  dims, coords, comm_card);
 
-    MPI_Gatherv(node_matrix->values, 1, node_matrix_without_boundary_t, // sender
-                matrix->values, block_counts, block_displacements, matrix_without_boundary_t, // receiver
-                MASTER, comm_card);
+    double wall_time = sequential_stencil(&node_matrix, descriptor, (stencil_precision_t)precision_value, omega,
+                                          parity, iterations, (check_interval > 0) ? &node_convergence : NULL,
+                                          checkpoints ? &node_checkpoint : NULL, comm_card);
 
-    MPI_Type_free(&node_matrix_without_boundary_t);
-    MPI_Type_free(&matrix_without_boundary_t);
+    if (checkpoints) {
+        int written = node_checkpoint_free(&node_checkpoint, comm_card);
+        int all_written;
+        MPI_Allreduce(&written, &all_written, 1, MPI_INT, MPI_LAND, comm_card);
+        if ((checkpoint != NULL) && !all_written) {
+            checkpoint->failed = true; // reported by stencil_checkpoint_wait on master
+        }
+    }
 
-    stencil_matrix_free(node_matrix);
+    if ((convergence != NULL) && (check_interval > 0)) {
+        convergence->iterations = node_convergence.iterations;
+        convergence->residual = node_convergence.residual;
+    }
+
+    // send back data (without boundary)
+    gather_blocks(matrix, &node_matrix, dims, comm_card);
+
+    stencil_matrix_free(node_matrix.matrix);
+    stencil_matrix_float_free(node_matrix.matrix_float);
 
     // collect the maximum wall time
     double max_wall_time;
@@ -475,16 +1121,219 @@ static double five_point_stencil_node(stencil_matrix_t *matrix, size_t iteration
     return max_wall_time;
 }
 
-double five_point_stencil_host(stencil_matrix_t *matrix, size_t iterations)
+/**
+ * Opens the binary grid file \a filepath on all nodes and reads its header.
+ *
+ * @return returns false if the file cannot be opened or is not a grid file of doubles
+ */
+static bool open_grid_file(const char *filepath, MPI_File *file, stencil_binary_header_t *header)
 {
-    assert(matrix->boundary == STENCIL_BOUNDARY);
+    if (MPI_File_open(MPI_COMM_WORLD, (char *)filepath, MPI_MODE_RDONLY, MPI_INFO_NULL, file) != MPI_SUCCESS) {
+        return false;
+    }
 
-    return five_point_stencil_node(matrix, iterations);
+    MPI_Offset file_size;
+    MPI_File_get_size(*file, &file_size);
+
+    unsigned char bytes[STENCIL_BINARY_HEADER_SIZE];
+    memset(bytes, 0, sizeof(bytes));
+    MPI_Status status;
+    MPI_File_read_at_all(*file, 0, bytes, STENCIL_BINARY_HEADER_SIZE, MPI_BYTE, &status);
+
+    if (!stencil_binary_decode_header(bytes, file_size, header) ||
+        header->dtype != STENCIL_BINARY_DOUBLE || header->boundary < 1) {
+        MPI_File_close(file);
+        return false;
+    }
+
+    return true;
 }
 
-void five_point_stencil_client()
+double five_point_stencil_file(const char *input, const char *output, size_t iterations)
+{
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    MPI_File file;
+    stencil_binary_header_t header;
+    if (!open_grid_file(input, &file, &header)) {
+        if (rank == MASTER) {
+            fprintf(stderr, "%s is not a binary grid file, abort ...\n", input);
+        }
+        return -1.0;
+    }
+
+    // the matrix is never held by a single node, only its dimensions are needed
+    const struct grid matrix = {
+        .rows = header.rows, .cols = header.cols, .stride = header.stride, .boundary = header.boundary, .values = NULL,
+        .element_type = MPI_DOUBLE, .element_size = sizeof(double), .matrix = NULL, .matrix_float = NULL
+    };
+
+    MPI_Comm comm_card = create_cartesian_topology(MPI_COMM_WORLD, &matrix);
+
+    int dims[DIMENSIONS];
+    int periods[DIMENSIONS];
+    int coords[DIMENSIONS];
+    MPI_Cart_get(comm_card, DIMENSIONS, dims, periods, coords);
+
+    const int nodes_horizontal = dims[DIM_HORIZONTAL];
+    const int nodes_vertical = dims[DIM_VERTICAL];
+
+    const size_t boundary = matrix.boundary;
+    if ((((matrix.rows - 2 * boundary) / nodes_vertical) < boundary) ||
+        (((matrix.cols - 2 * boundary) / nodes_horizontal) < boundary)) {
+        if (rank == MASTER) {
+            fprintf(stderr, "The sub-matrices are smaller than the stencil boundary, abort ...\n");
+        }
+        MPI_File_close(&file);
+        MPI_Comm_free(&comm_card);
+        return -1.0;
+    }
+
+    // every node reads its own block (with halo), the same block as scatter_blocks in stencil_node
+    const struct node_block block = node_block(matrix.rows, matrix.cols, boundary, dims, coords);
+    const size_t first_row = block.first_row;
+    const size_t first_col = block.first_col;
+    const size_t rows_per_node_with_boundary = block.rows + 2 * boundary;
+    const size_t cols_per_node_with_boundary = block.cols + 2 * boundary;
+    struct grid node_matrix = grid_from_matrix(stencil_matrix_new(rows_per_node_with_boundary,
+                                                                  cols_per_node_with_boundary,
+                                                                  boundary));
+
+    MPI_Datatype file_block_t = create_file_block_type(&header, first_row, first_col,
+                                                       rows_per_node_with_boundary, cols_per_node_with_boundary);
+    MPI_Datatype node_block_t = create_submatrix_type(&node_matrix, rows_per_node_with_boundary,
+                                                      cols_per_node_with_boundary, 0);
+
+    MPI_Status status;
+    MPI_File_set_view(file, header.offset, MPI_DOUBLE, file_block_t, "native", MPI_INFO_NULL);
+    MPI_File_read_at_all(file, 0, node_matrix.values, 1, node_block_t, &status);
+    MPI_File_close(&file);
+
+    MPI_Type_free(&node_block_t);
+    MPI_Type_free(&file_block_t);
+
+    double wall_time = sequential_stencil(&node_matrix, &stencil_five_point, STENCIL_PRECISION_SINGLE, 0.0, 0,
+                                          iterations, NULL, NULL, comm_card);
+
+    int written = false;
+    if (MPI_File_open(comm_card, (char *)output, MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+                      &file) == MPI_SUCCESS) {
+        // the padding of the rows is not written, it reads as zeros
+        MPI_File_set_size(file, 0);
+        MPI_File_set_size(file, header.offset + header.rows * header.stride * sizeof(double));
+
+        if (rank == MASTER) {
+            unsigned char bytes[STENCIL_BINARY_HEADER_SIZE];
+            stencil_binary_encode_header(&header, bytes);
+            MPI_File_write_at(file, 0, bytes, STENCIL_BINARY_HEADER_SIZE, MPI_BYTE, &status);
+        }
+
+        create_write_block_types(&header, &node_matrix, dims, coords, &file_block_t, &node_block_t);
+
+        MPI_File_set_view(file, header.offset, MPI_DOUBLE, file_block_t, "native", MPI_INFO_NULL);
+        written = (MPI_File_write_at_all(file, 0, node_matrix.values, 1, node_block_t, &status) == MPI_SUCCESS);
+        MPI_File_close(&file);
+
+        MPI_Type_free(&node_block_t);
+        MPI_Type_free(&file_block_t);
+    }
+
+    stencil_matrix_free(node_matrix.matrix);
+
+    // all nodes return the maximum wall time (or all of them fail)
+    int all_written;
+    MPI_Allreduce(&written, &all_written, 1, MPI_INT, MPI_LAND, comm_card);
+    double max_wall_time;
+    MPI_Allreduce(&wall_time, &max_wall_time, 1, MPI_DOUBLE, MPI_MAX, comm_card);
+
+    MPI_Comm_free(&comm_card);
+
+    return all_written ? max_wall_time : -1.0;
+}
+
+double stencil_host_with_descriptor(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor,
+                                    size_t iterations)
+{
+    assert(matrix->boundary >= descriptor->radius);
+
+    struct grid grid = grid_from_matrix(matrix);
+    return stencil_node(&grid, descriptor, STENCIL_PRECISION_SINGLE, 0.0, iterations, NULL, NULL, STENCIL_MPI_CHECKPOINT_COLLECTIVE);
+}
+
+double stencil_host_until_converged(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor,
+                                    stencil_convergence_t *convergence)
+{
+    assert(matrix->boundary >= descriptor->radius);
+    assert(convergence->check_interval > 0);
+
+    struct grid grid = grid_from_matrix(matrix);
+    return stencil_node(&grid, descriptor, STENCIL_PRECISION_SINGLE, 0.0, convergence->max_iterations, convergence,
+                        NULL, STENCIL_MPI_CHECKPOINT_COLLECTIVE);
+}
+
+void stencil_client_with_descriptor(const stencil_descriptor_t *descriptor)
 {
     stencil_matrix_t *matrix = stencil_matrix_new(0, 0, 0); // create a empty matrix (we don't need any memory for values)
-    five_point_stencil_node(matrix, 0);
+    struct grid grid = grid_from_matrix(matrix);
+    stencil_node(&grid, descriptor, STENCIL_PRECISION_SINGLE, 0.0, 0, NULL, NULL, STENCIL_MPI_CHECKPOINT_COLLECTIVE);
     stencil_matrix_free(matrix);
 }
+
+double five_point_stencil_host(stencil_matrix_t *matrix, size_t iterations)
+{
+    assert(matrix->boundary == 1);
+
+    return stencil_host_with_descriptor(matrix, &stencil_five_point, iterations);
+}
+
+double five_point_stencil_host_until_converged(stencil_matrix_t *matrix, stencil_convergence_t *convergence)
+{
+    assert(matrix->boundary == 1);
+
+    return stencil_host_until_converged(matrix, &stencil_five_point, convergence);
+}
+
+double five_point_stencil_host_float(stencil_matrix_float_t *matrix, size_t iterations, stencil_precision_t precision)
+{
+    assert(matrix->boundary == 1);
+
+    struct grid grid = grid_from_matrix_float(matrix);
+    return stencil_node(&grid, &stencil_five_point, precision, 0.0, iterations, NULL, NULL, STENCIL_MPI_CHECKPOINT_COLLECTIVE);
+}
+
+double five_point_stencil_host_sor(stencil_matrix_t *matrix, double omega, size_t iterations)
+{
+    assert(matrix->boundary == 1);
+    assert(omega > 0.0);
+
+    struct grid grid = grid_from_matrix(matrix);
+    return stencil_node(&grid, &stencil_five_point, STENCIL_PRECISION_SINGLE, omega, iterations, NULL, NULL, STENCIL_MPI_CHECKPOINT_COLLECTIVE);
+}
+
+double five_point_stencil_host_sor_until_converged(stencil_matrix_t *matrix, double omega,
+                                                   stencil_convergence_t *convergence)
+{
+    assert(matrix->boundary == 1);
+    assert(omega > 0.0);
+    assert(convergence->check_interval > 0);
+
+    struct grid grid = grid_from_matrix(matrix);
+    return stencil_node(&grid, &stencil_five_point, STENCIL_PRECISION_SINGLE, omega, convergence->max_iterations,
+                        convergence, NULL, STENCIL_MPI_CHECKPOINT_COLLECTIVE);
+}
+
+double five_point_stencil_host_with_checkpoint(stencil_matrix_t *matrix, size_t iterations,
+                                               stencil_checkpoint_t *checkpoint, stencil_mpi_checkpoint_t layout)
+{
+    assert(matrix->boundary == 1);
+
+    struct grid grid = grid_from_matrix(matrix);
+    return stencil_node(&grid, &stencil_five_point, STENCIL_PRECISION_SINGLE, 0.0, iterations, NULL, checkpoint,
+                        layout);
+}
+
+void five_point_stencil_client()
+{
+    stencil_client_with_descriptor(&stencil_five_point);
+}
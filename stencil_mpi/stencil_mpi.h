@@ -2,8 +2,102 @@
 #define __STENCIL_CILK_H
 
 #include <stencil/matrix.h>
+#include <stencil/descriptor.h>
+#include <stencil/convergence.h>
+#include <stencil/matrix_float.h>
+#include <stencil/checkpoint.h>
 
+/**
+ * Hybrid builds (STENCIL_HYBRID) calculate the block of every node with an OpenMP team
+ * (OMP_NUM_THREADS threads, the five-point stencil with the one vector variant of a
+ * stencil_openmp_engine_t, other stencils with stencil_with_descriptor). MPI is only
+ * called by the master thread, MPI has to be initialized with at least
+ * MPI_THREAD_FUNNELED. Single precision, SOR and the residual checks are calculated by
+ * the master thread alone.
+ */
 double five_point_stencil_host(stencil_matrix_t *matrix, size_t iterations);
 void five_point_stencil_client();
 
+/**
+ * Applies the stencil described by \a descriptor, the halo width is the matrix boundary
+ * (must be at least the stencil radius). All nodes have to use the same descriptor.
+ *
+ * @return returns the needed time for the calculation in msec (-1.0 on failure)
+ */
+double stencil_host_with_descriptor(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor,
+                                    size_t iterations);
+void stencil_client_with_descriptor(const stencil_descriptor_t *descriptor);
+
+/**
+ * Iterates until the global residual (MPI_Allreduce on every check iteration) drops below
+ * the tolerance. The clients receive the convergence parameters from the host, thus they
+ * use five_point_stencil_client / stencil_client_with_descriptor as well.
+ *
+ * @param convergence convergence parameters, receives the number of iterations and the last residual
+ * @return returns the needed time for the calculation in msec (-1.0 on failure)
+ */
+double stencil_host_until_converged(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor,
+                                    stencil_convergence_t *convergence);
+double five_point_stencil_host_until_converged(stencil_matrix_t *matrix, stencil_convergence_t *convergence);
+
+/**
+ * Five-point stencil on a single-precision matrix, the sub-matrices and the halos are
+ * transferred as MPI_FLOAT. The clients use five_point_stencil_client.
+ *
+ * @param precision arithmetic of the kernel (float or double with float storage)
+ * @return returns the needed time for the calculation in msec (-1.0 on failure)
+ */
+double five_point_stencil_host_float(stencil_matrix_float_t *matrix, size_t iterations, stencil_precision_t precision);
+
+/**
+ * Red-black SOR iterations, the halo is exchanged before each colour (two exchanges per
+ * iteration). The clients use five_point_stencil_client.
+ *
+ * @param omega relaxation factor (> 0, 1 is Gauss-Seidel, see stencil_sor_optimal_omega)
+ * @return returns the needed time for the calculation in msec (-1.0 on failure)
+ */
+double five_point_stencil_host_sor(stencil_matrix_t *matrix, double omega, size_t iterations);
+double five_point_stencil_host_sor_until_converged(stencil_matrix_t *matrix, double omega,
+                                                   stencil_convergence_t *convergence);
+
+/**
+ * Five-point stencil on the binary grid file \a input (see stencil/binary.h, dtype double),
+ * the result is written to the binary grid file \a output. Every node reads and writes only
+ * its own block with collective MPI-IO, no node holds the whole matrix. All nodes call this
+ * function (there is no client).
+ *
+ * @return returns the needed time for the calculation in msec on all nodes (-1.0 on failure)
+ */
+double five_point_stencil_file(const char *input, const char *output, size_t iterations);
+
+/**
+ * Files of the checkpoints of five_point_stencil_host_with_checkpoint.
+ */
+enum stencil_mpi_checkpoint {
+    STENCIL_MPI_CHECKPOINT_COLLECTIVE, // one grid file of the whole matrix
+    STENCIL_MPI_CHECKPOINT_PER_RANK    // every node writes its node matrix to filepath.<rank>
+};
+typedef enum stencil_mpi_checkpoint stencil_mpi_checkpoint_t;
+
+/**
+ * Five-point stencil with periodic checkpoints (see stencil/checkpoint.h), the nodes take
+ * them together (a checkpoint after \a seconds is agreed on with MPI_Allreduce). The
+ * clients use five_point_stencil_client.
+ *
+ * Collective: the nodes copy their blocks into a snapshot which is written to the grid
+ * file of the whole matrix with non-blocking collective MPI-IO, the write is completed
+ * when the next checkpoint is taken. A restart maps the checkpoint on master
+ * (stencil_checkpoint_restore) and passes it as \a matrix.
+ *
+ * Per rank: the nodes write their node matrices (with halo) to their own files with the
+ * background thread of a stencil_checkpoint_t. A restart passes the initial matrix, the
+ * nodes continue from their files if all of them have a checkpoint of the same iteration.
+ *
+ * @param iterations total number of iterations (including the restored ones)
+ * @return returns the needed time for the calculation in msec (-1.0 on failure), failed
+ *         checkpoints are reported by stencil_checkpoint_wait
+ */
+double five_point_stencil_host_with_checkpoint(stencil_matrix_t *matrix, size_t iterations,
+                                               stencil_checkpoint_t *checkpoint, stencil_mpi_checkpoint_t layout);
+
 #endif // __STENCIL_CILK_H
\ No newline at end of file
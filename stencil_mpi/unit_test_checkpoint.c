@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <mpi.h>
+
+#include <stencil/util.h>
+#include <stencil/checkpoint.h>
+
+#include "stencil_mpi.h"
+
+#define MASTER 0
+#define FILEPATH_SIZE 64
+
+#if defined(STENCIL_CHECKPOINT_PER_RANK)
+#define CHECKPOINT_LAYOUT STENCIL_MPI_CHECKPOINT_PER_RANK
+#else
+#define CHECKPOINT_LAYOUT STENCIL_MPI_CHECKPOINT_COLLECTIVE
+#endif
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stderr, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    if (MPI_Init(&argc, &argv) != MPI_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    if (rank != MASTER) {
+        five_point_stencil_client();
+        five_point_stencil_client();
+        MPI_Finalize();
+        return EXIT_SUCCESS;
+    }
+
+    char filepath[FILEPATH_SIZE] = "unit_test_checkpoint_XXXXXX";
+    close(mkstemp(filepath));
+
+    // the first run stops after 3 iterations
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+    if (matrix == NULL) {
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+    stencil_checkpoint_t *checkpoint = stencil_checkpoint_new(filepath, 1, 0.0);
+    five_point_stencil_host_with_checkpoint(matrix, 3, checkpoint, CHECKPOINT_LAYOUT);
+    stencil_checkpoint_free(checkpoint);
+
+    // the second run restarts from the checkpoints, the interior it gets is only
+    // correct if it is restored (the nodes restore their per-rank files)
+    checkpoint = stencil_checkpoint_new(filepath, 1, 0.0);
+    stencil_matrix_t *restored = stencil_checkpoint_restore(checkpoint);
+    if (restored != NULL) {
+        stencil_matrix_free(matrix);
+        matrix = restored;
+    } else {
+        for (size_t row = matrix->boundary; row < matrix->rows - matrix->boundary; row++) {
+            memset(stencil_matrix_get_ptr(matrix, row, matrix->boundary), 0,
+                   (matrix->cols - 2 * matrix->boundary) * sizeof(double));
+        }
+    }
+    // only the collective checkpoint is restored by master
+    const bool restarted = (CHECKPOINT_LAYOUT == STENCIL_MPI_CHECKPOINT_COLLECTIVE) ?
+                           (restored != NULL) && (checkpoint->iteration == 3) : (restored == NULL);
+
+    five_point_stencil_host_with_checkpoint(matrix, 5, checkpoint, CHECKPOINT_LAYOUT);
+    const bool written = stencil_checkpoint_free(checkpoint);
+
+    if (restarted && written) {
+        matrix_to_file(matrix, stdout);
+    }
+    stencil_matrix_free(matrix);
+
+    int nodes;
+    MPI_Comm_size(MPI_COMM_WORLD, &nodes);
+    for (int node = 0; node < nodes; node++) {
+        char node_filepath[FILEPATH_SIZE + 16];
+        sprintf(node_filepath, "%s.%d", filepath, node);
+        unlink(node_filepath);
+    }
+    unlink(filepath);
+
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <mpi.h>
+
+#include <stencil/util.h>
+#include <stencil/descriptor.h>
+
+#include "stencil_mpi.h"
+
+#define MASTER 0
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stderr, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    if (MPI_Init(&argc, &argv) != MPI_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    // five-point stencil, the zero weighted diagonal points force the exchange of the halo corners
+    const stencil_point_t points[] = {
+        {-1, -1, 0.0}, {-1, 0, 0.25}, {-1, 1, 0.0},
+        { 0, -1, 0.25},               { 0, 1, 0.25},
+        { 1, -1, 0.0}, { 1, 0, 0.25}, { 1, 1, 0.0}
+    };
+    stencil_descriptor_t *descriptor = stencil_descriptor_new(8, points);
+    if (descriptor == NULL) {
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    if (rank == MASTER) {
+        stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+        if (matrix == NULL) {
+            return EXIT_FAILURE;
+        }
+
+        stencil_host_with_descriptor(matrix, descriptor, 5);
+
+        matrix_to_file(matrix, stdout);
+        stencil_matrix_free(matrix);
+    } else {
+        stencil_client_with_descriptor(descriptor);
+    }
+
+    stencil_descriptor_free(descriptor);
+
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
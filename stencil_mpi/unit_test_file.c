@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <mpi.h>
+
+#include <stencil/util.h>
+#include <stencil/binary.h>
+
+#include "stencil_mpi.h"
+
+#define MASTER 0
+#define FILEPATH_SIZE 64
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stderr, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    if (MPI_Init(&argc, &argv) != MPI_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    // master converts the csv file to a binary grid file, all nodes use it
+    char input[FILEPATH_SIZE] = "unit_test_file_in_XXXXXX";
+    char output[FILEPATH_SIZE] = "unit_test_file_out_XXXXXX";
+    if (rank == MASTER) {
+        stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+        const int fd = mkstemp(input);
+        FILE *stream = (fd >= 0) ? fdopen(fd, "wb") : NULL;
+        if (matrix == NULL || stream == NULL || !stencil_binary_write(matrix, stream)) {
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+        fclose(stream);
+        stencil_matrix_free(matrix);
+        close(mkstemp(output));
+    }
+    MPI_Bcast(input, FILEPATH_SIZE, MPI_CHAR, MASTER, MPI_COMM_WORLD);
+    MPI_Bcast(output, FILEPATH_SIZE, MPI_CHAR, MASTER, MPI_COMM_WORLD);
+
+    const double elapsed_time = five_point_stencil_file(input, output, 5);
+
+    if (rank == MASTER) {
+        stencil_matrix_t *matrix = (elapsed_time >= 0.0) ? stencil_binary_map(output) : NULL;
+        if (matrix != NULL) {
+            matrix_to_file(matrix, stdout);
+            stencil_matrix_free(matrix);
+        }
+        unlink(input);
+        unlink(output);
+    }
+
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
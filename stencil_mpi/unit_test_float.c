@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <mpi.h>
+
+#include <stencil/util.h>
+
+#include "stencil_mpi.h"
+
+#define MASTER 0
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stderr, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    if (MPI_Init(&argc, &argv) != MPI_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    if (rank == MASTER) {
+        stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+        if (matrix == NULL) {
+            return EXIT_FAILURE;
+        }
+
+        stencil_matrix_float_t *matrix_float = stencil_matrix_float_from_matrix(matrix);
+        if (matrix_float == NULL) {
+            return EXIT_FAILURE;
+        }
+
+        five_point_stencil_host_float(matrix_float, 5, STENCIL_PRECISION_MIXED);
+
+        stencil_matrix_float_to_matrix(matrix_float, matrix);
+        matrix_to_file(matrix, stdout);
+        stencil_matrix_float_free(matrix_float);
+        stencil_matrix_free(matrix);
+    } else {
+        five_point_stencil_client();
+    }
+
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
@@ -16,9 +16,21 @@ int main(int argc, char **argv)
         return EXIT_FAILURE;
     }
 
+#if defined(STENCIL_HYBRID)
+    // only the master thread of the OpenMP teams calls MPI
+    int provided;
+    if (MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided) != MPI_SUCCESS) {
+        return EXIT_FAILURE;
+    }
+    if (provided < MPI_THREAD_FUNNELED) {
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+#else
     if (MPI_Init(&argc, &argv) != MPI_SUCCESS) {
         return EXIT_FAILURE;
     }
+#endif
 
     int rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
@@ -1,10 +1,15 @@
 #include <stdlib.h>
+#include <string.h>
 #include <float.h>
 #include <math.h>
+#include <unistd.h>
 
 #include <omp.h>
 
 #include <stencil/util.h>
+#include <stencil/kernel.h>
+#include <stencil/binary.h>
+#include <stencil/topology.h>
 
 #include "stencil_openmp/stencil_openmp.h"
 
@@ -24,13 +29,106 @@ int main(int argc, char **argv)
     size_t cols = strtol(argv[2], NULL, 10);
     size_t iterations = strtol(argv[3], NULL, 10);
     size_t threads = strtol(argv[4], NULL, 10);
+#if defined(STENCIL_CONVERGENCE)
+    // tolerance 0 (all iterations are done), measures the overhead of the residual checks
+    size_t check_interval = (argc > 5) ? strtol(argv[5], NULL, 10) : STENCIL_CONVERGENCE_CHECK_INTERVAL;
+    stencil_convergence_t convergence;
+#elif defined(STENCIL_SOR)
+    // the optimal relaxation factor of the grid is used by default
+    double omega = (argc > 5) ? strtod(argv[5], NULL) : 0.0;
+#elif defined(STENCIL_FLOAT)
+    // "mixed" calculates in double precision, the matrix is stored in single precision
+    stencil_precision_t precision = (argc > 5 && strcmp(argv[5], "mixed") == 0) ? STENCIL_PRECISION_MIXED
+                                                                              : STENCIL_PRECISION_SINGLE;
+#elif defined(STENCIL_STREAM)
+    // the grid file is streamed in place with a memory budget in MiB (default: an eighth of the grid)
+    size_t budget = rows * cols * sizeof(double) / 8;
+    if (argc > 5) {
+        const long budget_mib = strtol(argv[5], NULL, 10);
+        if (budget_mib <= 0) {
+            return EXIT_FAILURE;
+        }
+        budget = (size_t)budget_mib * 1024 * 1024;
+    }
+    const long time_steps = (argc > 6) ? strtol(argv[6], NULL, 10) : 4;
+    if (time_steps <= 0) {
+        return EXIT_FAILURE;
+    }
+#elif defined(STENCIL_FRAMES)
+    // a compressed snapshot every interval iterations, written to <prefix>.<iteration>
+    size_t interval = (argc > 5) ? strtol(argv[5], NULL, 10) : 10;
+    const char *prefix = (argc > 6) ? argv[6] : "openmp_benchmark_frame";
+#elif defined(STENCIL_ENGINE)
+    // variant of the engine: "tmp_matrix", "one_vector" or "one_vector_tld" (default)
+    const char *variant = (argc > 5) ? argv[5] : "one_vector_tld";
+    // the threads are pinned unless the sixth argument is 0
+    const bool pin = (argc > 6) ? strtol(argv[6], NULL, 10) != 0 : true;
+#elif defined(STENCIL_WAVEFRONT)
+    // rows and cols of the tiles (0: the defaults)
+    size_t tile_rows = (argc > 5) ? strtol(argv[5], NULL, 10) : 0;
+    size_t tile_cols = (argc > 6) ? strtol(argv[6], NULL, 10) : 0;
+#elif defined(STENCIL_TUNED)
+    // the first repetition measures the variants unless the wisdom file knows the class
+    const char *wisdom_path = (argc > 5) ? argv[5] : "openmp_benchmark.wisdom";
+#endif
 
     omp_set_num_threads(threads);
 
-    stencil_matrix_t *matrix = new_randomized_matrix(rows, cols, 1, 0, 100);
+    stencil_matrix_t *matrix = stencil_matrix_new(rows, cols, 1);
     if (matrix == NULL) {
         return EXIT_FAILURE;
     }
+    // the workers place the pages (STENCIL_NUMA=first-touch) before they are initialized
+    first_touch_matrix(matrix);
+    randomize_matrix(matrix, 0, 100);
+
+    // the page and NUMA policy which took effect (STENCIL_PAGES=normal|transparent|huge)
+    fprintf(stderr, "pages: %s\n", stencil_pages_name(matrix->pages));
+    stencil_matrix_numa_report(matrix, stderr);
+    // the order of the CPUs of the blockwise variants (STENCIL_PLACEMENT=topology)
+    if (stencil_topology_get_placement() == STENCIL_PLACEMENT_TOPOLOGY) {
+        stencil_topology_t *topology = stencil_topology_probe();
+        if (topology != NULL) {
+            stencil_topology_report(topology, stderr);
+            stencil_topology_free(topology);
+        }
+    }
+#if defined(STENCIL_SOR)
+    if (omega <= 0.0) {
+        omega = stencil_sor_optimal_omega(matrix);
+    }
+#endif
+#if defined(STENCIL_FLOAT)
+    stencil_matrix_float_t *matrix_float = stencil_matrix_float_from_matrix(matrix);
+    if (matrix_float == NULL) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+#elif defined(STENCIL_STREAM)
+    char filepath[] = "openmp_benchmark_stream_XXXXXX";
+    FILE *stream = fdopen(mkstemp(filepath), "wb");
+    const bool written = stencil_binary_write(matrix, stream);
+    fclose(stream);
+    if (!written) {
+        unlink(filepath);
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+#elif defined(STENCIL_ENGINE)
+    // the engine (team, buffers and pinning) is kept for all repetitions
+    stencil_openmp_engine_t *engine = stencil_openmp_engine_new(threads, pin);
+    if (engine == NULL) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "pinned: %s\n", engine->pinned ? "yes" : "no");
+#elif defined(STENCIL_TUNED)
+    stencil_wisdom_t *wisdom = stencil_wisdom_load(wisdom_path);
+    if (wisdom == NULL) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+#endif
 
     double min = DBL_MAX;
     double max = DBL_MIN;
@@ -48,6 +146,37 @@ int main(int argc, char **argv)
         const double elapsed_time = five_point_stencil_with_one_vector_columnwise_tld(matrix, iterations);
 #elif defined(STENCIL_ONE_VECTOR_BLOCKWISE_TLD)
         const double elapsed_time = five_point_stencil_with_one_vector_blockwise_tld(matrix, iterations);
+#elif defined(STENCIL_ONE_VECTOR_TLD_P2P)
+        const double elapsed_time = five_point_stencil_with_one_vector_tld_p2p(matrix, iterations);
+#elif defined(STENCIL_ONE_VECTOR_COLWISE_TLD_P2P)
+        const double elapsed_time = five_point_stencil_with_one_vector_columnwise_tld_p2p(matrix, iterations);
+#elif defined(STENCIL_ONE_VECTOR_BLOCKWISE_TLD_P2P)
+        const double elapsed_time = five_point_stencil_with_one_vector_blockwise_tld_p2p(matrix, iterations);
+#elif defined(STENCIL_DESCRIPTOR)
+        const double elapsed_time = stencil_with_descriptor(matrix, &stencil_five_point, iterations);
+#elif defined(STENCIL_CONVERGENCE)
+        stencil_convergence_init(&convergence, STENCIL_NORM_MAX, 0.0, check_interval, iterations);
+        const double elapsed_time = five_point_stencil_until_converged(matrix, &convergence);
+#elif defined(STENCIL_SOR)
+        const double elapsed_time = five_point_stencil_sor(matrix, omega, iterations);
+#elif defined(STENCIL_FLOAT)
+        const double elapsed_time = five_point_stencil_float(matrix_float, iterations, precision);
+#elif defined(STENCIL_STREAM)
+        const double elapsed_time = five_point_stencil_stream(filepath, filepath, iterations, time_steps, budget);
+#elif defined(STENCIL_FRAMES)
+        stencil_frames_t *frames = stencil_frames_new(prefix, STENCIL_FRAME_SNAPSHOT, matrix, interval, 0);
+        const double elapsed_time = five_point_stencil_with_frames(matrix, iterations, frames);
+        fprintf(stderr, "frames dropped: %zu\n", frames->dropped);
+        stencil_frames_free(frames);
+#elif defined(STENCIL_ENGINE)
+        const double elapsed_time =
+            (strcmp(variant, "tmp_matrix") == 0)   ? five_point_stencil_engine_tmp_matrix(engine, matrix, iterations)
+            : (strcmp(variant, "one_vector") == 0) ? five_point_stencil_engine_one_vector(engine, matrix, iterations)
+                                                   : five_point_stencil_engine_one_vector_tld(engine, matrix, iterations);
+#elif defined(STENCIL_WAVEFRONT)
+        const double elapsed_time = five_point_stencil_wavefront(matrix, iterations, tile_rows, tile_cols);
+#elif defined(STENCIL_TUNED)
+        const double elapsed_time = five_point_stencil_tuned(matrix, iterations, wisdom);
 #endif
         min = fmin(min, elapsed_time);
         max = fmax(max, elapsed_time);
@@ -57,6 +186,19 @@ int main(int argc, char **argv)
     const double avg = sum / BENCHMARK_ITERATIONS;
     fprintf(stdout, "%f;%f;%f", min, avg, max);
 
+#if defined(STENCIL_FLOAT)
+    stencil_matrix_float_free(matrix_float);
+#elif defined(STENCIL_STREAM)
+    unlink(filepath);
+#elif defined(STENCIL_ENGINE)
+    stencil_openmp_engine_free(engine);
+#elif defined(STENCIL_TUNED)
+    const stencil_wisdom_entry_t *entry = stencil_wisdom_lookup(wisdom, matrix->rows, matrix->cols, omp_get_max_threads());
+    if (entry != NULL) {
+        fprintf(stderr, "variant: %s (%d)\n", entry->variant, entry->param);
+    }
+    stencil_wisdom_free(wisdom);
+#endif
     stencil_matrix_free(matrix);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -1,46 +1,418 @@
 #include <stdlib.h>
+#include <math.h>
 #include <sys/time.h>
 #include <string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <float.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
 
 #include <omp.h>
 
 #include <stencil/matrix.h>
 #include <stencil/vector.h>
 #include <stencil/util.h>
+#include <stencil/kernel.h>
+#include <stencil/descriptor.h>
+#include <stencil/convergence.h>
+#include <stencil/binary.h>
+#include <stencil/pages.h>
+#include <stencil/topology.h>
 
 #include "stencil_openmp.h"
 
-inline double stencil_five_point_kernel(const stencil_matrix_t *const matrix, size_t row, size_t col)
+void first_touch_matrix(stencil_matrix_t *matrix)
+{
+    const size_t rows = matrix->rows - matrix->boundary;
+
+    // same rows per thread as the parallel loops of the calculation
+    #pragma omp parallel for schedule(static) shared(matrix)
+    for (size_t row = matrix->boundary; row < rows; row++) {
+        memset(stencil_matrix_get_ptr(matrix, row, 0), 0, matrix->stride * sizeof(double));
+    }
+
+    for (size_t row = 0; row < matrix->boundary; row++) {
+        memset(stencil_matrix_get_ptr(matrix, row, 0), 0, matrix->stride * sizeof(double));
+        memset(stencil_matrix_get_ptr(matrix, rows + row, 0), 0, matrix->stride * sizeof(double));
+    }
+}
+
+/**
+ * @return returns a copy of matrix \a matrix which is first touched (copied) in the
+ *         partitioning of the calculation, NULL on failure
+ */
+static stencil_matrix_t *first_touch_copy(const stencil_matrix_t *matrix)
 {
-    return (stencil_matrix_get(matrix, row - 1, col) +
-            stencil_matrix_get(matrix, row, col - 1) +
-            stencil_matrix_get(matrix, row, col + 1) +
-            stencil_matrix_get(matrix, row + 1, col)) * 0.25;
+    stencil_matrix_t *copy = stencil_matrix_new(matrix->rows, matrix->cols, matrix->boundary);
+    if (!copy) {
+        return NULL;
+    }
+
+    const size_t rows = matrix->rows - matrix->boundary;
+
+    #pragma omp parallel for schedule(static) shared(matrix, copy)
+    for (size_t row = matrix->boundary; row < rows; row++) {
+        memcpy(stencil_matrix_get_ptr(copy, row, 0), stencil_matrix_get_ptr(matrix, row, 0),
+               matrix->cols * sizeof(double));
+    }
+
+    for (size_t row = 0; row < matrix->boundary; row++) {
+        memcpy(stencil_matrix_get_ptr(copy, row, 0), stencil_matrix_get_ptr(matrix, row, 0),
+               matrix->cols * sizeof(double));
+        memcpy(stencil_matrix_get_ptr(copy, rows + row, 0), stencil_matrix_get_ptr(matrix, rows + row, 0),
+               matrix->cols * sizeof(double));
+    }
+
+    return copy;
 }
 
 double five_point_stencil_with_tmp_matrix(stencil_matrix_t *matrix, const size_t iterations)
 {
     assert(matrix->boundary >= 1);
 
-    stencil_matrix_t *tmp_matrix = stencil_matrix_get_submatrix(matrix, 0, 0, matrix->rows, matrix->cols, matrix->boundary);
+    stencil_matrix_t *tmp_matrix = first_touch_copy(matrix);
 
     const size_t rows = matrix->rows - matrix->boundary;
-    const size_t cols = matrix->cols - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
 
     const double t1 = omp_get_wtime();
 
     for (size_t iteration = 1; iteration <= iterations; iteration++) {
         #pragma omp parallel for schedule(static) shared(matrix, tmp_matrix)
         for (size_t row = matrix->boundary; row < rows; row++) {
-            for (size_t col = matrix->boundary; col < cols; col++) {
-                const double value = stencil_five_point_kernel(tmp_matrix, row, col);
-                stencil_matrix_set(matrix, row, col, value);
+            stencil_five_point_row(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                   cols);
+        }
+
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    }
+
+    const double t2 = omp_get_wtime();
+
+    if (iterations % 2 != 0) {
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    } else {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_copy_values(matrix, tmp_matrix);
+    }
+
+    stencil_matrix_free(tmp_matrix);
+
+    return (t2 - t1) * 1000.0;
+}
+
+double five_point_stencil_with_checkpoint(stencil_matrix_t *matrix, const size_t iterations,
+                                          stencil_checkpoint_t *checkpoint)
+{
+    assert(matrix->boundary >= 1);
+
+    stencil_matrix_t *tmp_matrix = first_touch_copy(matrix);
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+    const size_t first = checkpoint->iteration + 1;
+    const size_t count = (iterations >= first) ? iterations - first + 1 : 0;
+
+    const double t1 = omp_get_wtime();
+
+    for (size_t iteration = first; iteration <= iterations; iteration++) {
+        #pragma omp parallel for schedule(static) shared(matrix, tmp_matrix)
+        for (size_t row = matrix->boundary; row < rows; row++) {
+            stencil_five_point_row(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                   cols);
+        }
+
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+
+        // the tmp matrix holds the values of this iteration
+        if (stencil_checkpoint_is_due(checkpoint, iteration)) {
+            stencil_checkpoint_take(checkpoint, tmp_matrix, iteration);
+        }
+    }
+
+    const double t2 = omp_get_wtime();
+
+    if (count % 2 != 0) {
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    } else {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_copy_values(matrix, tmp_matrix);
+    }
+
+    stencil_matrix_free(tmp_matrix);
+
+    return (t2 - t1) * 1000.0;
+}
+
+double five_point_stencil_with_frames(stencil_matrix_t *matrix, const size_t iterations, stencil_frames_t *frames)
+{
+    assert(matrix->boundary >= 1);
+
+    stencil_matrix_t *tmp_matrix = first_touch_copy(matrix);
+    stencil_matrix_t *frame = NULL;
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    const double t1 = omp_get_wtime();
+
+    // one parallel region for all iterations, the frames are copied by all threads
+    #pragma omp parallel shared(matrix, tmp_matrix, frame)
+    for (size_t iteration = 1; iteration <= iterations; iteration++) {
+        #pragma omp for schedule(static)
+        for (size_t row = matrix->boundary; row < rows; row++) {
+            stencil_five_point_row(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                   cols);
+        }
+
+        #pragma omp single
+        {
+            stencil_matrix_t *tmp = tmp_matrix;
+            tmp_matrix = matrix;
+            matrix = tmp;
+
+            // the tmp matrix holds the values of this iteration (NULL: the frame is dropped)
+            frame = stencil_frames_is_due(frames, iteration) ? stencil_frames_acquire(frames, tmp_matrix) : NULL;
+        }
+
+        if (frame != NULL) {
+            #pragma omp for schedule(static)
+            for (size_t row = 0; row < tmp_matrix->rows; row++) {
+                memcpy(stencil_matrix_get_ptr(frame, row, 0), stencil_matrix_get_ptr(tmp_matrix, row, 0),
+                       tmp_matrix->cols * sizeof(double));
+            }
+
+            // the next iteration does not write the tmp matrix
+            #pragma omp single nowait
+            stencil_frames_publish(frames, iteration);
+        }
+    }
+
+    const double t2 = omp_get_wtime();
+
+    if (iterations % 2 != 0) {
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    } else {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_copy_values(matrix, tmp_matrix);
+    }
+
+    stencil_matrix_free(tmp_matrix);
+
+    return (t2 - t1) * 1000.0;
+}
+
+/**
+ * One iteration from \a tmp_matrix to \a matrix, the partial residuals of the rows
+ * are reduced over all threads.
+ */
+static double five_point_iteration_with_residual(stencil_matrix_t *matrix, const stencil_matrix_t *tmp_matrix,
+                                                 stencil_norm_t norm)
+{
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    double residual = 0.0;
+
+    if (norm == STENCIL_NORM_MAX) {
+        #pragma omp parallel for schedule(static) shared(matrix, tmp_matrix) reduction(max : residual)
+        for (size_t row = matrix->boundary; row < rows; row++) {
+            residual = fmax(residual,
+                            stencil_five_point_row_residual(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                                            stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                                            stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                                            stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                                            cols, norm));
+        }
+    } else {
+        #pragma omp parallel for schedule(static) shared(matrix, tmp_matrix) reduction(+ : residual)
+        for (size_t row = matrix->boundary; row < rows; row++) {
+            residual += stencil_five_point_row_residual(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                                        stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                                        stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                                        stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                                        cols, norm);
+        }
+    }
+
+    return residual;
+}
+
+double five_point_stencil_until_converged(stencil_matrix_t *matrix, stencil_convergence_t *convergence)
+{
+    assert(matrix->boundary >= 1);
+
+    stencil_matrix_t *tmp_matrix = first_touch_copy(matrix);
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    size_t iterations = 0;
+
+    const double t1 = omp_get_wtime();
+
+    while (iterations < convergence->max_iterations) {
+        const size_t iteration = ++iterations;
+
+        bool converged = false;
+        if (stencil_convergence_is_check(convergence, iteration)) {
+            const double residual = five_point_iteration_with_residual(matrix, tmp_matrix, convergence->norm);
+            converged = stencil_convergence_update(convergence, iteration, residual);
+        } else {
+            #pragma omp parallel for schedule(static) shared(matrix, tmp_matrix)
+            for (size_t row = matrix->boundary; row < rows; row++) {
+                stencil_five_point_row(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                       stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                       stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                       stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                       cols);
             }
         }
 
         stencil_matrix_t *tmp = tmp_matrix;
         tmp_matrix = matrix;
         matrix = tmp;
+
+        if (converged) {
+            break;
+        }
+    }
+
+    const double t2 = omp_get_wtime();
+
+    if (iterations % 2 != 0) {
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    } else {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_copy_values(matrix, tmp_matrix);
+    }
+
+    stencil_matrix_free(tmp_matrix);
+
+    return (t2 - t1) * 1000.0;
+}
+
+/**
+ * One half-sweep of the red-black SOR on the fields of colour \a colour, the rows are
+ * independent (the fields of a colour only depend on fields of the other colour).
+ *
+ * @return returns the residual of the updated fields reduced over all threads
+ */
+static double five_point_half_sweep_sor(stencil_matrix_t *matrix, stencil_colour_t colour, double omega,
+                                        stencil_norm_t norm)
+{
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    double residual = 0.0;
+
+    if (norm == STENCIL_NORM_MAX) {
+        #pragma omp parallel for schedule(static) shared(matrix) reduction(max : residual)
+        for (size_t row = matrix->boundary; row < rows; row++) {
+            residual = fmax(residual,
+                            stencil_five_point_row_sor(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                                       stencil_matrix_get_ptr(matrix, row - 1, matrix->boundary),
+                                                       stencil_matrix_get_ptr(matrix, row + 1, matrix->boundary),
+                                                       cols, stencil_sor_first(matrix, row, colour, 0), omega, norm));
+        }
+    } else {
+        #pragma omp parallel for schedule(static) shared(matrix) reduction(+ : residual)
+        for (size_t row = matrix->boundary; row < rows; row++) {
+            residual += stencil_five_point_row_sor(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                                   stencil_matrix_get_ptr(matrix, row - 1, matrix->boundary),
+                                                   stencil_matrix_get_ptr(matrix, row + 1, matrix->boundary),
+                                                   cols, stencil_sor_first(matrix, row, colour, 0), omega, norm);
+        }
+    }
+
+    return residual;
+}
+
+double five_point_stencil_sor(stencil_matrix_t *matrix, double omega, const size_t iterations)
+{
+    assert(matrix->boundary >= 1);
+
+    const double t1 = omp_get_wtime();
+
+    for (size_t iteration = 1; iteration <= iterations; iteration++) {
+        five_point_half_sweep_sor(matrix, STENCIL_RED, omega, STENCIL_NORM_MAX);
+        five_point_half_sweep_sor(matrix, STENCIL_BLACK, omega, STENCIL_NORM_MAX);
+    }
+
+    const double t2 = omp_get_wtime();
+
+    return (t2 - t1) * 1000.0;
+}
+
+double five_point_stencil_sor_until_converged(stencil_matrix_t *matrix, double omega, stencil_convergence_t *convergence)
+{
+    assert(matrix->boundary >= 1);
+
+    const stencil_norm_t norm = convergence->norm;
+
+    const double t1 = omp_get_wtime();
+
+    for (size_t iteration = 1; iteration <= convergence->max_iterations; iteration++) {
+        const double red = five_point_half_sweep_sor(matrix, STENCIL_RED, omega, norm);
+        const double black = five_point_half_sweep_sor(matrix, STENCIL_BLACK, omega, norm);
+
+        if (stencil_convergence_is_check(convergence, iteration) &&
+            stencil_convergence_update(convergence, iteration, stencil_residual_combine(norm, red, black))) {
+            break;
+        }
+    }
+
+    const double t2 = omp_get_wtime();
+
+    return (t2 - t1) * 1000.0;
+}
+
+double stencil_with_descriptor(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor, const size_t iterations)
+{
+    assert(matrix->boundary >= descriptor->radius);
+
+    stencil_matrix_t *tmp_matrix = first_touch_copy(matrix);
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    const double t1 = omp_get_wtime();
+
+    for (size_t iteration = 1; iteration <= iterations; iteration++) {
+        #pragma omp parallel for schedule(static) shared(matrix, tmp_matrix)
+        for (size_t row = matrix->boundary; row < rows; row++) {
+            stencil_descriptor_row(descriptor, stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                   tmp_matrix, row, matrix->boundary, cols);
+        }
+
+        stencil_matrix_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
     }
 
     const double t2 = omp_get_wtime();
@@ -49,6 +421,9 @@ double five_point_stencil_with_tmp_matrix(stencil_matrix_t *matrix, const size_t
         stencil_matrix_t *tmp = tmp_matrix;
         tmp_matrix = matrix;
         matrix = tmp;
+    } else {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_copy_values(matrix, tmp_matrix);
     }
 
     stencil_matrix_free(tmp_matrix);
@@ -60,7 +435,7 @@ double five_point_stencil_with_one_vector(stencil_matrix_t *matrix, const size_t
 {
     assert(matrix->boundary >= 1);
 
-    const size_t cols = matrix->cols - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
 
     double wall_time = 0.0;
 
@@ -82,22 +457,27 @@ double five_point_stencil_with_one_vector(stencil_matrix_t *matrix, const size_t
 
         for (size_t iteration = 1; iteration <= iterations; iteration++) {
             // calculate the first and last row
-            for (size_t col = matrix->boundary; col < cols; col++) {
-                stencil_vector_set(vec, col, stencil_five_point_kernel(matrix, start_row, col));
-                stencil_vector_set(last_vec, col, stencil_five_point_kernel(matrix, end_row, col));
-            }
+            stencil_five_point_row(stencil_vector_get_ptr(vec, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, start_row - 1, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, start_row, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, start_row + 1, matrix->boundary),
+                                   cols);
+            stencil_five_point_row(stencil_vector_get_ptr(last_vec, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, end_row - 1, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, end_row, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, end_row + 1, matrix->boundary),
+                                   cols);
 
             // wait until all threads have filled the first and last row
             #pragma omp barrier
 
-            // calculate the remaining rows
+            // calculate the remaining rows (copies back the previously calculated row)
             for (size_t row = start_row + 1; row < end_row; row++) {
-                for (size_t col = matrix->boundary; col < cols; col++) {
-                    const double value = stencil_five_point_kernel(matrix, row, col);
-                    // copy back the previosly calculated value before we overwrite it
-                    stencil_matrix_set(matrix, row - 1, col, stencil_vector_get(vec, col));
-                    stencil_vector_set(vec, col, value);
-                }
+                stencil_five_point_row_one_vector(stencil_matrix_get_ptr(matrix, row - 1, matrix->boundary),
+                                                  stencil_vector_get_ptr(vec, matrix->boundary),
+                                                  stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                                  stencil_matrix_get_ptr(matrix, row + 1, matrix->boundary),
+                                                  cols);
             }
             stencil_matrix_set_row(matrix, end_row - 1, vec);
 
@@ -156,7 +536,7 @@ double five_point_stencil_with_one_vector_tld(stencil_matrix_t *matrix, const si
         stencil_matrix_t *submatrix_below = is_last_thread ? NULL : submatrices[thread + 1];
 
         const size_t rows = submatrix->rows - submatrix->boundary;
-        const size_t cols = submatrix->cols - submatrix->boundary;
+        const size_t cols = submatrix->cols - 2 * submatrix->boundary;
 
         const double t1 = omp_get_wtime();
 
@@ -185,18 +565,19 @@ double five_point_stencil_with_one_vector_tld(stencil_matrix_t *matrix, const si
 
             // calculate the first row
             const size_t first_row = submatrix->boundary;
-            for (size_t col = submatrix->boundary; col < cols; col++) {
-                stencil_vector_set(tmp, col, stencil_five_point_kernel(submatrix, first_row, col));
-            }
+            stencil_five_point_row(stencil_vector_get_ptr(tmp, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row - 1, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row + 1, submatrix->boundary),
+                                   cols);
 
-            // calculate the remaining rows
+            // calculate the remaining rows (copies back the previously calculated row)
             for (size_t row = first_row + 1; row < rows; row++) {
-                for (size_t col = submatrix->boundary; col < cols; col++) {
-                    const double value = stencil_five_point_kernel(submatrix, row, col);
-                    // copy back the previosly calculated value before we overwrite it
-                    stencil_matrix_set(submatrix, row - 1, col, stencil_vector_get(tmp, col));
-                    stencil_vector_set(tmp, col, value);
-                }
+                stencil_five_point_row_one_vector(stencil_matrix_get_ptr(submatrix, row - 1, submatrix->boundary),
+                                                  stencil_vector_get_ptr(tmp, submatrix->boundary),
+                                                  stencil_matrix_get_ptr(submatrix, row, submatrix->boundary),
+                                                  stencil_matrix_get_ptr(submatrix, row + 1, submatrix->boundary),
+                                                  cols);
             }
 
             // copy back calculated values of the last non-boundary row
@@ -239,6 +620,11 @@ double five_point_stencil_with_one_vector_columnwise(stencil_matrix_t *matrix, c
 
         stencil_vector_t *vec = stencil_vector_new(matrix->rows);
         stencil_vector_t *last_vec = stencil_vector_new(matrix->rows);
+        stencil_vector_t *row_vec = stencil_vector_new(matrix->cols);
+
+        // the inner columns of the band are calculated row by row (vectorized row kernel)
+        const size_t inner_col = start_col + 1;
+        const size_t inner_cols = (end_col > inner_col) ? (end_col - inner_col) : 0;
 
         const double t1 = omp_get_wtime();
 
@@ -253,17 +639,26 @@ double five_point_stencil_with_one_vector_columnwise(stencil_matrix_t *matrix, c
             #pragma omp barrier
 
             // calculate the remaining cols
-            for (size_t col = start_col + 1; col < end_col; col++) {
-                for (size_t row = matrix->boundary; row < rows; row++) {
-                    const double value = stencil_five_point_kernel(matrix, row, col);
-                    // copy back the previosly calculated value before we overwrite it
-                    stencil_matrix_set(matrix, row, col - 1, stencil_vector_get(vec, row));
-                    stencil_vector_set(vec, row, value);
+            if (inner_cols > 0) {
+                const size_t first_row = matrix->boundary;
+                stencil_five_point_row(stencil_vector_get_ptr(row_vec, inner_col),
+                                       stencil_matrix_get_ptr(matrix, first_row - 1, inner_col),
+                                       stencil_matrix_get_ptr(matrix, first_row, inner_col),
+                                       stencil_matrix_get_ptr(matrix, first_row + 1, inner_col),
+                                       inner_cols);
+                for (size_t row = first_row + 1; row < rows; row++) {
+                    stencil_five_point_row_one_vector(stencil_matrix_get_ptr(matrix, row - 1, inner_col),
+                                                      stencil_vector_get_ptr(row_vec, inner_col),
+                                                      stencil_matrix_get_ptr(matrix, row, inner_col),
+                                                      stencil_matrix_get_ptr(matrix, row + 1, inner_col),
+                                                      inner_cols);
                 }
+                memcpy(stencil_matrix_get_ptr(matrix, rows - 1, inner_col),
+                       stencil_vector_get_ptr(row_vec, inner_col), inner_cols * sizeof(double));
             }
-            stencil_matrix_set_column(matrix, end_col - 1, vec);
 
-            // copy back the last column
+            // copy back the first and last column
+            stencil_matrix_set_column(matrix, start_col, vec);
             stencil_matrix_set_column(matrix, end_col, last_vec);
 
             // wait for all threads before we start with the next iteration
@@ -274,6 +669,7 @@ double five_point_stencil_with_one_vector_columnwise(stencil_matrix_t *matrix, c
 
         stencil_vector_free(vec);
         stencil_vector_free(last_vec);
+        stencil_vector_free(row_vec);
 
         wall_time = (t2 - t1) * 1000.0;
     }
@@ -281,6 +677,10 @@ double five_point_stencil_with_one_vector_columnwise(stencil_matrix_t *matrix, c
     return wall_time;
 }
 
+/**
+ * Copies the inner rows (without the halo rows, thus not the corners) of column \a src_col
+ * of \a src to column \a dest_col of \a dest.
+ */
 inline void stencil_matrix_copy_column(stencil_matrix_t *restrict src, stencil_matrix_t *restrict dest,
                                        size_t src_col, size_t dest_col)
 {
@@ -294,8 +694,8 @@ inline void stencil_matrix_copy_column(stencil_matrix_t *restrict src, stencil_m
 
     while(src_it != src_end) {
         *dest_it = *src_it;
-        src_it += src->cols;
-        dest_it += dest->cols;
+        src_it += src->stride;
+        dest_it += dest->stride;
     }
 }
 
@@ -323,7 +723,7 @@ double five_point_stencil_with_one_vector_columnwise_tld(stencil_matrix_t *matri
                                                                    start_col - 1,
                                                                    matrix->rows - 2 * matrix->boundary + 2,
                                                                    end_col - start_col + 2, 1);
-        stencil_vector_t *tmp = stencil_vector_new(submatrix->rows);
+        stencil_vector_t *tmp = stencil_vector_new(submatrix->cols);
 
         // exchange matrix pointers with neighbouring threads
         #pragma omp single
@@ -336,7 +736,7 @@ double five_point_stencil_with_one_vector_columnwise_tld(stencil_matrix_t *matri
         stencil_matrix_t *submatrix_right = is_last_thread ? NULL : submatrices[thread + 1];
 
         const size_t rows = submatrix->rows - submatrix->boundary;
-        const size_t cols = submatrix->cols - submatrix->boundary;
+        const size_t cols = submatrix->cols - 2 * submatrix->boundary;
 
         const double t1 = omp_get_wtime();
 
@@ -359,24 +759,25 @@ double five_point_stencil_with_one_vector_columnwise_tld(stencil_matrix_t *matri
                 #pragma omp barrier
             }
 
-            // calculate the first col
-            const size_t first_col = submatrix->boundary;
-            for (size_t row = submatrix->boundary; row < rows; row++) {
-                stencil_vector_set(tmp, row, stencil_five_point_kernel(submatrix, row, first_col));
-            }
+            // calculate the first row of the band
+            const size_t first_row = submatrix->boundary;
+            stencil_five_point_row(stencil_vector_get_ptr(tmp, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row - 1, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row + 1, submatrix->boundary),
+                                   cols);
 
-            // calculate the remaining cols
-            for (size_t col = first_col + 1; col < cols; col++) {
-                for (size_t row = submatrix->boundary; row < rows; row++) {
-                    const double value = stencil_five_point_kernel(submatrix, row, col);
-                    // copy back the previosly calculated value before we overwrite it
-                    stencil_matrix_set(submatrix, row, col - 1, stencil_vector_get(tmp, row));
-                    stencil_vector_set(tmp, row, value);
-                }
+            // calculate the remaining rows of the band (copies back the previously calculated row)
+            for (size_t row = first_row + 1; row < rows; row++) {
+                stencil_five_point_row_one_vector(stencil_matrix_get_ptr(submatrix, row - 1, submatrix->boundary),
+                                                  stencil_vector_get_ptr(tmp, submatrix->boundary),
+                                                  stencil_matrix_get_ptr(submatrix, row, submatrix->boundary),
+                                                  stencil_matrix_get_ptr(submatrix, row + 1, submatrix->boundary),
+                                                  cols);
             }
 
-            // copy back calculated values of the last non-boundary col
-            stencil_matrix_set_column(submatrix, cols - 1, tmp);
+            // copy back calculated values of the last non-boundary row
+            stencil_matrix_set_row(submatrix, rows - 1, tmp);
         }
 
         const double t2 = omp_get_wtime();
@@ -435,6 +836,75 @@ static void optimize_dims_for_matrix(int dims[], stencil_matrix_t *matrix)
     }
 }
 
+/**
+ * Placement of the threads of a team of the blockwise variants, set up by the calling
+ * thread before the parallel region (see stencil/topology.h).
+ */
+struct placement {
+    stencil_topology_t *topology; // NULL unless the placement is STENCIL_PLACEMENT_TOPOLOGY
+    stencil_affinity_t affinity;  // of the calling thread, restored after the region
+    int threads;                  // threads of the team
+    size_t group_size;            // threads of the team sharing a cache, 0 if none
+};
+
+/**
+ * Probes the topology of the CPUs of the calling thread (its current affinity) and the
+ * groups of a team of omp_get_max_threads() threads. The threads are only pinned if the
+ * affinity of the calling thread can be saved.
+ */
+static void placement_begin(struct placement *placement)
+{
+    placement->topology = NULL;
+    placement->threads = omp_get_max_threads();
+    placement->group_size = 0;
+
+    if (stencil_topology_get_placement() != STENCIL_PLACEMENT_TOPOLOGY ||
+        !stencil_topology_get_affinity(&placement->affinity)) {
+        return;
+    }
+
+    placement->topology = stencil_topology_probe();
+    if (placement->topology != NULL) {
+        placement->group_size = stencil_topology_group_size(placement->topology, placement->threads);
+    }
+}
+
+/**
+ * Restores the affinity of the calling thread for all threads of the team which may
+ * have been pinned by place_thread.
+ */
+static void placement_end(struct placement *placement)
+{
+    if (placement->topology == NULL) {
+        return;
+    }
+
+    #pragma omp parallel num_threads(placement->threads) shared(placement)
+    {
+        stencil_topology_set_affinity(&placement->affinity);
+    }
+
+    stencil_topology_free(placement->topology);
+    placement->topology = NULL;
+}
+
+/**
+ * Pins the calling thread of a team of \a threads threads to its CPU of the topology and
+ * returns the position of its block in the grid of blocks \a dims: the threads which
+ * share a cache get neighbouring blocks. The mapping does not depend on the pinning (all
+ * threads use the same group size), without groups the blocks are mapped row by row.
+ */
+static void place_thread(const struct placement *placement, const int dims[], int thread, int threads, size_t *x,
+                         size_t *y)
+{
+    if (placement->topology != NULL) {
+        stencil_topology_pin(placement->topology, thread);
+    }
+
+    const size_t group_size = (threads == placement->threads) ? placement->group_size : 0;
+    stencil_topology_block(group_size, dims[DIM_HORIZONTAL], dims[DIM_VERTICAL], thread, y, x);
+}
+
 double five_point_stencil_with_one_vector_blockwise_tld(stencil_matrix_t *matrix, const size_t iterations)
 {
     assert(matrix->boundary >= 1);
@@ -443,7 +913,11 @@ double five_point_stencil_with_one_vector_blockwise_tld(stencil_matrix_t *matrix
 
     stencil_matrix_t **submatrices;
 
-    #pragma omp parallel shared(matrix, submatrices) reduction(max : wall_time)
+    struct placement placement;
+    placement_begin(&placement);
+
+    #pragma omp parallel num_threads(placement.threads) shared(matrix, submatrices, placement) \
+        reduction(max : wall_time)
     {
         const int thread = omp_get_thread_num();
         const int threads = omp_get_num_threads();
@@ -455,18 +929,23 @@ double five_point_stencil_with_one_vector_blockwise_tld(stencil_matrix_t *matrix
         const size_t threads_horizontal = dims[DIM_HORIZONTAL];
         const size_t threads_vertical = dims[DIM_VERTICAL];
 
-        assert(((matrix->rows - 2 * matrix->boundary) % threads_vertical) == 0);
-        assert(((matrix->cols - 2 * matrix->boundary) % threads_horizontal) == 0);
+        size_t x;
+        size_t y;
+        place_thread(&placement, dims, thread, threads, &x, &y);
 
-        const size_t rows_per_thread = (matrix->rows - 2 * matrix->boundary) / threads_vertical;
-        const size_t cols_per_thread = (matrix->cols - 2 * matrix->boundary) / threads_horizontal;
-
-        const size_t x = thread % threads_horizontal;
-        const size_t y = thread / threads_horizontal;
+        // the blocks differ by at most one row and col
+        size_t start_row;
+        size_t start_col;
+        const size_t rows_per_thread = partition_range(matrix->rows - 2 * matrix->boundary, threads_vertical, y,
+                                                       &start_row);
+        const size_t cols_per_thread = partition_range(matrix->cols - 2 * matrix->boundary, threads_horizontal, x,
+                                                       &start_col);
+        start_row += matrix->boundary;
+        start_col += matrix->boundary;
 
         stencil_matrix_t *submatrix = stencil_matrix_get_submatrix(matrix,
-                                                                   y * rows_per_thread,
-                                                                   x * cols_per_thread,
+                                                                   start_row - 1,
+                                                                   start_col - 1,
                                                                    rows_per_thread + 2,
                                                                    cols_per_thread + 2, 1);
         stencil_vector_t *tmp = stencil_vector_new(submatrix->cols);
@@ -488,7 +967,7 @@ double five_point_stencil_with_one_vector_blockwise_tld(stencil_matrix_t *matrix
         stencil_matrix_t *submatrix_right = has_right ? submatrices[y * threads_horizontal + (x + 1)] : NULL;
 
         const size_t rows = submatrix->rows - submatrix->boundary;
-        const size_t cols = submatrix->cols - submatrix->boundary;
+        const size_t cols = submatrix->cols - 2 * submatrix->boundary;
 
         const double t1 = omp_get_wtime();
 
@@ -498,17 +977,20 @@ double five_point_stencil_with_one_vector_blockwise_tld(stencil_matrix_t *matrix
             if (iteration > 1) {
                 #pragma omp barrier
 
+                // only the inner values of the rows and cols are copied, the corners are not
+                // used by the stencil and would race with the copies of the other neighbours
                 if (submatrix_above != NULL) {
                     // exchange top
-                    double *src = stencil_matrix_get_ptr(submatrix, 1, 0);
-                    double *dest = stencil_matrix_get_ptr(submatrix_above, submatrix_above->rows - 1, 0);
-                    memcpy(dest, src, submatrix->cols * sizeof(double));
+                    double *src = stencil_matrix_get_ptr(submatrix, 1, submatrix->boundary);
+                    double *dest = stencil_matrix_get_ptr(submatrix_above, submatrix_above->rows - 1,
+                                                          submatrix_above->boundary);
+                    memcpy(dest, src, cols * sizeof(double));
                 }
                 if (submatrix_below != NULL) {
                     // exchange bottom
-                    double *src = stencil_matrix_get_ptr(submatrix, submatrix->rows - 2, 0);
-                    double *dest = stencil_matrix_get_ptr(submatrix_below, 0, 0);
-                    memcpy(dest, src, submatrix->cols * sizeof(double));
+                    double *src = stencil_matrix_get_ptr(submatrix, submatrix->rows - 2, submatrix->boundary);
+                    double *dest = stencil_matrix_get_ptr(submatrix_below, 0, submatrix_below->boundary);
+                    memcpy(dest, src, cols * sizeof(double));
                 }
                 if (submatrix_left != NULL) {
                     // exchange left column
@@ -525,18 +1007,19 @@ double five_point_stencil_with_one_vector_blockwise_tld(stencil_matrix_t *matrix
 
             // calculate the first row
             const size_t first_row = submatrix->boundary;
-            for (size_t col = submatrix->boundary; col < cols; col++) {
-                stencil_vector_set(tmp, col, stencil_five_point_kernel(submatrix, first_row, col));
-            }
+            stencil_five_point_row(stencil_vector_get_ptr(tmp, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row - 1, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row + 1, submatrix->boundary),
+                                   cols);
 
-            // calculate the remaining rows
+            // calculate the remaining rows (copies back the previously calculated row)
             for (size_t row = first_row + 1; row < rows; row++) {
-                for (size_t col = submatrix->boundary; col < cols; col++) {
-                    const double value = stencil_five_point_kernel(submatrix, row, col);
-                    // copy back the previosly calculated value before we overwrite it
-                    stencil_matrix_set(submatrix, row - 1, col, stencil_vector_get(tmp, col));
-                    stencil_vector_set(tmp, col, value);
-                }
+                stencil_five_point_row_one_vector(stencil_matrix_get_ptr(submatrix, row - 1, submatrix->boundary),
+                                                  stencil_vector_get_ptr(tmp, submatrix->boundary),
+                                                  stencil_matrix_get_ptr(submatrix, row, submatrix->boundary),
+                                                  stencil_matrix_get_ptr(submatrix, row + 1, submatrix->boundary),
+                                                  cols);
             }
 
             // copy back calculated values of the last non-boundary row
@@ -545,7 +1028,7 @@ double five_point_stencil_with_one_vector_blockwise_tld(stencil_matrix_t *matrix
 
         const double t2 = omp_get_wtime();
 
-        stencil_matrix_set_submatrix(matrix, y * rows_per_thread + 1, x * cols_per_thread + 1, submatrix);
+        stencil_matrix_set_submatrix(matrix, start_row, start_col, submatrix);
         stencil_matrix_free(submatrix);
 
         stencil_vector_free(tmp);
@@ -553,7 +1036,1278 @@ double five_point_stencil_with_one_vector_blockwise_tld(stencil_matrix_t *matrix
         wall_time = (t2 - t1) * 1000.0;
     }
 
+    placement_end(&placement);
     free(submatrices);
 
     return wall_time;
 }
+
+/**
+ * Progress of the partition of a thread, padded to a cache line because the counters
+ * are polled by the threads of the neighbouring partitions.
+ */
+struct partition_progress {
+    size_t computed;  // iterations calculated
+    size_t exchanged; // iterations whose boundary has been copied to the neighbours
+    char padding[STENCIL_MATRIX_ALIGNMENT - 2 * sizeof(size_t)];
+};
+
+#define PROGRESS_SPINS 1024 // polls of a progress counter before the thread yields the CPU
+
+enum partitioning {
+    PARTITION_ROWS,
+    PARTITION_COLUMNS,
+    PARTITION_BLOCKS
+};
+
+/**
+ * Waits until the progress counter \a counter of a neighbour has reached \a value.
+ */
+static void wait_for_progress(const size_t *counter, size_t value)
+{
+    for (size_t spins = 1; __atomic_load_n(counter, __ATOMIC_ACQUIRE) < value; spins++) {
+        if (spins % PROGRESS_SPINS == 0) {
+            sched_yield(); // the neighbour may wait for the same CPU
+        }
+    }
+}
+
+/**
+ * tld iterations without barriers: every thread only waits for its neighbours. Before
+ * the boundary of iteration i is copied into the submatrix of a neighbour, the neighbour
+ * must have calculated iteration i - 1 (it reads its boundary in that iteration), and
+ * iteration i starts once all neighbours have copied their boundary.
+ *
+ * @param threads_horizontal threads per row of blocks, divides the number of threads
+ *                           (0: optimize_dims_for_matrix)
+ */
+static double five_point_stencil_tld_p2p(stencil_matrix_t *matrix, const size_t iterations,
+                                         enum partitioning partitioning, int threads_horizontal)
+{
+    assert(matrix->boundary >= 1);
+
+    double wall_time = 0.0;
+
+    stencil_matrix_t **submatrices;
+
+    struct partition_progress *progress;
+    if (posix_memalign((void **)&progress, STENCIL_MATRIX_ALIGNMENT,
+                       omp_get_max_threads() * sizeof(struct partition_progress)) != 0) {
+        return -1.0;
+    }
+
+    struct placement placement;
+    placement_begin(&placement);
+
+    #pragma omp parallel num_threads(placement.threads) shared(matrix, submatrices, progress, placement) \
+        reduction(max : wall_time)
+    {
+        const int thread = omp_get_thread_num();
+        const int threads = omp_get_num_threads();
+
+        int dims[DIMENSIONS] = {threads, 1};
+        if (partitioning == PARTITION_ROWS) {
+            dims[DIM_HORIZONTAL] = 1;
+            dims[DIM_VERTICAL] = threads;
+        } else if (partitioning == PARTITION_BLOCKS && threads_horizontal > 0) {
+            dims[DIM_HORIZONTAL] = threads_horizontal;
+            dims[DIM_VERTICAL] = threads / threads_horizontal;
+        } else if (partitioning == PARTITION_BLOCKS) {
+            optimize_dims_for_matrix(dims, matrix);
+        }
+
+        const size_t threads_horizontal = dims[DIM_HORIZONTAL];
+        const size_t threads_vertical = dims[DIM_VERTICAL];
+
+        // the submatrices and progress counters are indexed by the position of the partition
+        size_t x;
+        size_t y;
+        place_thread(&placement, dims, thread, threads, &x, &y);
+        const size_t partition = y * threads_horizontal + x;
+
+        // the partitions differ by at most one row and col
+        size_t start_row;
+        size_t start_col;
+        const size_t rows_per_thread = partition_range(matrix->rows - 2 * matrix->boundary, threads_vertical, y,
+                                                       &start_row);
+        const size_t cols_per_thread = partition_range(matrix->cols - 2 * matrix->boundary, threads_horizontal, x,
+                                                       &start_col);
+        start_row += matrix->boundary;
+        start_col += matrix->boundary;
+        const size_t end_row = start_row + rows_per_thread;
+        const size_t end_col = start_col + cols_per_thread;
+
+        stencil_matrix_t *submatrix = stencil_matrix_get_submatrix(matrix, start_row - 1, start_col - 1,
+                                                                   end_row - start_row + 2,
+                                                                   end_col - start_col + 2, 1);
+        stencil_vector_t *tmp = stencil_vector_new(submatrix->cols);
+
+        // exchange matrix pointers with neighbouring threads
+        #pragma omp single
+        {
+            submatrices = (stencil_matrix_t **)malloc(threads * sizeof(stencil_matrix_t *));
+        }
+        submatrices[partition] = submatrix;
+        progress[partition].computed = 0;
+        progress[partition].exchanged = 0;
+        #pragma omp barrier
+        const int above = (y > 0) ? (int)((y - 1) * threads_horizontal + x) : -1;
+        const int below = (y < (threads_vertical - 1)) ? (int)((y + 1) * threads_horizontal + x) : -1;
+        const int left = (x > 0) ? (int)(y * threads_horizontal + (x - 1)) : -1;
+        const int right = (x < (threads_horizontal - 1)) ? (int)(y * threads_horizontal + (x + 1)) : -1;
+
+        int neighbours[4];
+        int neighbour_count = 0;
+        if (above >= 0) {
+            neighbours[neighbour_count++] = above;
+        }
+        if (below >= 0) {
+            neighbours[neighbour_count++] = below;
+        }
+        if (left >= 0) {
+            neighbours[neighbour_count++] = left;
+        }
+        if (right >= 0) {
+            neighbours[neighbour_count++] = right;
+        }
+
+        const size_t rows = submatrix->rows - submatrix->boundary;
+        const size_t cols = submatrix->cols - 2 * submatrix->boundary;
+
+        const double t1 = omp_get_wtime();
+
+        for (size_t iteration = 1; iteration <= iterations; iteration++) {
+            // exchange boundary data (not needed on the first iteration because we
+            // have already have the correct boundary data from the initial matrix)
+            if (iteration > 1) {
+                // wait until the neighbours do not read their boundary anymore
+                for (int i = 0; i < neighbour_count; i++) {
+                    wait_for_progress(&progress[neighbours[i]].computed, iteration - 1);
+                }
+
+                // only the inner values of the rows and cols are copied, the corners are not
+                // used by the stencil and would race with the copies of the other neighbours
+                if (above >= 0) {
+                    // exchange top
+                    stencil_matrix_t *submatrix_above = submatrices[above];
+                    double *src = stencil_matrix_get_ptr(submatrix, 1, submatrix->boundary);
+                    double *dest = stencil_matrix_get_ptr(submatrix_above, submatrix_above->rows - 1,
+                                                          submatrix_above->boundary);
+                    memcpy(dest, src, cols * sizeof(double));
+                }
+                if (below >= 0) {
+                    // exchange bottom
+                    stencil_matrix_t *submatrix_below = submatrices[below];
+                    double *src = stencil_matrix_get_ptr(submatrix, submatrix->rows - 2, submatrix->boundary);
+                    double *dest = stencil_matrix_get_ptr(submatrix_below, 0, submatrix_below->boundary);
+                    memcpy(dest, src, cols * sizeof(double));
+                }
+                if (left >= 0) {
+                    // exchange left column
+                    stencil_matrix_t *submatrix_left = submatrices[left];
+                    stencil_matrix_copy_column(submatrix, submatrix_left, 1, submatrix_left->cols - 1);
+                }
+                if (right >= 0) {
+                    // exchange right column
+                    stencil_matrix_copy_column(submatrix, submatrices[right], submatrix->cols - 2, 0);
+                }
+
+                // wait until the neighbours have copied their boundary into the submatrix
+                __atomic_store_n(&progress[partition].exchanged, iteration, __ATOMIC_RELEASE);
+                for (int i = 0; i < neighbour_count; i++) {
+                    wait_for_progress(&progress[neighbours[i]].exchanged, iteration);
+                }
+            }
+
+            // calculate the first row
+            const size_t first_row = submatrix->boundary;
+            stencil_five_point_row(stencil_vector_get_ptr(tmp, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row - 1, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row + 1, submatrix->boundary),
+                                   cols);
+
+            // calculate the remaining rows (copies back the previously calculated row)
+            for (size_t row = first_row + 1; row < rows; row++) {
+                stencil_five_point_row_one_vector(stencil_matrix_get_ptr(submatrix, row - 1, submatrix->boundary),
+                                                  stencil_vector_get_ptr(tmp, submatrix->boundary),
+                                                  stencil_matrix_get_ptr(submatrix, row, submatrix->boundary),
+                                                  stencil_matrix_get_ptr(submatrix, row + 1, submatrix->boundary),
+                                                  cols);
+            }
+
+            // copy back calculated values of the last non-boundary row
+            stencil_matrix_set_row(submatrix, rows - 1, tmp);
+
+            __atomic_store_n(&progress[partition].computed, iteration, __ATOMIC_RELEASE);
+        }
+
+        const double t2 = omp_get_wtime();
+
+        // the neighbours do not access the submatrix after its last iteration
+        stencil_matrix_set_submatrix(matrix, start_row, start_col, submatrix);
+        stencil_matrix_free(submatrix);
+
+        stencil_vector_free(tmp);
+
+        wall_time = (t2 - t1) * 1000.0;
+    }
+
+    placement_end(&placement);
+    free(submatrices);
+    free(progress);
+
+    return wall_time;
+}
+
+double five_point_stencil_with_one_vector_tld_p2p(stencil_matrix_t *matrix, const size_t iterations)
+{
+    return five_point_stencil_tld_p2p(matrix, iterations, PARTITION_ROWS, 0);
+}
+
+double five_point_stencil_with_one_vector_columnwise_tld_p2p(stencil_matrix_t *matrix, const size_t iterations)
+{
+    return five_point_stencil_tld_p2p(matrix, iterations, PARTITION_COLUMNS, 0);
+}
+
+double five_point_stencil_with_one_vector_blockwise_tld_p2p(stencil_matrix_t *matrix, const size_t iterations)
+{
+    return five_point_stencil_tld_p2p(matrix, iterations, PARTITION_BLOCKS, 0);
+}
+
+/**
+ * Index of the dependency of tile (\a tile_row, \a tile_col) in buffer \a buffer, the
+ * tiles are surrounded by a frame of dependencies which are never written.
+ */
+static size_t tile_dependency(size_t buffer, size_t tile_row, size_t tile_col, size_t tile_rows, size_t tile_cols)
+{
+    return (buffer * (tile_rows + 2) + tile_row + 1) * (tile_cols + 2) + tile_col + 1;
+}
+
+double five_point_stencil_wavefront(stencil_matrix_t *matrix, const size_t iterations, size_t tile_rows,
+                                    size_t tile_cols)
+{
+    assert(matrix->boundary >= 1);
+
+    const size_t rows = matrix->rows - 2 * matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+    if (iterations == 0 || rows == 0 || cols == 0) {
+        return 0.0;
+    }
+
+    tile_rows = (tile_rows > 0) ? tile_rows : STENCIL_WAVEFRONT_TILE_ROWS;
+    tile_cols = (tile_cols > 0) ? tile_cols : STENCIL_WAVEFRONT_TILE_COLS;
+    // balanced tiles of at most tile_rows x tile_cols fields
+    const size_t tiles_vertical = (rows + tile_rows - 1) / tile_rows;
+    const size_t tiles_horizontal = (cols + tile_cols - 1) / tile_cols;
+
+    stencil_matrix_t *tmp_matrix = first_touch_copy(matrix);
+    if (tmp_matrix == NULL) {
+        return -1.0;
+    }
+    // dependency objects of the tiles per buffer (only their addresses are used)
+    char *dependencies = (char *)calloc(2 * (tiles_vertical + 2) * (tiles_horizontal + 2), sizeof(char));
+    if (dependencies == NULL) {
+        stencil_matrix_free(tmp_matrix);
+        return -1.0;
+    }
+
+    // iteration i writes to buffers[i % 2] (same order as five_point_stencil_with_tmp_matrix)
+    stencil_matrix_t *buffers[] = {tmp_matrix, matrix};
+
+    const double t1 = omp_get_wtime();
+
+    #pragma omp parallel shared(matrix, buffers, dependencies)
+    #pragma omp single
+    for (size_t iteration = 1; iteration <= iterations; iteration++) {
+        const size_t dest = iteration % 2;
+        const size_t src = 1 - dest;
+
+        for (size_t tile_row = 0; tile_row < tiles_vertical; tile_row++) {
+            for (size_t tile_col = 0; tile_col < tiles_horizontal; tile_col++) {
+                /*
+                 * The tile reads the previous iteration of itself and its four neighbours
+                 * and overwrites the values they have read in the previous iteration,
+                 * thus it waits for exactly these tasks (in: previous iteration) and
+                 * the tasks of the next iteration wait for it (out: this iteration).
+                 */
+                const size_t self = tile_dependency(src, tile_row, tile_col, tiles_vertical, tiles_horizontal);
+                const size_t above = self - (tiles_horizontal + 2);
+                const size_t below = self + (tiles_horizontal + 2);
+                const size_t written = tile_dependency(dest, tile_row, tile_col, tiles_vertical, tiles_horizontal);
+
+                #pragma omp task firstprivate(tile_row, tile_col, dest, src) shared(buffers, dependencies) \
+                    depend(in: dependencies[self], dependencies[above], dependencies[below], \
+                           dependencies[self - 1], dependencies[self + 1]) \
+                    depend(out: dependencies[written])
+                {
+                    const stencil_matrix_t *values = buffers[src];
+                    stencil_matrix_t *new_values = buffers[dest];
+
+                    size_t first_row;
+                    size_t first_col;
+                    const size_t task_rows = partition_range(rows, tiles_vertical, tile_row, &first_row);
+                    const size_t task_cols = partition_range(cols, tiles_horizontal, tile_col, &first_col);
+                    first_row += matrix->boundary;
+                    first_col += matrix->boundary;
+
+                    for (size_t row = first_row; row < first_row + task_rows; row++) {
+                        stencil_five_point_row(stencil_matrix_get_ptr(new_values, row, first_col),
+                                               stencil_matrix_get_ptr(values, row - 1, first_col),
+                                               stencil_matrix_get_ptr(values, row, first_col),
+                                               stencil_matrix_get_ptr(values, row + 1, first_col),
+                                               task_cols);
+                    }
+                }
+            }
+        }
+    }
+
+    const double t2 = omp_get_wtime();
+
+    if (iterations % 2 == 0) {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_copy_values(matrix, tmp_matrix);
+    }
+
+    free(dependencies);
+    stencil_matrix_free(tmp_matrix);
+
+    return (t2 - t1) * 1000.0;
+}
+
+#define TUNE_ITERATIONS 10 // maximum iterations of a measurement
+#define TUNE_REPEATS 3 // measurements per candidate, the fastest one counts
+
+/**
+ * Variants of the tuner, blockwise_tld_p2p is measured for every number of threads per
+ * row of blocks (the parameter of the wisdom entry).
+ */
+struct tuned_variant {
+    const char *name;
+    enum partitioning partitioning;
+    double (*solve)(stencil_matrix_t *matrix, const size_t iterations);
+};
+
+static const struct tuned_variant tuned_variants[] = {
+    {"tmp_matrix", PARTITION_ROWS, five_point_stencil_with_tmp_matrix},
+    {"one_vector", PARTITION_ROWS, five_point_stencil_with_one_vector},
+    {"one_vector_tld", PARTITION_ROWS, five_point_stencil_with_one_vector_tld},
+    {"one_vector_tld_p2p", PARTITION_ROWS, five_point_stencil_with_one_vector_tld_p2p},
+    {"colwise", PARTITION_COLUMNS, five_point_stencil_with_one_vector_columnwise},
+    {"colwise_tld", PARTITION_COLUMNS, five_point_stencil_with_one_vector_columnwise_tld},
+    {"colwise_tld_p2p", PARTITION_COLUMNS, five_point_stencil_with_one_vector_columnwise_tld_p2p},
+    {"blockwise_tld", PARTITION_BLOCKS, five_point_stencil_with_one_vector_blockwise_tld},
+    {"blockwise_tld_p2p", PARTITION_BLOCKS, NULL}
+};
+
+#define TUNED_VARIANTS (sizeof(tuned_variants) / sizeof(tuned_variants[0]))
+
+/**
+ * @param threads_horizontal threads per row of blocks (0: optimize_dims_for_matrix)
+ *
+ * @return returns true if the variant can calculate matrix \a matrix with \a threads
+ *         threads (every thread gets at least two rows and cols)
+ */
+static bool variant_fits(const struct tuned_variant *variant, int threads_horizontal, stencil_matrix_t *matrix,
+                         int threads)
+{
+    int dims[DIMENSIONS] = {threads, 1};
+    if (variant->partitioning == PARTITION_ROWS) {
+        dims[DIM_HORIZONTAL] = 1;
+        dims[DIM_VERTICAL] = threads;
+    } else if (variant->partitioning == PARTITION_BLOCKS && threads_horizontal > 0) {
+        if (threads % threads_horizontal != 0) {
+            return false;
+        }
+        dims[DIM_HORIZONTAL] = threads_horizontal;
+        dims[DIM_VERTICAL] = threads / threads_horizontal;
+    } else if (variant->partitioning == PARTITION_BLOCKS) {
+        optimize_dims_for_matrix(dims, matrix);
+    }
+
+    const size_t rows = matrix->rows - 2 * matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+    return (rows / dims[DIM_VERTICAL] >= 2) && (cols / dims[DIM_HORIZONTAL] >= 2);
+}
+
+static double run_variant(const struct tuned_variant *variant, int param, stencil_matrix_t *matrix,
+                          const size_t iterations)
+{
+    if (variant->solve == NULL) {
+        return five_point_stencil_tld_p2p(matrix, iterations, PARTITION_BLOCKS, param);
+    }
+    return variant->solve(matrix, iterations);
+}
+
+/**
+ * Measures all variants which fit matrix \a matrix on a copy of it and stores the
+ * fastest one in \a wisdom.
+ *
+ * @return returns the new entry, NULL on failure
+ */
+static const stencil_wisdom_entry_t *tune(stencil_wisdom_t *wisdom, const stencil_matrix_t *matrix,
+                                          const size_t iterations, int threads)
+{
+    stencil_matrix_t *scratch = stencil_matrix_new(matrix->rows, matrix->cols, matrix->boundary);
+    if (scratch == NULL) {
+        return NULL;
+    }
+
+    const size_t tune_iterations = (iterations > 0 && iterations < TUNE_ITERATIONS) ? iterations : TUNE_ITERATIONS;
+
+    const struct tuned_variant *best = NULL;
+    int best_param = 0;
+    double best_time = DBL_MAX;
+
+    for (size_t i = 0; i < TUNED_VARIANTS; i++) {
+        const struct tuned_variant *variant = &tuned_variants[i];
+
+        // every number of threads per row of blocks which is neither rows nor columns
+        const int first_param = (variant->solve == NULL) ? 2 : 0;
+        const int last_param = (variant->solve == NULL) ? (threads - 1) : 0;
+
+        for (int param = first_param; param <= last_param; param++) {
+            if (!variant_fits(variant, param, scratch, threads)) {
+                continue;
+            }
+
+            double time = DBL_MAX;
+            for (int repeat = 0; repeat < TUNE_REPEATS; repeat++) {
+                stencil_matrix_copy_values(scratch, matrix);
+
+                // the setup of the variant (submatrices, vectors) is part of the time
+                const double t1 = omp_get_wtime();
+                const double elapsed_time = run_variant(variant, param, scratch, tune_iterations);
+                const double t2 = omp_get_wtime();
+
+                if (elapsed_time >= 0.0) {
+                    time = fmin(time, (t2 - t1) * 1000.0);
+                }
+            }
+
+            if (time < best_time) {
+                best = variant;
+                best_param = param;
+                best_time = time;
+            }
+        }
+    }
+
+    stencil_matrix_free(scratch);
+
+    if (best == NULL || !stencil_wisdom_store(wisdom, matrix->rows, matrix->cols, threads, best->name, best_param,
+                                              best_time)) {
+        return NULL;
+    }
+    stencil_wisdom_save(wisdom); // the wisdom of this run is kept if the file cannot be written
+
+    return stencil_wisdom_lookup(wisdom, matrix->rows, matrix->cols, threads);
+}
+
+double five_point_stencil_tuned(stencil_matrix_t *matrix, const size_t iterations, stencil_wisdom_t *wisdom)
+{
+    assert(matrix->boundary >= 1);
+
+    const int threads = omp_get_max_threads();
+
+    const stencil_wisdom_entry_t *entry = stencil_wisdom_lookup(wisdom, matrix->rows, matrix->cols, threads);
+    if (entry == NULL) {
+        entry = tune(wisdom, matrix, iterations, threads);
+    }
+
+    // the class contains other sizes as well, a variant which does not fit the matrix
+    // (or is unknown) falls back to the tmp matrix
+    const struct tuned_variant *variant = &tuned_variants[0];
+    int param = 0;
+    for (size_t i = 0; entry != NULL && i < TUNED_VARIANTS; i++) {
+        if (strcmp(tuned_variants[i].name, entry->variant) == 0 &&
+            variant_fits(&tuned_variants[i], entry->param, matrix, threads)) {
+            variant = &tuned_variants[i];
+            param = entry->param;
+            break;
+        }
+    }
+
+    return run_variant(variant, param, matrix, iterations);
+}
+
+/**
+ * Pins the threads of a team of \a threads threads in the order of the topology of the
+ * CPUs of the calling thread (see stencil/topology.h), thus the threads of neighbouring
+ * partitions share a cache. If a thread cannot be pinned, all threads get \a affinity
+ * (the affinity of the calling thread) back.
+ *
+ * @return returns true if all threads were pinned
+ */
+static bool pin_threads(int threads, const stencil_affinity_t *affinity)
+{
+    stencil_topology_t *topology = stencil_topology_probe();
+    if (topology == NULL) {
+        return false;
+    }
+
+    bool pinned = true;
+
+    #pragma omp parallel num_threads(threads) shared(topology) reduction(&& : pinned)
+    {
+        pinned = stencil_topology_pin(topology, omp_get_thread_num());
+    }
+
+    if (!pinned) {
+        #pragma omp parallel num_threads(threads) shared(affinity)
+        {
+            stencil_topology_set_affinity(affinity);
+        }
+    }
+
+    stencil_topology_free(topology);
+    return pinned;
+}
+
+stencil_openmp_engine_t *stencil_openmp_engine_new(int threads, bool pin)
+{
+    stencil_openmp_engine_t *engine = (stencil_openmp_engine_t *)malloc(sizeof(stencil_openmp_engine_t));
+    if (!engine) {
+        goto exit_engine;
+    }
+
+    engine->threads = (threads > 0) ? threads : omp_get_max_threads();
+    engine->tmp_matrix = NULL;
+
+    engine->workers = (struct stencil_openmp_worker *)calloc(engine->threads, sizeof(struct stencil_openmp_worker));
+    if (!engine->workers) {
+        goto exit_workers;
+    }
+    engine->submatrices = (stencil_matrix_t **)calloc(engine->threads, sizeof(stencil_matrix_t *));
+    if (!engine->submatrices) {
+        goto exit_submatrices;
+    }
+
+    // OMP_PROC_BIND takes precedence, the affinity of the calling thread is restored by
+    // stencil_openmp_engine_free
+    engine->pinned = pin && (omp_get_proc_bind() == omp_proc_bind_false) &&
+                     stencil_topology_get_affinity(&engine->affinity) &&
+                     pin_threads(engine->threads, &engine->affinity);
+
+    return engine;
+
+exit_submatrices:
+    free(engine->workers);
+exit_workers:
+    free(engine);
+exit_engine:
+    return NULL;
+}
+
+void stencil_openmp_engine_free(stencil_openmp_engine_t *engine)
+{
+    if (!engine) {
+        return;
+    }
+
+    // the threads of the team (the calling thread as well) were created with its affinity
+    if (engine->pinned) {
+        #pragma omp parallel num_threads(engine->threads) shared(engine)
+        {
+            stencil_topology_set_affinity(&engine->affinity);
+        }
+    }
+
+    for (int thread = 0; thread < engine->threads; thread++) {
+        stencil_vector_free(engine->workers[thread].vec);
+        stencil_vector_free(engine->workers[thread].last_vec);
+        stencil_vector_free(engine->workers[thread].tmp);
+        stencil_matrix_free(engine->workers[thread].submatrix);
+    }
+    stencil_matrix_free(engine->tmp_matrix);
+    free(engine->submatrices);
+    free(engine->workers);
+    free(engine);
+}
+
+/**
+ * @return returns \a *vector if it has \a size values, otherwise it is replaced by a
+ *         new vector (allocated by the calling thread)
+ */
+static stencil_vector_t *engine_vector(stencil_vector_t **vector, size_t size)
+{
+    if (*vector == NULL || stencil_vector_size(*vector) != size) {
+        stencil_vector_free(*vector);
+        *vector = stencil_vector_new(size);
+    }
+    return *vector;
+}
+
+/**
+ * @return returns \a *matrix if it has the given size, otherwise it is replaced by a
+ *         new matrix (allocated by the calling thread)
+ */
+static stencil_matrix_t *engine_matrix(stencil_matrix_t **matrix, size_t rows, size_t cols, size_t boundary)
+{
+    if (*matrix == NULL || (*matrix)->rows != rows || (*matrix)->cols != cols || (*matrix)->boundary != boundary) {
+        stencil_matrix_free(*matrix);
+        *matrix = stencil_matrix_new(rows, cols, boundary);
+    }
+    return *matrix;
+}
+
+double five_point_stencil_engine_tmp_matrix(stencil_openmp_engine_t *engine, stencil_matrix_t *matrix,
+                                            const size_t iterations)
+{
+    assert(matrix->boundary >= 1);
+
+    stencil_matrix_t *tmp_matrix = engine_matrix(&engine->tmp_matrix, matrix->rows, matrix->cols, matrix->boundary);
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    double wall_time = 0.0;
+
+    #pragma omp parallel num_threads(engine->threads) shared(matrix, tmp_matrix) reduction(max : wall_time)
+    {
+        // the boundary is copied as well, the rows in the partitioning of the calculation
+        #pragma omp for schedule(static)
+        for (size_t row = 0; row < matrix->rows; row++) {
+            memcpy(stencil_matrix_get_ptr(tmp_matrix, row, 0), stencil_matrix_get_ptr(matrix, row, 0),
+                   matrix->cols * sizeof(double));
+        }
+
+        const double t1 = omp_get_wtime();
+
+        for (size_t iteration = 1; iteration <= iterations; iteration++) {
+            #pragma omp for schedule(static)
+            for (size_t row = matrix->boundary; row < rows; row++) {
+                stencil_five_point_row(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                       stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                       stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                       stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                       cols);
+            }
+
+            #pragma omp single
+            {
+                stencil_matrix_t *tmp = tmp_matrix;
+                tmp_matrix = matrix;
+                matrix = tmp;
+            }
+        }
+
+        // after an even number of iterations the tmp matrix of the engine holds the values
+        if (iterations > 0 && iterations % 2 == 0) {
+            #pragma omp for schedule(static)
+            for (size_t row = matrix->boundary; row < rows; row++) {
+                memcpy(stencil_matrix_get_ptr(matrix, row, 0), stencil_matrix_get_ptr(tmp_matrix, row, 0),
+                       matrix->cols * sizeof(double));
+            }
+        }
+
+        const double t2 = omp_get_wtime();
+
+        wall_time = (t2 - t1) * 1000.0;
+    }
+
+    return wall_time;
+}
+
+double five_point_stencil_engine_one_vector(stencil_openmp_engine_t *engine, stencil_matrix_t *matrix,
+                                            const size_t iterations)
+{
+    assert(matrix->boundary >= 1);
+
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    double wall_time = 0.0;
+
+    #pragma omp parallel num_threads(engine->threads) shared(matrix) reduction(max : wall_time)
+    {
+        const int thread = omp_get_thread_num();
+        const int threads = omp_get_num_threads();
+        const bool is_last_thread = (thread == (threads - 1));
+        const size_t rows_per_thread = (matrix->rows - 2 * matrix->boundary) / threads;
+
+        const size_t start_row = thread * rows_per_thread + matrix->boundary;
+        const size_t end_row = is_last_thread ? (matrix->rows - matrix->boundary - 1)
+                                              : (start_row + rows_per_thread - 1);
+
+        struct stencil_openmp_worker *worker = &engine->workers[thread];
+        stencil_vector_t *vec = engine_vector(&worker->vec, matrix->cols);
+        stencil_vector_t *last_vec = engine_vector(&worker->last_vec, matrix->cols);
+
+        const double t1 = omp_get_wtime();
+
+        for (size_t iteration = 1; iteration <= iterations; iteration++) {
+            // calculate the first and last row
+            stencil_five_point_row(stencil_vector_get_ptr(vec, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, start_row - 1, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, start_row, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, start_row + 1, matrix->boundary),
+                                   cols);
+            stencil_five_point_row(stencil_vector_get_ptr(last_vec, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, end_row - 1, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, end_row, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, end_row + 1, matrix->boundary),
+                                   cols);
+
+            // wait until all threads have filled the first and last row
+            #pragma omp barrier
+
+            // calculate the remaining rows (copies back the previously calculated row)
+            for (size_t row = start_row + 1; row < end_row; row++) {
+                stencil_five_point_row_one_vector(stencil_matrix_get_ptr(matrix, row - 1, matrix->boundary),
+                                                  stencil_vector_get_ptr(vec, matrix->boundary),
+                                                  stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                                  stencil_matrix_get_ptr(matrix, row + 1, matrix->boundary),
+                                                  cols);
+            }
+            stencil_matrix_set_row(matrix, end_row - 1, vec);
+
+            // copy back the last row
+            stencil_matrix_set_row(matrix, end_row, last_vec);
+
+            // wait for all threads before we start with the next iteration
+            #pragma omp barrier
+        }
+
+        const double t2 = omp_get_wtime();
+
+        wall_time = (t2 - t1) * 1000.0;
+    }
+
+    return wall_time;
+}
+
+double five_point_stencil_engine_one_vector_tld(stencil_openmp_engine_t *engine, stencil_matrix_t *matrix,
+                                                const size_t iterations)
+{
+    assert(matrix->boundary >= 1);
+
+    double wall_time = 0.0;
+
+    stencil_matrix_t **submatrices = engine->submatrices;
+
+    #pragma omp parallel num_threads(engine->threads) shared(matrix, submatrices) reduction(max : wall_time)
+    {
+        const int thread = omp_get_thread_num();
+        const int threads = omp_get_num_threads();
+        const bool is_first_thread = (thread == 0);
+        const bool is_last_thread = (thread == (threads - 1));
+        const size_t rows_per_thread = (matrix->rows - 2 * matrix->boundary) / threads;
+
+        const size_t start_row = thread * rows_per_thread + matrix->boundary;
+        const size_t end_row = is_last_thread ? (matrix->rows - matrix->boundary)
+                                              : (start_row + rows_per_thread);
+
+        // the submatrix of the thread is kept (and first touched) by the thread
+        struct stencil_openmp_worker *worker = &engine->workers[thread];
+        stencil_matrix_t *submatrix = engine_matrix(&worker->submatrix, end_row - start_row + 2,
+                                                    matrix->cols - 2 * matrix->boundary + 2, 1);
+        stencil_matrix_copy_submatrix(matrix, start_row - 1, matrix->boundary - 1, submatrix);
+        stencil_vector_t *tmp = engine_vector(&worker->tmp, submatrix->cols);
+
+        // exchange matrix pointers with neighbouring threads
+        submatrices[thread] = submatrix;
+        #pragma omp barrier
+        stencil_matrix_t *submatrix_above = is_first_thread ? NULL : submatrices[thread - 1];
+        stencil_matrix_t *submatrix_below = is_last_thread ? NULL : submatrices[thread + 1];
+
+        const size_t rows = submatrix->rows - submatrix->boundary;
+        const size_t cols = submatrix->cols - 2 * submatrix->boundary;
+
+        const double t1 = omp_get_wtime();
+
+        for (size_t iteration = 1; iteration <= iterations; iteration++) {
+            // exchange boundary data (not needed on the first iteration because we
+            // have already have the correct boundary data from the initial matrix)
+            if (iteration > 1) {
+                #pragma omp barrier
+
+                if (submatrix_above != NULL) {
+                    // exchange top
+                    double *src = stencil_matrix_get_ptr(submatrix, 1, 0);
+                    double *dest = stencil_matrix_get_ptr(submatrix_above, submatrix_above->rows - 1, 0);
+                    memcpy(dest, src, submatrix->cols * sizeof(double));
+                }
+                if (submatrix_below != NULL) {
+                    // exchange bottom
+                    double *src = stencil_matrix_get_ptr(submatrix, submatrix->rows - 2, 0);
+                    double *dest = stencil_matrix_get_ptr(submatrix_below, 0, 0);
+                    memcpy(dest, src, submatrix->cols * sizeof(double));
+                }
+
+                // wait until all threads have exchanged their boundaries
+                #pragma omp barrier
+            }
+
+            // calculate the first row
+            const size_t first_row = submatrix->boundary;
+            stencil_five_point_row(stencil_vector_get_ptr(tmp, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row - 1, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row, submatrix->boundary),
+                                   stencil_matrix_get_ptr(submatrix, first_row + 1, submatrix->boundary),
+                                   cols);
+
+            // calculate the remaining rows (copies back the previously calculated row)
+            for (size_t row = first_row + 1; row < rows; row++) {
+                stencil_five_point_row_one_vector(stencil_matrix_get_ptr(submatrix, row - 1, submatrix->boundary),
+                                                  stencil_vector_get_ptr(tmp, submatrix->boundary),
+                                                  stencil_matrix_get_ptr(submatrix, row, submatrix->boundary),
+                                                  stencil_matrix_get_ptr(submatrix, row + 1, submatrix->boundary),
+                                                  cols);
+            }
+
+            // copy back calculated values of the last non-boundary row
+            stencil_matrix_set_row(submatrix, rows - 1, tmp);
+        }
+
+        const double t2 = omp_get_wtime();
+
+        stencil_matrix_set_submatrix(matrix, start_row, matrix->boundary, submatrix);
+
+        wall_time = (t2 - t1) * 1000.0;
+    }
+
+    return wall_time;
+}
+
+double stencil_engine_descriptor_sweep(stencil_openmp_engine_t *engine, stencil_matrix_t *matrix,
+                                       const stencil_descriptor_t *descriptor, bool residual, stencil_norm_t norm)
+{
+    assert(matrix->boundary >= descriptor->radius);
+
+    stencil_matrix_t *tmp_matrix = engine_matrix(&engine->tmp_matrix, matrix->rows, matrix->cols, matrix->boundary);
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t col = matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    double max_partial = 0.0;
+    double sum_partial = 0.0;
+
+    #pragma omp parallel num_threads(engine->threads) shared(matrix, tmp_matrix) \
+        reduction(max : max_partial) reduction(+ : sum_partial)
+    {
+        // the old values (with the halo) are read from the tmp matrix of the engine
+        #pragma omp for schedule(static)
+        for (size_t row = 0; row < matrix->rows; row++) {
+            memcpy(stencil_matrix_get_ptr(tmp_matrix, row, 0), stencil_matrix_get_ptr(matrix, row, 0),
+                   matrix->cols * sizeof(double));
+        }
+
+        #pragma omp for schedule(static)
+        for (size_t row = matrix->boundary; row < rows; row++) {
+            double *dest = stencil_matrix_get_ptr(matrix, row, col);
+            const double *above = stencil_matrix_get_ptr(tmp_matrix, row - 1, col);
+            const double *current = stencil_matrix_get_ptr(tmp_matrix, row, col);
+            const double *below = stencil_matrix_get_ptr(tmp_matrix, row + 1, col);
+
+            // the same kernels as stencil_descriptor_sweep, thus the same values
+            double partial = 0.0;
+            if (descriptor == &stencil_five_point && residual) {
+                partial = stencil_five_point_row_residual(dest, above, current, below, cols, norm);
+            } else if (descriptor == &stencil_five_point) {
+                stencil_five_point_row(dest, above, current, below, cols);
+            } else {
+                stencil_descriptor_row(descriptor, dest, tmp_matrix, row, col, cols);
+                if (residual) {
+                    partial = stencil_row_residual(norm, dest, current, cols);
+                }
+            }
+
+            max_partial = fmax(max_partial, partial);
+            sum_partial += partial;
+        }
+    }
+
+    return (norm == STENCIL_NORM_MAX) ? max_partial : sum_partial;
+}
+
+double five_point_stencil_engine_sor_sweep(stencil_openmp_engine_t *engine, stencil_matrix_t *matrix,
+                                           stencil_colour_t colour, size_t parity, double omega, stencil_norm_t norm)
+{
+    assert(matrix->boundary >= 1);
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t col = matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    double max_partial = 0.0;
+    double sum_partial = 0.0;
+
+    // the fields of a colour only depend on fields of the other colour, the rows are independent
+    #pragma omp parallel for num_threads(engine->threads) schedule(static) shared(matrix) \
+        reduction(max : max_partial) reduction(+ : sum_partial)
+    for (size_t row = matrix->boundary; row < rows; row++) {
+        const double partial = stencil_five_point_row_sor(stencil_matrix_get_ptr(matrix, row, col),
+                                                          stencil_matrix_get_ptr(matrix, row - 1, col),
+                                                          stencil_matrix_get_ptr(matrix, row + 1, col),
+                                                          cols, stencil_sor_first(matrix, row, colour, parity),
+                                                          omega, norm);
+        max_partial = fmax(max_partial, partial);
+        sum_partial += partial;
+    }
+
+    return (norm == STENCIL_NORM_MAX) ? max_partial : sum_partial;
+}
+
+double five_point_stencil_float(stencil_matrix_float_t *matrix, const size_t iterations, stencil_precision_t precision)
+{
+    assert(matrix->boundary >= 1);
+
+    stencil_matrix_float_t *tmp_matrix = stencil_matrix_float_copy(matrix);
+
+    const size_t rows = matrix->rows - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
+
+    const double t1 = omp_get_wtime();
+
+    for (size_t iteration = 1; iteration <= iterations; iteration++) {
+        #pragma omp parallel for schedule(static) shared(matrix, tmp_matrix)
+        for (size_t row = matrix->boundary; row < rows; row++) {
+            stencil_five_point_row_float(stencil_matrix_float_get_ptr(matrix, row, matrix->boundary),
+                                         stencil_matrix_float_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                         stencil_matrix_float_get_ptr(tmp_matrix, row, matrix->boundary),
+                                         stencil_matrix_float_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                         cols, precision);
+        }
+
+        stencil_matrix_float_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    }
+
+    const double t2 = omp_get_wtime();
+
+    if (iterations % 2 != 0) {
+        stencil_matrix_float_t *tmp = tmp_matrix;
+        tmp_matrix = matrix;
+        matrix = tmp;
+    } else {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_float_copy_values(matrix, tmp_matrix);
+    }
+
+    stencil_matrix_float_free(tmp_matrix);
+
+    return (t2 - t1) * 1000.0;
+}
+
+/**
+ * Rows of the grid file \a header which are held in memory (aligned like a matrix with
+ * the stride of the file, thus a band of rows is read and written with one call).
+ *
+ * @return A pointer to a zeroed matrix of \a rows rows, NULL on failure
+ */
+static stencil_matrix_t *new_band(size_t rows, const stencil_binary_header_t *header)
+{
+    const size_t offset = stencil_matrix_alignment_offset(header->boundary, sizeof(double));
+    const size_t len = offset + rows * header->stride;
+
+    stencil_pages_t pages;
+    double *memory = (double *)stencil_pages_alloc(len * sizeof(double), &pages);
+    if (!memory) {
+        goto exit_values;
+    }
+    memset(memory, 0, len * sizeof(double)); // the padding of the rows is written as zeros
+
+    stencil_matrix_t *band = (stencil_matrix_t *)malloc(sizeof(stencil_matrix_t));
+    if (!band) {
+        goto exit_band;
+    }
+    band->rows = rows;
+    band->cols = header->cols;
+    band->stride = header->stride;
+    band->boundary = header->boundary;
+    band->values = memory + offset;
+    band->pages = pages;
+
+    return band;
+
+exit_band:
+    stencil_pages_free(memory, len * sizeof(double), pages);
+exit_values:
+    return NULL;
+}
+
+/**
+ * @return returns a pointer to row \a position of the band \a band (rows outside of the
+ *         band are only addressed by empty transfers)
+ */
+static double *band_row(const stencil_matrix_t *band, ptrdiff_t position)
+{
+    return band->values + position * (ptrdiff_t)band->stride;
+}
+
+/**
+ * Transfer of a band of rows of a grid file, reads (\a write false) or writes the rows
+ * [\a first_row, \a first_row + \a rows[ from or to the rows of \a values.
+ */
+struct band_transfer {
+    int fd;
+    const stencil_binary_header_t *header;
+    size_t first_row;
+    size_t rows;
+    double *values;
+    bool write;
+};
+
+static bool transfer_band(const struct band_transfer *transfer)
+{
+    const size_t row_size = transfer->header->stride * sizeof(double);
+    const off_t position = transfer->header->offset + transfer->first_row * row_size;
+    char *bytes = (char *)transfer->values;
+    const size_t size = transfer->rows * row_size;
+
+    for (size_t done = 0; done < size;) {
+        const ssize_t len = transfer->write ? pwrite(transfer->fd, bytes + done, size - done, position + done)
+                                            : pread(transfer->fd, bytes + done, size - done, position + done);
+        if (len <= 0) {
+            return false;
+        }
+        done += len;
+    }
+
+    return true;
+}
+
+/**
+ * I/O of one band step: writes the previous band of the last level and reads the next
+ * band of the first level.
+ */
+struct band_io {
+    struct band_transfer transfers[2];
+    bool done;
+};
+
+static void *transfer_bands(void *arg)
+{
+    struct band_io *io = (struct band_io *)arg;
+
+    io->done = true;
+    for (size_t i = 0; i < 2; i++) {
+        if (io->transfers[i].rows > 0) {
+            io->done = transfer_band(&io->transfers[i]) && io->done;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Calculates the rows [\a first_row, \a last_row[ (clipped to the grid) of the next
+ * level from the rows of \a src, row i of the level is stored at row i - dest_row of
+ * \a dest and row i of the level before at row i - src_row of \a src.
+ */
+static void five_point_band(stencil_matrix_t *dest, ptrdiff_t dest_row, const stencil_matrix_t *src,
+                            ptrdiff_t src_row, ptrdiff_t first_row, ptrdiff_t last_row, size_t rows)
+{
+    const ptrdiff_t boundary = src->boundary;
+    const size_t cols = src->cols - 2 * src->boundary;
+
+    first_row = (first_row > 0) ? first_row : 0;
+    last_row = (last_row < (ptrdiff_t)rows) ? last_row : (ptrdiff_t)rows;
+
+    #pragma omp parallel for schedule(static) shared(dest, src)
+    for (ptrdiff_t row = first_row; row < last_row; row++) {
+        double *dest_ptr = band_row(dest, row - dest_row);
+        const double *src_ptr = band_row(src, row - src_row);
+
+        if ((row < boundary) || (row >= (ptrdiff_t)rows - boundary)) {
+            memcpy(dest_ptr, src_ptr, src->cols * sizeof(double));
+            continue;
+        }
+
+        // the boundary columns are the same on all levels
+        memcpy(dest_ptr, src_ptr, boundary * sizeof(double));
+        memcpy(dest_ptr + boundary + cols, src_ptr + boundary + cols, boundary * sizeof(double));
+        stencil_five_point_row(dest_ptr + boundary, src_ptr + boundary - src->stride, src_ptr + boundary,
+                               src_ptr + boundary + src->stride, cols);
+    }
+}
+
+/**
+ * One pass over the grid file (\a src_fd, may be \a dest_fd) which advances it by
+ * \a time_steps iterations: band n of \a band_rows rows is read into the first level,
+ * level k calculates the rows of the band shifted up by k rows. Row i of level k is
+ * stored at row i - (r0 - k - 2) of its buffer (r0 is the first row of the band), the
+ * two rows above the band are carried over from the band before.
+ *
+ * The rows of the last level are written while the next band is calculated, they are
+ * always above the rows which are read, thus the pass can work in place.
+ */
+static bool stream_pass(int src_fd, int dest_fd, const stencil_binary_header_t *header, size_t time_steps,
+                        size_t band_rows, stencil_matrix_t *inputs[2], stencil_matrix_t **levels,
+                        stencil_matrix_t *outputs[2])
+{
+    const ptrdiff_t rows = header->rows;
+    const ptrdiff_t band = band_rows;
+    const ptrdiff_t shift = time_steps;
+    const size_t row_size = header->stride * sizeof(double);
+
+    // the first band is read before the pipeline starts
+    struct band_transfer read = {
+        .fd = src_fd, .header = header, .first_row = 0, .rows = (band < rows) ? band : rows,
+        .values = band_row(inputs[0], 2), .write = false
+    };
+    if (!transfer_band(&read)) {
+        return false;
+    }
+
+    bool done = true;
+    for (ptrdiff_t r0 = 0; r0 < rows + shift; r0 += band) {
+        struct band_io io;
+
+        // the last level of the band before
+        const ptrdiff_t first_output = (r0 - band - shift > 0) ? r0 - band - shift : 0;
+        const ptrdiff_t last_output = (r0 - shift < rows) ? r0 - shift : rows;
+        io.transfers[0] = (struct band_transfer) {
+            .fd = dest_fd, .header = header, .first_row = first_output,
+            .rows = (last_output > first_output) ? last_output - first_output : 0,
+            .values = band_row(outputs[1], first_output - (r0 - band - shift)), .write = true
+        };
+
+        // the first level of the next band
+        const ptrdiff_t first_input = r0 + band;
+        const ptrdiff_t last_input = (r0 + 2 * band < rows) ? r0 + 2 * band : rows;
+        io.transfers[1] = (struct band_transfer) {
+            .fd = src_fd, .header = header, .first_row = first_input,
+            .rows = (last_input > first_input) ? last_input - first_input : 0,
+            .values = band_row(inputs[1], 2), .write = false
+        };
+
+        pthread_t thread;
+        const bool threaded = (pthread_create(&thread, NULL, transfer_bands, &io) == 0);
+        if (!threaded) {
+            transfer_bands(&io);
+        }
+
+        if (time_steps == 0) {
+            memcpy(outputs[0]->values, band_row(inputs[0], 2), band * row_size);
+        }
+        for (ptrdiff_t level = 1; level <= shift; level++) {
+            const stencil_matrix_t *src = (level == 1) ? inputs[0] : levels[level - 1];
+            if (level < shift) {
+                five_point_band(levels[level], r0 - level - 2, src, r0 - level + 1 - 2,
+                                r0 - level, r0 + band - level, rows);
+            } else {
+                five_point_band(outputs[0], r0 - level, src, r0 - level + 1 - 2,
+                                r0 - level, r0 + band - level, rows);
+            }
+        }
+
+        if (threaded) {
+            pthread_join(thread, NULL);
+        }
+        done = done && io.done;
+
+        // carry the two rows above the next band over
+        memcpy(band_row(inputs[1], 0), band_row(inputs[0], band), 2 * row_size);
+        for (ptrdiff_t level = 1; level < shift; level++) {
+            memmove(band_row(levels[level], 0), band_row(levels[level], band), 2 * row_size);
+        }
+
+        stencil_matrix_t *tmp = inputs[0];
+        inputs[0] = inputs[1];
+        inputs[1] = tmp;
+
+        tmp = outputs[0];
+        outputs[0] = outputs[1];
+        outputs[1] = tmp;
+    }
+
+    // the last band of the last level
+    const ptrdiff_t r0 = (rows + shift + band - 1) / band * band;
+    const ptrdiff_t first_output = (r0 - band - shift > 0) ? r0 - band - shift : 0;
+    const ptrdiff_t last_output = rows;
+    if (last_output > first_output) {
+        struct band_transfer write = {
+            .fd = dest_fd, .header = header, .first_row = first_output, .rows = last_output - first_output,
+            .values = band_row(outputs[1], first_output - (r0 - band - shift)), .write = true
+        };
+        done = transfer_band(&write) && done;
+    }
+
+    return done;
+}
+
+double five_point_stencil_stream(const char *input, const char *output, const size_t iterations,
+                                 const size_t time_steps, const size_t memory_budget)
+{
+    if (time_steps == 0) {
+        return -1.0;
+    }
+
+    stencil_binary_header_t header;
+    if (!stencil_binary_read_header(input, &header) || header.dtype != STENCIL_BINARY_DOUBLE ||
+        header.boundary < 1) {
+        return -1.0;
+    }
+
+    // first level and last level are double-buffered: (time_steps + 3) buffers of (band + 2) rows
+    const size_t row_size = header.stride * sizeof(double);
+    const size_t budget_rows = memory_budget / row_size / (time_steps + 3);
+    const size_t band_rows = (budget_rows > 3) ? budget_rows - 2 : 1;
+
+    double wall_time = -1.0;
+
+    const int src_fd = open(input, O_RDONLY);
+    const int dest_fd = open(output, O_RDWR | O_CREAT, 0644); // not truncated, the input may be the output
+    stencil_matrix_t *inputs[2] = {new_band(band_rows + 2, &header), new_band(band_rows + 2, &header)};
+    stencil_matrix_t *outputs[2] = {new_band(band_rows, &header), new_band(band_rows, &header)};
+    stencil_matrix_t **levels = (stencil_matrix_t **)calloc(time_steps, sizeof(stencil_matrix_t *));
+    bool allocated = (src_fd >= 0) && (dest_fd >= 0) && inputs[0] && inputs[1] && outputs[0] && outputs[1] && levels;
+    for (size_t level = 1; allocated && level < time_steps; level++) {
+        levels[level] = new_band(band_rows + 2, &header);
+        allocated = (levels[level] != NULL);
+    }
+    if (!allocated) {
+        goto exit;
+    }
+
+    header.iteration = 0;
+    unsigned char bytes[STENCIL_BINARY_HEADER_SIZE];
+    stencil_binary_encode_header(&header, bytes);
+    if (pwrite(dest_fd, bytes, STENCIL_BINARY_HEADER_SIZE, 0) != STENCIL_BINARY_HEADER_SIZE ||
+        ftruncate(dest_fd, header.offset + header.rows * row_size) != 0) {
+        goto exit;
+    }
+
+    const double t1 = omp_get_wtime();
+
+    // the first pass reads the input, all others work in place on the output
+    size_t done = 0;
+    bool streamed = stream_pass(src_fd, dest_fd, &header, (iterations < time_steps) ? iterations : time_steps,
+                                band_rows, inputs, levels, outputs);
+    done += (iterations < time_steps) ? iterations : time_steps;
+    while (streamed && done < iterations) {
+        const size_t steps = (iterations - done < time_steps) ? iterations - done : time_steps;
+        streamed = stream_pass(dest_fd, dest_fd, &header, steps, band_rows, inputs, levels, outputs);
+        done += steps;
+    }
+
+    const double t2 = omp_get_wtime();
+
+    if (streamed) {
+        wall_time = (t2 - t1) * 1000.0;
+    }
+
+exit:
+    if (levels != NULL) {
+        for (size_t level = 1; level < time_steps; level++) {
+            stencil_matrix_free(levels[level]);
+        }
+        free(levels);
+    }
+    stencil_matrix_free(outputs[1]);
+    stencil_matrix_free(outputs[0]);
+    stencil_matrix_free(inputs[1]);
+    stencil_matrix_free(inputs[0]);
+    if (dest_fd >= 0) {
+        close(dest_fd);
+    }
+    if (src_fd >= 0) {
+        close(src_fd);
+    }
+
+    return wall_time;
+}
@@ -1,13 +1,223 @@
 #ifndef __STENCIL_OPENMP
 #define __STENCIL_OPENMP
 
+#include <stdbool.h>
+
 #include <stencil/matrix.h>
+#include <stencil/vector.h>
+#include <stencil/descriptor.h>
+#include <stencil/convergence.h>
+#include <stencil/kernel.h>
+#include <stencil/matrix_float.h>
+#include <stencil/checkpoint.h>
+#include <stencil/frames.h>
+#include <stencil/wisdom.h>
+#include <stencil/topology.h>
+
+/**
+ * Touches the (not yet initialized) values of matrix \a matrix in the row partitioning of the
+ * parallel loops (schedule(static)), thus with the first-touch policy every page is placed on
+ * the NUMA node of the thread which calculates it.
+ */
+void first_touch_matrix(stencil_matrix_t *matrix);
 
 double five_point_stencil_with_tmp_matrix(stencil_matrix_t *matrix, const size_t iterations);
 double five_point_stencil_with_one_vector(stencil_matrix_t *matrix, const size_t iterations);
 double five_point_stencil_with_one_vector_tld(stencil_matrix_t *matrix, const size_t iterations);
 double five_point_stencil_with_one_vector_columnwise(stencil_matrix_t *matrix, const size_t iterations);
 double five_point_stencil_with_one_vector_columnwise_tld(stencil_matrix_t *matrix, const size_t iterations);
+
+/**
+ * With the placement STENCIL_PLACEMENT_TOPOLOGY (STENCIL_PLACEMENT=topology) the blockwise
+ * variants pin their threads in the order of the topology of the CPUs (probed once) and
+ * map the blocks such that the threads which share a last level cache calculate
+ * neighbouring blocks, the halos between them stay in the shared cache. The pinning
+ * replaces the binding of OMP_PROC_BIND, which should not bind the calling thread to a
+ * single CPU before the first call.
+ */
 double five_point_stencil_with_one_vector_blockwise_tld(stencil_matrix_t *matrix, const size_t iterations);
 
+/**
+ * Same as the tld variants (rows, columns and blocks), but the threads are synchronized
+ * point-to-point: instead of two barriers per iteration a thread only waits for the
+ * progress counters of its two (four) neighbouring partitions. The threads are placed
+ * like the ones of five_point_stencil_with_one_vector_blockwise_tld.
+ *
+ * @return returns the needed time for the calculation in msec, -1 on failure
+ */
+double five_point_stencil_with_one_vector_tld_p2p(stencil_matrix_t *matrix, const size_t iterations);
+double five_point_stencil_with_one_vector_columnwise_tld_p2p(stencil_matrix_t *matrix, const size_t iterations);
+double five_point_stencil_with_one_vector_blockwise_tld_p2p(stencil_matrix_t *matrix, const size_t iterations);
+
+#define STENCIL_WAVEFRONT_TILE_ROWS 64  // default rows of a wavefront tile
+#define STENCIL_WAVEFRONT_TILE_COLS 512 // default cols of a wavefront tile (4 KiB per row)
+
+/**
+ * Dynamically scheduled wavefront: every (tile, iteration) pair is a task which only
+ * depends (depend clauses) on the previous iteration of the tile and its four
+ * neighbours, thus tiles advance as soon as their neighbours are done and iterations
+ * overlap instead of waiting at a barrier. The tiles are balanced and have at most
+ * \a tile_rows x \a tile_cols fields (0: STENCIL_WAVEFRONT_TILE_*).
+ *
+ * @return returns the needed time for the calculation in msec, -1 on failure
+ */
+double five_point_stencil_wavefront(stencil_matrix_t *matrix, const size_t iterations, size_t tile_rows,
+                                    size_t tile_cols);
+
+/**
+ * Dispatches to the fastest variant for the class of the matrix (see stencil/wisdom.h)
+ * and the number of threads. On the first call for a class all variants (and the
+ * partitionings of the blockwise p2p variant) are measured on a copy of the matrix, the
+ * fastest one is stored in \a wisdom and its file.
+ *
+ * @return returns the needed time for the calculation in msec (without the measurements)
+ */
+double five_point_stencil_tuned(stencil_matrix_t *matrix, const size_t iterations, stencil_wisdom_t *wisdom);
+
+/**
+ * Per-thread buffers of the engine, allocated (and first touched) by the thread which
+ * uses them and kept until the size of the matrix changes.
+ */
+struct stencil_openmp_worker {
+    stencil_vector_t *vec;       // one vector: first row of the thread
+    stencil_vector_t *last_vec;  // one vector: last row of the thread
+    stencil_matrix_t *submatrix; // one vector tld: rows of the thread with halo
+    stencil_vector_t *tmp;       // one vector tld: row vector
+};
+
+/**
+ * Execution engine for repeated calls: the buffers of the iterations (tmp matrix and the
+ * per-thread vectors and submatrices) are allocated once and every call runs a single
+ * parallel region of \a threads threads, thus the runtime reuses the same (pinned) team.
+ */
+struct stencil_openmp_engine {
+    int threads;
+    bool pinned; // the threads are pinned to one CPU each
+    stencil_affinity_t affinity; // affinity of the creating thread, restored when the engine is freed
+    stencil_matrix_t *tmp_matrix;
+    stencil_matrix_t **submatrices; // submatrices of all threads (one vector tld)
+    struct stencil_openmp_worker *workers;
+};
+typedef struct stencil_openmp_engine stencil_openmp_engine_t;
+
+/**
+ * Creates an engine with \a threads threads (0: omp_get_max_threads).
+ *
+ * @param pin pins the threads to the CPUs of the calling thread in the order of their
+ *            topology (see stencil/topology.h, unless OMP_PROC_BIND is set), the runtime
+ *            keeps them for regions of the same size
+ *
+ * @return A pointer to the engine, NULL on failure
+ */
+stencil_openmp_engine_t *stencil_openmp_engine_new(int threads, bool pin);
+
+/**
+ * Frees the engine, the threads of a pinned engine get the affinity of the thread which
+ * created it back (thus it has to be freed by the same thread).
+ */
+void stencil_openmp_engine_free(stencil_openmp_engine_t *engine);
+
+/**
+ * Same as five_point_stencil_with_tmp_matrix, five_point_stencil_with_one_vector and
+ * five_point_stencil_with_one_vector_tld with the buffers and the team of \a engine.
+ */
+double five_point_stencil_engine_tmp_matrix(stencil_openmp_engine_t *engine, stencil_matrix_t *matrix,
+                                            const size_t iterations);
+double five_point_stencil_engine_one_vector(stencil_openmp_engine_t *engine, stencil_matrix_t *matrix,
+                                            const size_t iterations);
+double five_point_stencil_engine_one_vector_tld(stencil_openmp_engine_t *engine, stencil_matrix_t *matrix,
+                                                const size_t iterations);
+
+/**
+ * One in-place sweep of \a descriptor on the non-boundary fields of \a matrix with the
+ * team of \a engine, the old values are read from the tmp matrix of the engine. The
+ * values are the same as the ones of stencil_descriptor_sweep.
+ *
+ * @param residual calculates the partial residual of the sweep (see stencil_row_residual)
+ *
+ * @return returns the partial residual of the sweep in norm \a norm, 0 if \a residual is false
+ */
+double stencil_engine_descriptor_sweep(stencil_openmp_engine_t *engine, stencil_matrix_t *matrix,
+                                       const stencil_descriptor_t *descriptor, bool residual, stencil_norm_t norm);
+
+/**
+ * Same as stencil_five_point_sweep_sor with the team of \a engine (the rows of a colour
+ * are independent).
+ *
+ * @return returns the partial residual of the half sweep
+ */
+double five_point_stencil_engine_sor_sweep(stencil_openmp_engine_t *engine, stencil_matrix_t *matrix,
+                                           stencil_colour_t colour, size_t parity, double omega, stencil_norm_t norm);
+
+double stencil_with_descriptor(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor, const size_t iterations);
+
+/**
+ * tmp matrix iterations with periodic checkpoints, the iteration continues while the
+ * background thread of \a checkpoint writes the snapshot.
+ *
+ * @param matrix matrix after checkpoint->iteration iterations (see stencil_checkpoint_restore)
+ * @param iterations total number of iterations (including the restored ones)
+ * @return returns the needed time for the calculation in msec
+ */
+double five_point_stencil_with_checkpoint(stencil_matrix_t *matrix, const size_t iterations,
+                                          stencil_checkpoint_t *checkpoint);
+
+/**
+ * tmp matrix iterations which hand a frame to the writer of \a frames every
+ * frames->interval iterations, all iterations run in one parallel region and the
+ * threads only copy the frame (a frame is dropped if all slots wait for the writer).
+ *
+ * @return returns the needed time for the calculation in msec
+ */
+double five_point_stencil_with_frames(stencil_matrix_t *matrix, const size_t iterations, stencil_frames_t *frames);
+
+/**
+ * Out-of-core tmp matrix iterations on the binary grid file \a input (dtype double, see
+ * stencil/binary.h), the result is written to the grid file \a output (may be \a input).
+ * Only bands of rows are held in memory: every pass streams the file once and fuses
+ * \a time_steps iterations, each iteration lags one row behind the one before. The next
+ * band is read and the last one written by a second thread while a band is calculated.
+ *
+ * @param time_steps iterations per pass over the file (at least 1, 0 fails)
+ * @param memory_budget bytes of all bands, the bands have at least one row
+ * @return returns the needed time for the calculation in msec, -1 on failure
+ */
+double five_point_stencil_stream(const char *input, const char *output, const size_t iterations,
+                                 const size_t time_steps, const size_t memory_budget);
+
+/**
+ * tmp matrix iterations until the residual drops below the tolerance, the residual
+ * is reduced over all threads (OpenMP reduction) on every check iteration.
+ *
+ * @param convergence convergence parameters, receives the number of iterations and the last residual
+ * @return returns the needed time for the calculation in msec
+ */
+double five_point_stencil_until_converged(stencil_matrix_t *matrix, stencil_convergence_t *convergence);
+
+/**
+ * In-place red-black SOR iterations, every half-sweep (one colour) is a parallel loop
+ * over the rows.
+ *
+ * @param omega relaxation factor (1 is Gauss-Seidel, see stencil_sor_optimal_omega)
+ * @return returns the needed time for the calculation in msec
+ */
+double five_point_stencil_sor(stencil_matrix_t *matrix, double omega, const size_t iterations);
+
+/**
+ * Same as five_point_stencil_sor, but iterates until the residual (update of both
+ * colours) drops below the tolerance.
+ *
+ * @param convergence convergence parameters, receives the number of iterations and the last residual
+ * @return returns the needed time for the calculation in msec
+ */
+double five_point_stencil_sor_until_converged(stencil_matrix_t *matrix, double omega, stencil_convergence_t *convergence);
+
+/**
+ * tmp matrix iterations on a single-precision matrix.
+ *
+ * @param precision arithmetic of the kernel (float or double with float storage)
+ * @return returns the needed time for the calculation in msec
+ */
+double five_point_stencil_float(stencil_matrix_float_t *matrix, const size_t iterations, stencil_precision_t precision);
+
 #endif // __STENCIL_OPENMP
@@ -1,6 +1,11 @@
 #include <stdlib.h>
+#include <unistd.h>
+
+#include <omp.h>
 
 #include <stencil/util.h>
+#include <stencil/binary.h>
+#include <stencil/topology.h>
 
 #include "stencil_openmp/stencil_openmp.h"
 
@@ -33,6 +38,133 @@ int main(int argc, char **argv)
     five_point_stencil_with_one_vector_columnwise_tld(matrix, TEST_ITERATIONS);
 #elif defined(STENCIL_ONE_VECTOR_BLOCKWISE_TLD)
     five_point_stencil_with_one_vector_blockwise_tld(matrix, TEST_ITERATIONS);
+#elif defined(STENCIL_ONE_VECTOR_TLD_P2P)
+    five_point_stencil_with_one_vector_tld_p2p(matrix, TEST_ITERATIONS);
+#elif defined(STENCIL_ONE_VECTOR_COLWISE_TLD_P2P)
+    five_point_stencil_with_one_vector_columnwise_tld_p2p(matrix, TEST_ITERATIONS);
+#elif defined(STENCIL_ONE_VECTOR_BLOCKWISE_TLD_P2P)
+    five_point_stencil_with_one_vector_blockwise_tld_p2p(matrix, TEST_ITERATIONS);
+#elif defined(STENCIL_WAVEFRONT)
+    // small tiles, thus the test matrices have several tiles per dimension
+    five_point_stencil_wavefront(matrix, TEST_ITERATIONS, 4, 4);
+#elif defined(STENCIL_TOPOLOGY)
+    // pinned threads, the blocks are mapped by the shared caches of the CPUs
+    stencil_topology_set_placement(STENCIL_PLACEMENT_TOPOLOGY);
+    five_point_stencil_with_one_vector_blockwise_tld(matrix, 2);
+    five_point_stencil_with_one_vector_blockwise_tld_p2p(matrix, TEST_ITERATIONS - 2);
+#elif defined(STENCIL_DESCRIPTOR)
+    // five-point stencil using the generic kernel
+    const stencil_point_t points[] = {{-1, 0, 0.25}, {0, -1, 0.25}, {0, 1, 0.25}, {1, 0, 0.25}};
+    stencil_descriptor_t *descriptor = stencil_descriptor_new(4, points);
+    stencil_with_descriptor(matrix, descriptor, TEST_ITERATIONS);
+    stencil_descriptor_free(descriptor);
+#elif defined(STENCIL_CONVERGENCE)
+    // never converges (tolerance 0), even and odd check iterations
+    stencil_convergence_t convergence;
+    stencil_convergence_init(&convergence, STENCIL_NORM_L2, 0.0, 2, TEST_ITERATIONS);
+    five_point_stencil_until_converged(matrix, &convergence);
+#elif defined(STENCIL_FLOAT)
+    stencil_matrix_float_t *matrix_float = stencil_matrix_float_from_matrix(matrix);
+    five_point_stencil_float(matrix_float, TEST_ITERATIONS, STENCIL_PRECISION_MIXED);
+    stencil_matrix_float_to_matrix(matrix_float, matrix);
+    stencil_matrix_float_free(matrix_float);
+#elif defined(STENCIL_SOR)
+    five_point_stencil_sor(matrix, 1.5, TEST_ITERATIONS);
+#elif defined(STENCIL_CHECKPOINT)
+    // the first run stops after 3 iterations, the second one restarts from its last checkpoint
+    char filepath[] = "unit_test_checkpoint_XXXXXX";
+    close(mkstemp(filepath));
+
+    stencil_checkpoint_t *checkpoint = stencil_checkpoint_new(filepath, 1, 0.0);
+    five_point_stencil_with_checkpoint(matrix, 3, checkpoint);
+    stencil_checkpoint_free(checkpoint);
+    stencil_matrix_free(matrix);
+
+    checkpoint = stencil_checkpoint_new(filepath, 1, 0.0);
+    matrix = stencil_checkpoint_restore(checkpoint);
+    if (matrix == NULL || checkpoint->iteration != 3) {
+        stencil_checkpoint_free(checkpoint);
+        unlink(filepath);
+        return EXIT_FAILURE;
+    }
+    five_point_stencil_with_checkpoint(matrix, TEST_ITERATIONS, checkpoint);
+    stencil_checkpoint_free(checkpoint);
+    unlink(filepath);
+#elif defined(STENCIL_STREAM)
+    // bands of 2 rows (2 fused iterations per pass), the result is written to a second file
+    char input[] = "unit_test_stream_XXXXXX";
+    char output[] = "unit_test_stream_XXXXXX";
+    FILE *stream = fdopen(mkstemp(input), "wb");
+    close(mkstemp(output));
+    const bool written = stencil_binary_write(matrix, stream);
+    fclose(stream);
+    const size_t budget = (2 + 2) * (2 + 3) * matrix->stride * sizeof(double);
+    stencil_matrix_free(matrix);
+
+    matrix = NULL;
+    if (written && five_point_stencil_stream(input, output, TEST_ITERATIONS, 2, budget) >= 0.0) {
+        matrix = stencil_binary_map(output);
+    }
+    unlink(output);
+    unlink(input);
+    if (matrix == NULL) {
+        return EXIT_FAILURE;
+    }
+#elif defined(STENCIL_FRAMES)
+    // a frame per iteration (the slots hold all of them), the last frame is the result
+    char prefix[] = "unit_test_frames_XXXXXX";
+    close(mkstemp(prefix));
+
+    stencil_frames_t *frames = stencil_frames_new(prefix, STENCIL_FRAME_BINARY, matrix, 1, TEST_ITERATIONS);
+    five_point_stencil_with_frames(matrix, TEST_ITERATIONS, frames);
+    const bool written = stencil_frames_free(frames);
+
+    stencil_matrix_t *frame = NULL;
+    char filepath[sizeof(prefix) + 32];
+    for (size_t iteration = 1; iteration <= TEST_ITERATIONS; iteration++) {
+        snprintf(filepath, sizeof(filepath), "%s.%zu", prefix, iteration);
+        if (iteration == TEST_ITERATIONS && written) {
+            frame = new_matrix_from_file(filepath);
+        }
+        unlink(filepath);
+    }
+    unlink(prefix);
+
+    stencil_matrix_free(matrix);
+    matrix = frame;
+    if (matrix == NULL) {
+        return EXIT_FAILURE;
+    }
+#elif defined(STENCIL_ENGINE)
+    // all variants on the buffers of one engine, the calls continue the iterations
+    stencil_openmp_engine_t *engine = stencil_openmp_engine_new(0, true);
+    if (engine == NULL) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+    five_point_stencil_engine_one_vector_tld(engine, matrix, 2);
+    five_point_stencil_engine_tmp_matrix(engine, matrix, 2);
+    five_point_stencil_engine_one_vector(engine, matrix, TEST_ITERATIONS - 4);
+    stencil_openmp_engine_free(engine);
+#elif defined(STENCIL_TUNED)
+    // the first call measures the variants and writes the wisdom, the second one reads it
+    char wisdom_path[] = "unit_test_wisdom_XXXXXX";
+    close(mkstemp(wisdom_path));
+
+    stencil_wisdom_t *wisdom = stencil_wisdom_load(wisdom_path);
+    five_point_stencil_tuned(matrix, 2, wisdom);
+    stencil_wisdom_free(wisdom);
+
+    wisdom = stencil_wisdom_load(wisdom_path);
+    const bool tuned = (stencil_wisdom_lookup(wisdom, matrix->rows, matrix->cols, omp_get_max_threads()) != NULL);
+    five_point_stencil_tuned(matrix, TEST_ITERATIONS - 2, wisdom);
+    stencil_wisdom_free(wisdom);
+    unlink(wisdom_path);
+
+    if (!tuned) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
 #endif
     matrix_to_file(matrix, stdout);
 
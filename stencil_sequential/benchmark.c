@@ -6,12 +6,17 @@
 #include <float.h>
 
 #include "stencil/util.h"
+#include "stencil/kernel.h"
 #include "stencil_sequential/stencil_sequential.h"
 
 #define BENCHMARK_ITERATIONS 30
 
 //#define STENCIL_ONE_VECTOR
 //#define STENCIL_TMP_MATRIX
+//#define STENCIL_TEMPORAL_BLOCKING
+//#define STENCIL_CONVERGENCE
+//#define STENCIL_FLOAT
+//#define STENCIL_SOR
 
 int main(int argc, char **argv)
 {
@@ -22,11 +27,44 @@ int main(int argc, char **argv)
     size_t rows = strtol(argv[1], NULL, 10);
     size_t cols = strtol(argv[2], NULL, 10);
     size_t iterations = strtol(argv[3], NULL, 10);
+#if defined(STENCIL_TEMPORAL_BLOCKING)
+    // 0 selects the default tile width and number of time steps
+    const long tile_cols = (argc > 4) ? strtol(argv[4], NULL, 10) : TEMPORAL_BLOCKING_TILE_COLS;
+    const long time_steps = (argc > 5) ? strtol(argv[5], NULL, 10) : TEMPORAL_BLOCKING_TIME_STEPS;
+    if (tile_cols < 0 || time_steps < 0) {
+        return EXIT_FAILURE;
+    }
+#elif defined(STENCIL_CONVERGENCE)
+    // tolerance 0 (all iterations are done), measures the overhead of the residual checks
+    size_t check_interval = (argc > 4) ? strtol(argv[4], NULL, 10) : STENCIL_CONVERGENCE_CHECK_INTERVAL;
+    stencil_convergence_t convergence;
+#elif defined(STENCIL_SOR)
+    // the optimal relaxation factor of the grid is used by default
+    double omega = (argc > 4) ? strtod(argv[4], NULL) : 0.0;
+#elif defined(STENCIL_FLOAT)
+    // "mixed" calculates in double precision, the matrix is stored in single precision
+    stencil_precision_t precision = (argc > 4 && strcmp(argv[4], "mixed") == 0) ? STENCIL_PRECISION_MIXED
+                                                                              : STENCIL_PRECISION_SINGLE;
+#endif
 
     stencil_matrix_t *matrix = new_randomized_matrix(rows, cols, 1, 0, 100);
     if (matrix == NULL) {
         return EXIT_FAILURE;
     }
+    // the page policy which took effect (STENCIL_PAGES=normal|transparent|huge)
+    fprintf(stderr, "pages: %s\n", stencil_pages_name(matrix->pages));
+#if defined(STENCIL_SOR)
+    if (omega <= 0.0) {
+        omega = stencil_sor_optimal_omega(matrix);
+    }
+#endif
+#if defined(STENCIL_FLOAT)
+    stencil_matrix_float_t *matrix_float = stencil_matrix_float_from_matrix(matrix);
+    if (matrix_float == NULL) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+#endif
 
     double min = DBL_MAX;
     double max = DBL_MIN;
@@ -36,6 +74,15 @@ int main(int argc, char **argv)
         const double elapsed_time = five_point_stencil_with_one_vector(matrix, iterations);
 #elif defined(STENCIL_TMP_MATRIX)
         const double elapsed_time = five_point_stencil_with_tmp_matrix(matrix, iterations);
+#elif defined(STENCIL_TEMPORAL_BLOCKING)
+        const double elapsed_time = five_point_stencil_with_temporal_blocking(matrix, iterations, tile_cols, time_steps);
+#elif defined(STENCIL_CONVERGENCE)
+        stencil_convergence_init(&convergence, STENCIL_NORM_MAX, 0.0, check_interval, iterations);
+        const double elapsed_time = five_point_stencil_until_converged(matrix, &convergence);
+#elif defined(STENCIL_SOR)
+        const double elapsed_time = five_point_stencil_sor(matrix, omega, iterations);
+#elif defined(STENCIL_FLOAT)
+        const double elapsed_time = five_point_stencil_float(matrix_float, iterations, precision);
 #endif
         min = fmin(min, elapsed_time);
         max = fmax(max, elapsed_time);
@@ -45,6 +92,9 @@ int main(int argc, char **argv)
     const double avg = sum / BENCHMARK_ITERATIONS;
     fprintf(stdout, "%f;%f;%f", min, avg, max);
 
+#if defined(STENCIL_FLOAT)
+    stencil_matrix_float_free(matrix_float);
+#endif
     stencil_matrix_free(matrix);
     return EXIT_SUCCESS;
 }
\ No newline at end of file
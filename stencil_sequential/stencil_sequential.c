@@ -6,17 +6,12 @@
 
 #include "stencil/vector.h"
 #include "stencil/util.h"
+#include "stencil/kernel.h"
+#include "stencil/descriptor.h"
+#include "stencil/convergence.h"
 
 #include "stencil_sequential.h"
 
-inline double stencil_five_point_kernel(const stencil_matrix_t *const matrix, size_t row, size_t col)
-{
-    return (stencil_matrix_get(matrix, row - 1, col) +
-            stencil_matrix_get(matrix, row, col - 1) +
-            stencil_matrix_get(matrix, row, col + 1) +
-            stencil_matrix_get(matrix, row + 1, col)) * 0.25;
-}
-
 double five_point_stencil_with_tmp_matrix(stencil_matrix_t *matrix, const size_t iterations)
 {
     assert(matrix->boundary >= 1);
@@ -24,16 +19,17 @@ double five_point_stencil_with_tmp_matrix(stencil_matrix_t *matrix, const size_t
     stencil_matrix_t *tmp_matrix = stencil_matrix_get_submatrix(matrix, 0, 0, matrix->rows, matrix->cols, matrix->boundary);
 
     const size_t rows = matrix->rows - matrix->boundary;
-    const size_t cols = matrix->cols - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
 
     double t1 = get_time();
 
     for (size_t iteration = 1; iteration <= iterations; iteration++) {
         for (size_t row = matrix->boundary; row < rows; row++) {
-            for (size_t col = matrix->boundary; col < cols; col++) {
-                const double value = stencil_five_point_kernel(tmp_matrix, row, col);
-                stencil_matrix_set(matrix, row, col, value);
-            }
+            stencil_five_point_row(stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row - 1, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row, matrix->boundary),
+                                   stencil_matrix_get_ptr(tmp_matrix, row + 1, matrix->boundary),
+                                   cols);
         }
         stencil_matrix_t *tmp = tmp_matrix;
         tmp_matrix = matrix;
@@ -46,6 +42,9 @@ double five_point_stencil_with_tmp_matrix(stencil_matrix_t *matrix, const size_t
         stencil_matrix_t *tmp = tmp_matrix;
         tmp_matrix = matrix;
         matrix = tmp;
+    } else {
+        // the last iteration has written to the tmp matrix
+        stencil_matrix_copy_values(matrix, tmp_matrix);
     }
 
     stencil_matrix_free(tmp_matrix);
@@ -61,23 +60,26 @@ double five_point_stencil_with_two_vectors(stencil_matrix_t *matrix, const size_
     stencil_vector_t *current = stencil_vector_new(matrix->cols);
 
     const size_t rows = matrix->rows - matrix->boundary;
-    const size_t cols = matrix->cols - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
 
     double t1 = get_time();
 
     for (size_t iteration = 1; iteration <= iterations; iteration++) {
         // calculate the first row
         const size_t first_row = matrix->boundary;
-        for (size_t col = matrix->boundary; col < cols; col++) {
-            stencil_vector_set(above, col, stencil_five_point_kernel(matrix, first_row, col));
-        }
+        stencil_five_point_row(stencil_vector_get_ptr(above, matrix->boundary),
+                               stencil_matrix_get_ptr(matrix, first_row - 1, matrix->boundary),
+                               stencil_matrix_get_ptr(matrix, first_row, matrix->boundary),
+                               stencil_matrix_get_ptr(matrix, first_row + 1, matrix->boundary),
+                               cols);
 
         // calculate the remaining rows
         for (size_t row = first_row + 1; row < rows; row++) {
-            for (size_t col = matrix->boundary; col < cols; col++) {
-                const double value = stencil_five_point_kernel(matrix, row, col);
-                stencil_vector_set(current, col, value);
-            }
+            stencil_five_point_row(stencil_vector_get_ptr(current, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, row - 1, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                   stencil_matrix_get_ptr(matrix, row + 1, matrix->boundary),
+                                   cols);
 
             stencil_matrix_set_row(matrix, row - 1, above);
             stencil_vector_t *tmp = above;
@@ -104,25 +106,26 @@ double five_point_stencil_with_one_vector(stencil_matrix_t *matrix, const size_t
     stencil_vector_t *tmp = stencil_vector_new(matrix->cols);
 
     const size_t rows = matrix->rows - matrix->boundary;
-    const size_t cols = matrix->cols - matrix->boundary;
+    const size_t cols = matrix->cols - 2 * matrix->boundary;
 
     double t1 = get_time();
 
     for (size_t iteration = 1; iteration <= iterations; iteration++) {
         // calculate the first row
         const size_t first_row = matrix->boundary;
-        for (size_t col = matrix->boundary; col < cols; col++) {
-            stencil_vector_set(tmp, col, stencil_five_point_kernel(matrix, first_row, col));
-        }
+        stencil_five_point_row(stencil_vector_get_ptr(tmp, matrix->boundary),
+                               stencil_matrix_get_ptr(matrix, first_row - 1, matrix->boundary),
+                               stencil_matrix_get_ptr(matrix, first_row, matrix->boundary),
+                               stencil_matrix_get_ptr(matrix, first_row + 1, matrix->boundary),
+                               cols);
 
-        // calculate the remaining rows
+        // calculate the remaining rows (copies back the previously calculated row)
         for (size_t row = first_row + 1; row < rows; row++) {
-            for (size_t col = matrix->boundary; col < cols; col++) {
-                const double value = stencil_five_point_kernel(matrix, row, col);
-                // copy back the previosly calculated value before we overwrite it
-                stencil_matrix_set(matrix, row - 1, col, stencil_vector_get(tmp, col));
-                stencil_vector_set(tmp, col, value);
-            }
+            stencil_five_point_row_one_vector(stencil_matrix_get_ptr(matrix, row - 1, matrix->boundary),
+                                              stencil_vector_get_ptr(tmp, matrix->boundary),
+                                              stencil_matrix_get_ptr(matrix, row, matrix->boundary),
+                                              stencil_matrix_get_ptr(matrix, row + 1, matrix->boundary),
+                                              cols);
         }
 
         // copy back calculated values of the last non-boundary row
@@ -134,4 +137,255 @@ double five_point_stencil_with_one_vector(stencil_matrix_t *matrix, const size_t
     stencil_vector_free(tmp);
 
     return t2 - t1;
-}
\ No newline at end of file
+}
+
+/**
+ * Returns the row \a row of time level \a level, starting at column \a first_col of the tile.
+ * The boundary rows never change, thus they are taken directly from the matrix.
+ */
+static inline double *temporal_blocking_row(const stencil_matrix_t *matrix, double *ring, size_t width,
+                                            size_t first_col, size_t level, size_t row)
+{
+    if (row < matrix->boundary || row >= (matrix->rows - matrix->boundary)) {
+        return stencil_matrix_get_ptr(matrix, row, first_col);
+    }
+    return ring + (level * 3 + row % 3) * width;
+}
+
+/**
+ * Advances the columns [\a start_col, \a end_col[ of the matrix by \a steps iterations.
+ *
+ * The rows are processed as a wavefront: in each step one new row of level 0 is loaded
+ * and every time level t computes the row which lags t - 1 rows behind, thus each level
+ * only needs a ring buffer of 3 rows. Level t is computed on a range which is widened by
+ * (steps - t) columns on each side (ghost zone), so only the last level is written back.
+ *
+ * The left ghost zone has already been overwritten by the previous tile, therefore its
+ * original values are taken from \a seam_in (steps columns per row). The original values
+ * of the last steps columns of this tile are stored into \a seam_out for the next tile.
+ */
+static void temporal_blocking_tile(stencil_matrix_t *matrix, const size_t steps,
+                                   const size_t start_col, const size_t end_col, double *ring,
+                                   const double *seam_in, double *seam_out)
+{
+    const size_t boundary = matrix->boundary;
+    const size_t first_row = boundary;
+    const size_t end_row = matrix->rows - boundary;
+    const size_t right_boundary = matrix->cols - boundary;
+
+    const size_t first_col = (start_col > steps) ? (start_col - steps) : 0;
+    const size_t last_col = (end_col + steps < matrix->cols) ? (end_col + steps) : matrix->cols;
+    const size_t width = last_col - first_col;
+
+    for (size_t step = first_row - 1; step < end_row + steps - 1; step++) {
+        // load the next row of level 0
+        const size_t load_row = step + 1;
+        if (load_row < end_row) {
+            double *dest = temporal_blocking_row(matrix, ring, width, first_col, 0, load_row);
+            memcpy(dest, stencil_matrix_get_ptr(matrix, load_row, first_col), width * sizeof(double));
+            if (seam_in != NULL) {
+                memcpy(dest, seam_in + (load_row - first_row) * steps, steps * sizeof(double));
+            }
+            if (seam_out != NULL) {
+                memcpy(seam_out + (load_row - first_row) * steps, dest + (end_col - steps - first_col),
+                       steps * sizeof(double));
+            }
+        }
+
+        // advance every level by one row
+        for (size_t level = 1; level <= steps && level <= step + 1; level++) {
+            const size_t row = step + 1 - level;
+            if (row < first_row) {
+                break;
+            }
+            if (row >= end_row) {
+                continue;
+            }
+
+            const size_t ghost = steps - level;
+            const size_t col = (start_col > boundary + ghost) ? (start_col - ghost) : boundary;
+            const size_t end = (end_col + ghost < right_boundary) ? (end_col + ghost) : right_boundary;
+            const size_t offset = col - first_col;
+
+            const double *above = temporal_blocking_row(matrix, ring, width, first_col, level - 1, row - 1);
+            const double *current = temporal_blocking_row(matrix, ring, width, first_col, level - 1, row);
+            const double *below = temporal_blocking_row(matrix, ring, width, first_col, level - 1, row + 1);
+
+            double *dest;
+            if (level == steps) {
+                dest = stencil_matrix_get_ptr(matrix, row, start_col);
+            } else {
+                dest = temporal_blocking_row(matrix, ring, width, first_col, level, row);
+
+                // the boundary columns of the tile stay the same on every level
+                if (first_col < boundary) {
+                    memcpy(dest, current, (boundary - first_col) * sizeof(double));
+                }
+                if (last_col > right_boundary) {
+                    memcpy(dest + (right_boundary - first_col), current + (right_boundary - first_col),
+                           (last_col - right_boundary) * sizeof(double));
+                }
+                dest += offset;
+            }
+
+            stencil_five_point_row(dest, above + offset, current + offset, below + offset, end - col);
+        }
+    }
+}
+
+double five_point_stencil_with_temporal_blocking(stencil_matrix_t *matrix, const size_t iterations,
+                                                 size_t tile_cols, size_t time_steps)
+{
+    assert(matrix->boundary >= 1);
+
+    tile_cols = (tile_cols > 0) ? tile_cols : TEMPORAL_BLOCKING_TILE_COLS;
+    time_steps = (time_steps > 0) ? time_steps : TEMPORAL_BLOCKING_TIME_STEPS;
+
+    // a tile has to be at least as wide as its ghost zone
+    if (tile_cols < time_steps) {
+        tile_cols = time_steps;
+    }
+
+    const size_t rows = matrix->rows - 2 * matrix->boundary;
+    const size_t end_col = matrix->cols - matrix->boundary;
+
+    double *ring = (double *)malloc(time_steps * 3 * (tile_cols + 2 * time_steps) * sizeof(double));
+    double *seam_in = (double *)malloc(rows * time_steps * sizeof(double));
+    double *seam_out = (double *)malloc(rows * time_steps * sizeof(double));
+
+    double t1 = get_time();
+
+    for (size_t iteration = 0; iteration < iterations; iteration += time_steps) {
+        const size_t steps = (iterations - iteration < time_steps) ? (iterations - iteration) : time_steps;
+
+        for (size_t col = matrix->boundary; col < end_col; col += tile_cols) {
+            const bool is_first_tile = (col == matrix->boundary);
+            const bool is_last_tile = (col + tile_cols >= end_col);
+
+            temporal_blocking_tile(matrix, steps, col, is_last_tile ? end_col : (col + tile_cols), ring,
+                                   is_first_tile ? NULL : seam_in, is_last_tile ? NULL : seam_out);
+
+            double *tmp = seam_in;
+            seam_in = seam_out;
+            seam_out = tmp;
+        }
+    }
+
+    double t2 = get_time();
+
+    free(ring);
+    free(seam_in);
+    free(seam_out);
+
+    return t2 - t1;
+}
+
+double stencil_with_descriptor(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor, const size_t iterations)
+{
+    assert(matrix->boundary >= descriptor->radius);
+
+    double *buffer = (double *)malloc((descriptor->radius + 1) * matrix->cols * sizeof(double));
+
+    double t1 = get_time();
+
+    for (size_t iteration = 1; iteration <= iterations; iteration++) {
+        stencil_descriptor_sweep(descriptor, matrix, buffer);
+    }
+
+    double t2 = get_time();
+
+    free(buffer);
+
+    return t2 - t1;
+}
+
+double stencil_until_converged(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor,
+                               stencil_convergence_t *convergence)
+{
+    assert(matrix->boundary >= descriptor->radius);
+
+    double *buffer = (double *)malloc((descriptor->radius + 1) * matrix->cols * sizeof(double));
+
+    double t1 = get_time();
+
+    for (size_t iteration = 1; iteration <= convergence->max_iterations; iteration++) {
+        if (!stencil_convergence_is_check(convergence, iteration)) {
+            stencil_descriptor_sweep(descriptor, matrix, buffer);
+            continue;
+        }
+
+        const double residual = stencil_descriptor_sweep_residual(descriptor, matrix, buffer, convergence->norm);
+        if (stencil_convergence_update(convergence, iteration, residual)) {
+            break;
+        }
+    }
+
+    double t2 = get_time();
+
+    free(buffer);
+
+    return t2 - t1;
+}
+
+double five_point_stencil_until_converged(stencil_matrix_t *matrix, stencil_convergence_t *convergence)
+{
+    return stencil_until_converged(matrix, &stencil_five_point, convergence);
+}
+
+double five_point_stencil_sor(stencil_matrix_t *matrix, double omega, const size_t iterations)
+{
+    assert(matrix->boundary >= 1);
+
+    double t1 = get_time();
+
+    for (size_t iteration = 1; iteration <= iterations; iteration++) {
+        stencil_five_point_sweep_sor(matrix, STENCIL_RED, 0, omega, STENCIL_NORM_MAX);
+        stencil_five_point_sweep_sor(matrix, STENCIL_BLACK, 0, omega, STENCIL_NORM_MAX);
+    }
+
+    double t2 = get_time();
+
+    return t2 - t1;
+}
+
+double five_point_stencil_sor_until_converged(stencil_matrix_t *matrix, double omega, stencil_convergence_t *convergence)
+{
+    assert(matrix->boundary >= 1);
+
+    const stencil_norm_t norm = convergence->norm;
+
+    double t1 = get_time();
+
+    for (size_t iteration = 1; iteration <= convergence->max_iterations; iteration++) {
+        const double red = stencil_five_point_sweep_sor(matrix, STENCIL_RED, 0, omega, norm);
+        const double black = stencil_five_point_sweep_sor(matrix, STENCIL_BLACK, 0, omega, norm);
+
+        if (stencil_convergence_is_check(convergence, iteration) &&
+            stencil_convergence_update(convergence, iteration, stencil_residual_combine(norm, red, black))) {
+            break;
+        }
+    }
+
+    double t2 = get_time();
+
+    return t2 - t1;
+}
+
+double five_point_stencil_float(stencil_matrix_float_t *matrix, const size_t iterations, stencil_precision_t precision)
+{
+    assert(matrix->boundary >= 1);
+
+    float *tmp = (float *)malloc(matrix->cols * sizeof(float));
+
+    double t1 = get_time();
+
+    for (size_t iteration = 1; iteration <= iterations; iteration++) {
+        stencil_five_point_sweep_float(matrix, tmp, precision);
+    }
+
+    double t2 = get_time();
+
+    free(tmp);
+
+    return t2 - t1;
+}
@@ -2,9 +2,88 @@
 #define __STENCIL_SEQUENTIAL
 
 #include "stencil/matrix.h"
+#include "stencil/descriptor.h"
+#include "stencil/convergence.h"
+#include "stencil/matrix_float.h"
 
 double five_point_stencil_with_tmp_matrix(stencil_matrix_t *matrix, const size_t iterations);
 double five_point_stencil_with_two_vectors(stencil_matrix_t *matrix, const size_t iterations);
 double five_point_stencil_with_one_vector(stencil_matrix_t *matrix, const size_t iterations);
 
+#define TEMPORAL_BLOCKING_TILE_COLS 512
+#define TEMPORAL_BLOCKING_TIME_STEPS 4
+
+/**
+ * Temporal blocking: the matrix is split into column tiles and each tile is advanced
+ * by \a time_steps iterations (time-skewed wavefront over the rows) while it is
+ * cache-resident. The result is bit-identical to five_point_stencil_with_one_vector.
+ *
+ * @param matrix matrix
+ * @param iterations number of iterations
+ * @param tile_cols number of columns per tile (at least \a time_steps, 0: TEMPORAL_BLOCKING_TILE_COLS)
+ * @param time_steps number of iterations per pass over the matrix (0: TEMPORAL_BLOCKING_TIME_STEPS)
+ *
+ * @return returns the needed time for the calculation in msec
+ */
+double five_point_stencil_with_temporal_blocking(stencil_matrix_t *matrix, const size_t iterations,
+                                                 size_t tile_cols, size_t time_steps);
+
+/**
+ * Applies the stencil described by \a descriptor (in-place, buffers radius + 1 rows).
+ *
+ * @param matrix matrix (the boundary must be at least as large as the stencil radius)
+ * @param descriptor stencil descriptor
+ * @param iterations number of iterations
+ *
+ * @return returns the needed time for the calculation in msec
+ */
+double stencil_with_descriptor(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor, const size_t iterations);
+
+/**
+ * Applies the stencil described by \a descriptor until the residual drops below the
+ * tolerance (or the maximum number of iterations is reached). On every check iteration
+ * the residual is calculated by the row kernels during the sweep.
+ *
+ * @param matrix matrix (the boundary must be at least as large as the stencil radius)
+ * @param descriptor stencil descriptor
+ * @param convergence convergence parameters, receives the number of iterations and the last residual
+ *
+ * @return returns the needed time for the calculation in msec
+ */
+double stencil_until_converged(stencil_matrix_t *matrix, const stencil_descriptor_t *descriptor,
+                               stencil_convergence_t *convergence);
+double five_point_stencil_until_converged(stencil_matrix_t *matrix, stencil_convergence_t *convergence);
+
+/**
+ * In-place red-black Gauss-Seidel iterations with successive over-relaxation: every
+ * iteration updates all red fields and then all black fields (the red fields only
+ * depend on black fields and vice versa).
+ *
+ * @param matrix matrix
+ * @param omega relaxation factor (1 is Gauss-Seidel, see stencil_sor_optimal_omega)
+ * @param iterations number of iterations
+ *
+ * @return returns the needed time for the calculation in msec
+ */
+double five_point_stencil_sor(stencil_matrix_t *matrix, double omega, const size_t iterations);
+
+/**
+ * Same as five_point_stencil_sor, but iterates until the residual (update of both
+ * colours) drops below the tolerance.
+ *
+ * @param convergence convergence parameters, receives the number of iterations and the last residual
+ */
+double five_point_stencil_sor_until_converged(stencil_matrix_t *matrix, double omega, stencil_convergence_t *convergence);
+
+/**
+ * One vector sweeps on a single-precision matrix.
+ *
+ * @param matrix matrix
+ * @param iterations number of iterations
+ * @param precision arithmetic of the kernel (float or double with float storage)
+ *
+ * @return returns the needed time for the calculation in msec
+ */
+double five_point_stencil_float(stencil_matrix_float_t *matrix, const size_t iterations, stencil_precision_t precision);
+
 #endif // __STENCIL_SEQUENTIAL
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <sys/time.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "stencil/util.h"
+#include "stencil/binary.h"
+#include "stencil_sequential/stencil_sequential.h"
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stdout, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+    if (matrix == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    // csv -> binary grid file -> mapped matrix
+    char filepath[] = "unit_test_binary_XXXXXX";
+    const int fd = mkstemp(filepath);
+    FILE *stream = (fd >= 0) ? fdopen(fd, "wb") : NULL;
+    const bool written = (stream != NULL) && stencil_binary_write(matrix, stream);
+    if (stream != NULL) {
+        fclose(stream);
+    }
+    stencil_matrix_free(matrix);
+
+    matrix = written ? new_matrix_from_file(filepath) : NULL;
+    unlink(filepath);
+    if (matrix == NULL || matrix->pages != STENCIL_PAGES_MAPPED) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+
+    five_point_stencil_with_tmp_matrix(matrix, 5);
+    matrix_to_file(matrix, stdout);
+
+    stencil_matrix_free(matrix);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,29 @@
+#include <stdio.h>
+#include <sys/time.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "stencil/util.h"
+#include "stencil_sequential/stencil_sequential.h"
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stdout, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+    if (matrix == NULL) {
+        return EXIT_FAILURE;
+    }
+    // never converges (tolerance 0), checks on iterations 2, 4 and 5
+    stencil_convergence_t convergence;
+    stencil_convergence_init(&convergence, STENCIL_NORM_MAX, 0.0, 2, 5);
+    five_point_stencil_until_converged(matrix, &convergence);
+    matrix_to_file(matrix, stdout);
+
+    stencil_matrix_free(matrix);
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
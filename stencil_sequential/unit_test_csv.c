@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <sys/time.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "stencil/util.h"
+#include "stencil/csv.h"
+#include "stencil_sequential/stencil_sequential.h"
+
+// about 8 MiB of values, thus the grid is parsed in several chunks
+#define TEST_ROWS 1200
+#define TEST_COLS 400
+#define TEST_IO_THREADS "4"
+
+enum malformation {
+    WELL_FORMED,
+    SHORT_ROW, // a row in the middle of the file lacks its last field (0 unless strict)
+    LONG_ROW,  // a row in the middle of the file has an additional field (ignored unless strict)
+    TRUNCATED  // the file ends in the middle of the last row
+};
+
+/**
+ * Writes a grid of TEST_ROWS x TEST_COLS values in various formats (fast path and strtod)
+ * to \a filepath.
+ *
+ * @param expected returns the values (parsed by strtod)
+ */
+static bool write_grid(const char *filepath, enum malformation malformation, double *expected)
+{
+    FILE *stream = fopen(filepath, "w");
+    if (stream == NULL) {
+        return false;
+    }
+
+    srand(42);
+    fprintf(stream, "%d;%d;1\n", TEST_ROWS, TEST_COLS);
+    for (size_t row = 0; row < TEST_ROWS; row++) {
+        size_t cols = TEST_COLS;
+        if (row == TEST_ROWS / 2 && malformation == SHORT_ROW) {
+            cols--;
+        } else if (row == TEST_ROWS - 1 && malformation == TRUNCATED) {
+            cols /= 2;
+        }
+
+        for (size_t col = 0; col < cols; col++) {
+            const double value = (rand() - RAND_MAX / 2) / 7.0;
+
+            char field[64];
+            switch ((row + col) % 5) {
+            case 0:
+                snprintf(field, sizeof(field), "%.3f", value);
+                break;
+            case 1:
+                snprintf(field, sizeof(field), "%.15g", value);
+                break;
+            case 2:
+                snprintf(field, sizeof(field), "%.6e", value);
+                break;
+            case 3:
+                snprintf(field, sizeof(field), "%.25f", value); // more digits than the fast path
+                break;
+            default:
+                snprintf(field, sizeof(field), "%.0f", value);
+                break;
+            }
+
+            expected[row * TEST_COLS + col] = strtod(field, NULL);
+            fprintf(stream, "%s;", field);
+        }
+
+        for (size_t col = cols; col < TEST_COLS; col++) {
+            expected[row * TEST_COLS + col] = 0.0; // strtod of the line break
+        }
+
+        if (row == TEST_ROWS / 2 && malformation == LONG_ROW) {
+            fprintf(stream, "1.000;");
+        }
+        if (row < TEST_ROWS - 1 || malformation != TRUNCATED) {
+            fprintf(stream, "\n");
+        }
+    }
+
+    return fclose(stream) == 0;
+}
+
+/**
+ * @return returns true if the grid read from \a filepath has the values \a expected
+ */
+static bool equals_grid(const char *filepath, const double *expected)
+{
+    stencil_matrix_t *matrix = new_matrix_from_file(filepath);
+    if (matrix == NULL) {
+        return false;
+    }
+
+    bool equal = (matrix->rows == TEST_ROWS && matrix->cols == TEST_COLS);
+    for (size_t row = 0; equal && row < TEST_ROWS; row++) {
+        equal = (memcmp(stencil_matrix_get_ptr(matrix, row, 0), expected + row * TEST_COLS,
+                        TEST_COLS * sizeof(double)) == 0);
+    }
+
+    stencil_matrix_free(matrix);
+    return equal;
+}
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stdout, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+    if (matrix == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    double *expected = (double *)malloc(TEST_ROWS * TEST_COLS * sizeof(double));
+    char filepath[] = "unit_test_csv_XXXXXX";
+    const int fd = mkstemp(filepath);
+    if (expected == NULL || fd < 0) {
+        free(expected);
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+    close(fd);
+
+    // the large grid is parsed in several chunks, the short and long rows are accepted like
+    // by the strtok parser unless the parser is strict, truncated grids are always rejected
+    setenv(STENCIL_IO_THREADS_ENV, TEST_IO_THREADS, 1);
+    bool valid = write_grid(filepath, WELL_FORMED, expected) && equals_grid(filepath, expected);
+    valid = valid && write_grid(filepath, SHORT_ROW, expected) && equals_grid(filepath, expected);
+    valid = valid && write_grid(filepath, LONG_ROW, expected) && equals_grid(filepath, expected);
+    const enum malformation malformations[] = {TRUNCATED, SHORT_ROW, LONG_ROW};
+    for (size_t i = 0; valid && i < sizeof(malformations) / sizeof(malformations[0]); i++) {
+        if (malformations[i] != TRUNCATED) {
+            setenv(STENCIL_CSV_STRICT_ENV, "1", 1);
+        }
+        valid = write_grid(filepath, malformations[i], expected);
+        stencil_matrix_t *malformed = valid ? new_matrix_from_file(filepath) : NULL;
+        valid = valid && (malformed == NULL);
+        stencil_matrix_free(malformed);
+    }
+    unsetenv(STENCIL_CSV_STRICT_ENV);
+    unsetenv(STENCIL_IO_THREADS_ENV);
+
+    unlink(filepath);
+    free(expected);
+    if (!valid) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+
+    five_point_stencil_with_tmp_matrix(matrix, 5);
+    matrix_to_file(matrix, stdout);
+
+    stencil_matrix_free(matrix);
+    return EXIT_SUCCESS;
+}
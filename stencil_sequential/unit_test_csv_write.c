@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <sys/time.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+#include <unistd.h>
+
+#include "stencil/util.h"
+#include "stencil/csv.h"
+#include "stencil_sequential/stencil_sequential.h"
+
+// about 20 MiB of fields, thus the rows are formatted by several threads in two rounds
+#define TEST_ROWS 2000
+#define TEST_COLS 1000
+#define TEST_IO_THREADS "3"
+
+/**
+ * Values which are formatted without snprintf but are hard to round (ties of the
+ * thousandths, -0.0, values close to the limit of the fast path) and the values which
+ * are left to snprintf (non-finite and large ones).
+ */
+static const double special_values[] = {
+    0.0, -0.0, 0.0625, 0.1875, 0.3125, 0.4375, -0.5625, -0.6875, 2.0625, 1023.9375,
+    0.0004, -0.0004, 0.0005, -0.0005, 0.9995, 1.0005, 2.5e-4, 1e-300, -1e-300, DBL_MIN, 4.9e-324,
+    999999999999.9995, 999999999999.9375, 1e12, -1e12, 1e15, 1e300, DBL_MAX, -DBL_MAX,
+    INFINITY, -INFINITY, NAN, -NAN
+};
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stdout, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+    if (matrix == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    // the special values (and their neighbours) first, random magnitudes afterwards
+    stencil_matrix_t *grid = stencil_matrix_new(TEST_ROWS, TEST_COLS, 1);
+    if (grid == NULL) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+    const size_t specials = sizeof(special_values) / sizeof(special_values[0]);
+    srand(42);
+    for (size_t row = 0; row < TEST_ROWS; row++) {
+        for (size_t col = 0; col < TEST_COLS; col++) {
+            const size_t i = row * TEST_COLS + col;
+            double value;
+            if (i < specials) {
+                value = special_values[i];
+            } else if (i < 3 * specials) {
+                value = nextafter(special_values[i % specials], (i < 2 * specials) ? -INFINITY : INFINITY);
+            } else {
+                value = ((double)rand() / RAND_MAX - 0.5) * pow(10.0, rand() % 30 - 12);
+            }
+            *stencil_matrix_get_ptr(grid, row, col) = value; // with boundary
+        }
+    }
+
+    // the writer (several blocks in parallel) against snprintf
+    char filepath[] = "unit_test_csv_write_XXXXXX";
+    const int fd = mkstemp(filepath);
+    FILE *stream = (fd >= 0) ? fdopen(fd, "w+") : NULL;
+    setenv(STENCIL_IO_THREADS_ENV, TEST_IO_THREADS, 1);
+    bool equal = (stream != NULL) && stencil_csv_write(grid, stream) && (fseek(stream, 0, SEEK_SET) == 0);
+    unsetenv(STENCIL_IO_THREADS_ENV);
+    for (size_t row = 0; equal && row < TEST_ROWS; row++) {
+        for (size_t col = 0; equal && col <= TEST_COLS; col++) {
+            char expected[512];
+            char written[512];
+            if (col < TEST_COLS) {
+                snprintf(expected, sizeof(expected), "%.3f;", *stencil_matrix_get_ptr(grid, row, col));
+            } else {
+                snprintf(expected, sizeof(expected), "\n");
+            }
+            const size_t len = strlen(expected);
+            equal = (fread(written, 1, len, stream) == len) && (memcmp(written, expected, len) == 0);
+        }
+    }
+    equal = equal && (fgetc(stream) == EOF);
+    if (stream != NULL) {
+        fclose(stream);
+    }
+    unlink(filepath);
+    stencil_matrix_free(grid);
+    if (!equal) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+
+    five_point_stencil_with_tmp_matrix(matrix, 5);
+    matrix_to_file(matrix, stdout);
+
+    stencil_matrix_free(matrix);
+    return EXIT_SUCCESS;
+}
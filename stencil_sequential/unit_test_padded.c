@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include <sys/time.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "stencil/util.h"
+#include "stencil_sequential/stencil_sequential.h"
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stdout, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+    if (matrix == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    // odd padding (rounded up to the alignment), the tmp matrix uses the default stride
+    stencil_matrix_t *padded = stencil_matrix_new_padded(matrix->rows, matrix->cols, matrix->boundary, 3);
+    if (padded == NULL) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+    stencil_matrix_copy_values(padded, matrix);
+    five_point_stencil_with_tmp_matrix(padded, 5);
+    matrix_to_file(padded, stdout);
+
+    stencil_matrix_free(padded);
+    stencil_matrix_free(matrix);
+    return EXIT_SUCCESS;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include <stdio.h>
+#include <sys/time.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "stencil/util.h"
+#include "stencil/snapshot.h"
+#include "stencil_sequential/stencil_sequential.h"
+
+#define TEST_BLOCK_ROWS 3
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stdout, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+    if (matrix == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    // csv -> compressed snapshot (several blocks) -> matrix
+    char filepath[] = "unit_test_snapshot_XXXXXX";
+    const int fd = mkstemp(filepath);
+    FILE *stream = (fd >= 0) ? fdopen(fd, "wb") : NULL;
+    const bool written = (stream != NULL) && stencil_snapshot_write(matrix, TEST_BLOCK_ROWS, stream);
+    if (stream != NULL) {
+        fclose(stream);
+    }
+    stencil_matrix_free(matrix);
+
+    matrix = written ? new_matrix_from_file(filepath) : NULL;
+    if (matrix == NULL) {
+        unlink(filepath);
+        return EXIT_FAILURE;
+    }
+
+    // a range of rows which starts and ends within a block
+    const size_t first_row = TEST_BLOCK_ROWS + 1;
+    const size_t rows = matrix->rows - 2 * first_row;
+    stencil_matrix_t *range = stencil_matrix_new(matrix->rows, matrix->cols, matrix->boundary);
+    bool equal = (range != NULL) && stencil_snapshot_read_rows(filepath, first_row, rows, range);
+    for (size_t row = first_row; equal && row < first_row + rows; row++) {
+        equal = (memcmp(stencil_matrix_get_ptr(range, row, 0), stencil_matrix_get_ptr(matrix, row, 0),
+                        matrix->cols * sizeof(double)) == 0);
+    }
+    stencil_matrix_free(range);
+    unlink(filepath);
+    if (!equal) {
+        stencil_matrix_free(matrix);
+        return EXIT_FAILURE;
+    }
+
+    five_point_stencil_with_tmp_matrix(matrix, 5);
+    matrix_to_file(matrix, stdout);
+
+    stencil_matrix_free(matrix);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <sys/time.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "stencil/util.h"
+#include "stencil/topology.h"
+#include "stencil_sequential/stencil_sequential.h"
+
+#define TEST_MAX_BLOCKS 64
+
+/**
+ * Grid of blocks and the rectangle of neighbouring blocks expected for each group, 0 x 0
+ * if the blocks are mapped row by row.
+ */
+struct block_case {
+    size_t group_size;
+    size_t blocks_horizontal;
+    size_t blocks_vertical;
+    size_t group_horizontal;
+    size_t group_vertical;
+};
+
+static const struct block_case block_cases[] = {
+    {0, 4, 2, 0, 0}, // no groups
+    {1, 4, 2, 0, 0}, // a thread per group
+    {2, 4, 2, 1, 2},
+    {4, 4, 4, 2, 2},
+    {4, 2, 8, 2, 2},
+    {8, 8, 2, 4, 2},
+    {4, 8, 1, 4, 1},
+    {3, 4, 3, 1, 3}, // the square rectangle does not tile the grid
+    {6, 4, 3, 2, 3},
+    {2, 3, 3, 0, 0}, // no rectangle tiles the grid
+    {3, 4, 2, 0, 0}
+};
+
+/**
+ * @return returns true if stencil_topology_block maps the threads of \a block_case to
+ *         the blocks one-to-one and the threads of a group to the expected rectangle
+ */
+static bool check_blocks(const struct block_case *block_case)
+{
+    const size_t blocks = block_case->blocks_horizontal * block_case->blocks_vertical;
+    const bool grouped = (block_case->group_horizontal > 0);
+
+    bool assigned[TEST_MAX_BLOCKS];
+    memset(assigned, 0, sizeof(assigned));
+
+    size_t first_row = 0;
+    size_t first_col = 0;
+    for (size_t thread = 0; thread < blocks; thread++) {
+        size_t row;
+        size_t col;
+        stencil_topology_block(block_case->group_size, block_case->blocks_horizontal, block_case->blocks_vertical,
+                               thread, &row, &col);
+
+        // each block exactly once
+        if (row >= block_case->blocks_vertical || col >= block_case->blocks_horizontal ||
+            assigned[row * block_case->blocks_horizontal + col]) {
+            return false;
+        }
+        assigned[row * block_case->blocks_horizontal + col] = true;
+
+        if (!grouped) {
+            if (row != thread / block_case->blocks_horizontal || col != thread % block_case->blocks_horizontal) {
+                return false;
+            }
+            continue;
+        }
+
+        // the members of a group are adjacent: the rectangle starts at the first member
+        if (thread % block_case->group_size == 0) {
+            first_row = row;
+            first_col = col;
+        }
+        if (row < first_row || row >= first_row + block_case->group_vertical ||
+            col < first_col || col >= first_col + block_case->group_horizontal) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argv[1] == NULL) {
+        fprintf(stdout, "ERROR: file argument missing");
+        return EXIT_FAILURE;
+    }
+
+    stencil_matrix_t *matrix = new_matrix_from_file(argv[1]);
+    if (matrix == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    for (size_t i = 0; i < sizeof(block_cases) / sizeof(block_cases[0]); i++) {
+        if (!check_blocks(&block_cases[i])) {
+            fprintf(stdout, "ERROR: blocks of group size %zu on %zu x %zu blocks\n", block_cases[i].group_size,
+                    block_cases[i].blocks_vertical, block_cases[i].blocks_horizontal);
+            stencil_matrix_free(matrix);
+            return EXIT_FAILURE;
+        }
+    }
+
+    five_point_stencil_with_tmp_matrix(matrix, 5);
+    matrix_to_file(matrix, stdout);
+
+    stencil_matrix_free(matrix);
+    return EXIT_SUCCESS;
+}